@@ -0,0 +1,59 @@
+// Host run of the hot-path microbenchmarks (include/bench.h, the same cases as GET /bench on the
+// device) against the ESP-IDF stand-ins. Prints the JSON, or writes it to a file for tracking runs
+// over time:
+//
+//   bench_hot_paths [--filter NAME] [--n ITERATIONS] [--out FILE]
+//
+// "cycles" are TSC ticks here, not CPU cycles at the core clock; compare host runs with host runs.
+// The strip is dark and no sensor sees motion, as at night in an empty room.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+#include "esp_log.h"
+#include "host_sim.h"
+#include "light_sensor_support.h"
+#include "pir312_monitor.h"
+
+int main(int argc, char** argv)
+{
+  std::string filter;
+  std::string out_path;
+  int n = 100000;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--filter" && has_value)
+      filter = argv[++i];
+    else if (a == "--n" && has_value)
+      n = atoi(argv[++i]);
+    else if (a == "--out" && has_value)
+      out_path = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [--filter NAME] [--n ITERATIONS] [--out FILE]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  esp_log_level_set("*", ESP_LOG_WARN); // stdout is the JSON
+  host_adc_set_raw(6, 4000);           // dark
+  light_sensor_init();
+  pir312_init();
+
+  static char json[4096];
+  bench_run_json(filter.c_str(), n, json, sizeof(json));
+  FILE* f = out_path.empty() ? stdout : fopen(out_path.c_str(), "w");
+  if (f == nullptr)
+  {
+    perror(out_path.c_str());
+    return 1;
+  }
+  fprintf(f, "%s\n", json);
+  if (f != stdout)
+    fclose(f);
+  return 0;
+}
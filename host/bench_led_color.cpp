@@ -0,0 +1,117 @@
+// Host benchmark for include/led_color.h: per-pixel cost of the gamma table + temporal dither
+// compared with a plain copy and with computing the gamma curve in float per pixel.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "led_color.h"
+#include "led_power.h"
+
+static const int k_pixels = 84;
+static const int k_channels = k_pixels * 3;
+static const int k_frames = 200000;
+
+// Keep the compiler from hoisting work out of the timed loop.
+static inline void clobber(const void* p)
+{
+  asm volatile("" : : "r"(p) : "memory");
+}
+
+template <typename Fn>
+static double ns_per_pixel(Fn fn)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int f = 0; f < k_frames; ++f)
+  {
+    fn(f);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return ns / ((double)k_frames * k_pixels);
+}
+
+int main()
+{
+  std::vector<uint8_t> in(k_channels), out(k_channels), err(k_channels);
+  for (int i = 0; i < k_channels; ++i)
+  {
+    in[i] = (uint8_t)(i * 31);
+  }
+  led_color::dither_seed(err.data(), err.size());
+  unsigned sink = 0;
+
+  const double copy_ns = ns_per_pixel([&](int f) {
+    in[f % k_channels] = (uint8_t)f;
+    clobber(in.data());
+    for (int i = 0; i < k_channels; ++i)
+      out[i] = in[i];
+    sink += out[k_channels - 1];
+  });
+
+  const double lut_ns = ns_per_pixel([&](int f) {
+    in[f % k_channels] = (uint8_t)f;
+    clobber(in.data());
+    led_color::gamma_dither(in.data(), out.data(), err.data(), in.size());
+    sink += out[k_channels - 1];
+  });
+
+  const double gamma = LED_GAMMA_X100 / 100.0;
+  const double float_ns = ns_per_pixel([&](int f) {
+    in[f % k_channels] = (uint8_t)f;
+    clobber(in.data());
+    for (int i = 0; i < k_channels; ++i)
+      out[i] = (uint8_t)(std::pow(in[i] / 255.0f, (float)gamma) * 255.0f + 0.5f);
+    sink += out[k_channels - 1];
+  });
+
+  uint32_t est_ma = 0;
+  const double power_ns = ns_per_pixel([&](int f) {
+    in[f % k_channels] = (uint8_t)f;
+    clobber(in.data());
+    est_ma = led_power::estimate_ma(led_power::duty_sum(in.data(), in.size()), k_pixels);
+    sink += est_ma;
+  });
+
+  std::vector<uint8_t> white(k_channels, 255);
+  const uint32_t white_ma = led_power::estimate_ma(led_power::duty_sum(white.data(), white.size()), k_pixels);
+  const uint32_t white_scale = led_power::limit_scale_q16(white_ma, k_pixels, 2000);
+
+  // Accuracy: the dithered mean over 256 frames must match the 8.8 table value for every level.
+  int worst_err_q8 = 0;
+  for (int level = 0; level < 256; ++level)
+  {
+    uint8_t lv = (uint8_t)level, o = 0, e = 0;
+    unsigned sum = 0;
+    for (int f = 0; f < 256; ++f)
+    {
+      led_color::gamma_dither(&lv, &o, &e, 1);
+      sum += o;
+    }
+    const int diff = (int)sum - (int)led_color::k_gamma.v[level];
+    worst_err_q8 = std::max(worst_err_q8, std::abs(diff));
+  }
+
+  int distinct_low = 0; // output levels available below duty 8/255, where 8-bit steps are coarse
+  for (int level = 0; level < 256; ++level)
+  {
+    if (led_color::k_gamma.v[level] < 8 * 256 && (level == 0 || led_color::k_gamma.v[level] != led_color::k_gamma.v[level - 1]))
+      ++distinct_low;
+  }
+
+  printf("gamma %.2f, %d px x %d frames\n", gamma, k_pixels, k_frames);
+  printf("copy          %7.2f ns/px\n", copy_ns);
+  printf("lut + dither  %7.2f ns/px\n", lut_ns);
+  printf("float pow     %7.2f ns/px\n", float_ns);
+  printf("power estimate %7.2f ns/px\n", power_ns);
+  printf("full white: %u mA estimated, %u mA after limiting to 2000 mA (scale %.3f)\n",
+         (unsigned)white_ma,
+         (unsigned)led_power::scaled_ma(white_ma, k_pixels, white_scale),
+         white_scale / 65536.0);
+  printf("dither mean error over 256 frames: %d/256 duty steps\n", worst_err_q8);
+  printf("distinct levels below duty 8: %d (8-bit without dither: 8)\n", distinct_low);
+  printf("(checksum %u)\n", sink);
+  return 0;
+}
@@ -0,0 +1,220 @@
+// Host benchmark for include/led_kernels.h: per-pixel cost of the fixed-point kernels (one pixel at a
+// time with vectorization disabled, plain bulk loops, unrolled bulk loops) against float versions,
+// plus the worst deviation from the float results.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "led_kernels.h"
+
+using led_kernels::rgb;
+
+static const int k_pixels = 1024;
+static const int k_channels = k_pixels * 3;
+static const int k_frames = 20000;
+
+// Keep the compiler from hoisting work out of the timed loop.
+static inline void clobber(const void* p)
+{
+  asm volatile("" : : "r"(p) : "memory");
+}
+
+template <typename Fn>
+static double ns_per_pixel(Fn fn)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  for (int f = 0; f < k_frames; ++f)
+  {
+    fn(f);
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return ns / ((double)k_frames * k_pixels);
+}
+
+// "Scalar": the single-pixel helpers, kept out of the vectorizer so the numbers show what a core
+// without SIMD does per pixel.
+#define NO_VECTORIZE __attribute__((noinline, optimize("no-tree-vectorize")))
+
+NO_VECTORIZE static void scale_scalar(const uint8_t* in, uint8_t* out, int n_px, uint32_t f)
+{
+  for (int i = 0; i < n_px; ++i)
+  {
+    const rgb c = led_kernels::scale_px(rgb{in[i * 3], in[i * 3 + 1], in[i * 3 + 2]}, f);
+    out[i * 3] = c.r;
+    out[i * 3 + 1] = c.g;
+    out[i * 3 + 2] = c.b;
+  }
+}
+
+NO_VECTORIZE static void blend_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out, int n_px, uint32_t t)
+{
+  for (int i = 0; i < n_px; ++i)
+  {
+    const rgb c = led_kernels::lerp_px(rgb{a[i * 3], a[i * 3 + 1], a[i * 3 + 2]}, rgb{b[i * 3], b[i * 3 + 1], b[i * 3 + 2]}, t);
+    out[i * 3] = c.r;
+    out[i * 3 + 1] = c.g;
+    out[i * 3 + 2] = c.b;
+  }
+}
+
+NO_VECTORIZE static void add_sat_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out, int n)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    out[i] = led_kernels::add_sat8(a[i], b[i]);
+  }
+}
+
+static void scale_float(const uint8_t* in, uint8_t* out, int n, float f)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = (uint8_t)(in[i] * f);
+}
+
+static void blend_float(const uint8_t* a, const uint8_t* b, uint8_t* out, int n, float t)
+{
+  for (int i = 0; i < n; ++i)
+    out[i] = (uint8_t)(a[i] + (b[i] - a[i]) * t);
+}
+
+static rgb hsv_float(float h_deg, float s, float v)
+{
+  auto ch = [&](float n) {
+    const float k = std::fmod(n + h_deg / 60.0f, 6.0f);
+    return (uint8_t)(v * 255.0f * (1.0f - s * std::max(0.0f, std::min(std::min(k, 4.0f - k), 1.0f))) + 0.5f);
+  };
+  return rgb{ch(5.0f), ch(3.0f), ch(1.0f)};
+}
+
+int main()
+{
+  std::vector<uint8_t> a(k_channels), b(k_channels), out(k_channels), ref(k_channels);
+  for (int i = 0; i < k_channels; ++i)
+  {
+    a[i] = (uint8_t)(i * 31);
+    b[i] = (uint8_t)(i * 17 + 5);
+  }
+  unsigned sink = 0;
+  auto touch = [&](int f) {
+    a[f % k_channels] = (uint8_t)f;
+    clobber(a.data());
+  };
+
+  // brightness scale
+  const double scale_f_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    scale_float(a.data(), out.data(), k_channels, 0.7f);
+    sink += out[f % k_channels];
+  });
+  const double scale_s_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    scale_scalar(a.data(), out.data(), k_pixels, 179);
+    sink += out[f % k_channels];
+  });
+  const double scale_v_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::scale(a.data(), out.data(), k_channels, 179);
+    sink += out[f % k_channels];
+  });
+  const double scale_u_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::scale_x4(a.data(), out.data(), k_channels, 179);
+    sink += out[f % k_channels];
+  });
+
+  // cross-fade
+  const double blend_f_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    blend_float(a.data(), b.data(), out.data(), k_channels, 0.3f);
+    sink += out[f % k_channels];
+  });
+  const double blend_s_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    blend_scalar(a.data(), b.data(), out.data(), k_pixels, 77);
+    sink += out[f % k_channels];
+  });
+  const double blend_v_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::blend(a.data(), b.data(), out.data(), k_channels, 77);
+    sink += out[f % k_channels];
+  });
+  const double blend_u_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::blend_x4(a.data(), b.data(), out.data(), k_channels, 77);
+    sink += out[f % k_channels];
+  });
+
+  // saturating add
+  const double add_s_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    add_sat_scalar(a.data(), b.data(), out.data(), k_channels);
+    sink += out[f % k_channels];
+  });
+  const double add_v_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::add_sat(a.data(), b.data(), out.data(), k_channels);
+    sink += out[f % k_channels];
+  });
+  const double add_u_ns = ns_per_pixel([&](int f) {
+    touch(f);
+    led_kernels::add_sat_x4(a.data(), b.data(), out.data(), k_channels);
+    sink += out[f % k_channels];
+  });
+
+  // HSV gradient
+  const double hsv_f_ns = ns_per_pixel([&](int f) {
+    for (int i = 0; i < k_pixels; ++i)
+    {
+      const rgb c = hsv_float((float)((f + i * 3) % 1536) * (360.0f / 1536.0f), 1.0f, 1.0f);
+      out[i * 3] = c.r;
+      out[i * 3 + 1] = c.g;
+      out[i * 3 + 2] = c.b;
+    }
+    clobber(out.data());
+    sink += out[f % k_channels];
+  });
+  const double hsv_x_ns = ns_per_pixel([&](int f) {
+    led_kernels::hsv_fill(out.data(), k_pixels, (uint32_t)f, 3, 255, 255);
+    clobber(out.data());
+    sink += out[f % k_channels];
+  });
+
+  // Accuracy against the float versions.
+  int scale_err = 0, blend_err = 0, hsv_err = 0;
+  for (int f = 0; f <= 256; f += 4)
+  {
+    led_kernels::scale(a.data(), out.data(), k_channels, (uint32_t)f);
+    for (int i = 0; i < k_channels; ++i)
+      scale_err = std::max(scale_err, std::abs((int)out[i] - (int)std::lround(a[i] * f / 256.0)));
+    led_kernels::blend(a.data(), b.data(), out.data(), k_channels, (uint32_t)f);
+    for (int i = 0; i < k_channels; ++i)
+      blend_err = std::max(blend_err, std::abs((int)out[i] - (int)std::lround(a[i] + (b[i] - a[i]) * (f / 256.0))));
+  }
+  for (uint32_t h = 0; h < 1536; ++h)
+  {
+    for (int s = 0; s < 256; s += 51)
+    {
+      const rgb x = led_kernels::hsv_px(h, (uint8_t)s, 200);
+      const rgb y = hsv_float(h * (360.0f / 1536.0f), s / 255.0f, 200 / 255.0f);
+      hsv_err = std::max({hsv_err, std::abs(x.r - y.r), std::abs(x.g - y.g), std::abs(x.b - y.b)});
+    }
+  }
+  int add_err = 0;
+  for (int x = 0; x < 256; ++x)
+    for (int y = 0; y < 256; ++y)
+      add_err = std::max(add_err, std::abs((int)led_kernels::add_sat8((uint8_t)x, (uint8_t)y) - std::min(x + y, 255)));
+
+  printf("%d px x %d frames, ns/px (float | scalar | bulk | unrolled x4)\n", k_pixels, k_frames);
+  printf("scale    %7.3f | %7.3f | %7.3f | %7.3f   max err %d\n", scale_f_ns, scale_s_ns, scale_v_ns, scale_u_ns, scale_err);
+  printf("blend    %7.3f | %7.3f | %7.3f | %7.3f   max err %d\n", blend_f_ns, blend_s_ns, blend_v_ns, blend_u_ns, blend_err);
+  printf("add_sat        - | %7.3f | %7.3f | %7.3f   max err %d\n", add_s_ns, add_v_ns, add_u_ns, add_err);
+  printf("hsv      %7.3f |       - | %7.3f |       -   max err %d\n", hsv_f_ns, hsv_x_ns, hsv_err);
+  printf("(checksum %u)\n", sink);
+  return 0;
+}
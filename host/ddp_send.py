@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Send a test pattern to the strip as realtime DDP or E1.31 frames.
+
+    ddp_send.py [--host 127.0.0.1] [--proto ddp|e131] [--fps 60] [--seconds 3] [--leds 84] [--chunk 0]
+                [--universe 1] [--sync 0]
+
+Works against the device or, over loopback, against host/led_sim --udp. The pattern is a
+rainbow band moving along the strip (perceptual levels; the firmware applies gamma and the
+power limit). --chunk splits each DDP frame into several datagrams of that many pixels, only
+the last one carrying the push flag. --sync makes the E1.31 data packets name that sync
+universe and follows each frame with a synchronization packet for it.
+"""
+
+import argparse
+import colorsys
+import socket
+import struct
+import time
+
+DDP_PORT = 4048
+E131_PORT = 5568
+
+
+def frame(t, leds):
+    out = bytearray()
+    for i in range(leds):
+        r, g, b = colorsys.hsv_to_rgb((i / leds + t * 0.25) % 1.0, 1.0, 1.0)
+        out += bytes((int(r * 255), int(g * 255), int(b * 255)))
+    return out
+
+
+def ddp_packets(data, first_seq, chunk_px):
+    chunk = len(data) if chunk_px <= 0 else chunk_px * 3
+    for n, off in enumerate(range(0, len(data), chunk)):
+        seq = (first_seq + n) % 15 + 1
+        part = data[off:off + chunk]
+        push = 0x01 if off + chunk >= len(data) else 0x00
+        # flags (version 1), sequence 1..15, type RGB 8 bit, destination id 1, offset, length
+        yield struct.pack(">BBBBIH", 0x40 | push, seq, 0x0B, 1, off, len(part)) + part
+
+
+def e131_packets(data, seq, universe, sync=0, cid=b"led-sim-sender!!"):
+    for n, off in enumerate(range(0, len(data), 510)):
+        dmx = data[off:off + 510]
+        slots = len(dmx) + 1
+        dmp = struct.pack(">HBBHHH", 0x7000 | (10 + slots), 0x02, 0xA1, 0, 1, slots) + b"\x00" + dmx
+        framing = struct.pack(">HI64sBHBBH", 0x7000 | (77 + len(dmp)), 0x00000002, b"ddp_send.py", 100, sync, seq, 0, universe + n)
+        root = struct.pack(">HH12sHI16s", 0x0010, 0x0000, b"ASC-E1.17\x00\x00\x00", 0x7000 | (22 + len(framing) + len(dmp)), 0x00000004, cid)
+        yield root + framing + dmp
+    if sync:
+        # synchronization packet: root vector EXTENDED, framing vector SYNCHRONIZATION
+        framing = struct.pack(">HIBHH", 0x7000 | 11, 0x00000001, seq, sync, 0)
+        root = struct.pack(">HH12sHI16s", 0x0010, 0x0000, b"ASC-E1.17\x00\x00\x00", 0x7000 | (22 + len(framing)), 0x00000008, cid)
+        yield root + framing
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--host", default="127.0.0.1")
+    ap.add_argument("--proto", choices=("ddp", "e131"), default="ddp")
+    ap.add_argument("--fps", type=float, default=60.0)
+    ap.add_argument("--seconds", type=float, default=3.0)
+    ap.add_argument("--leds", type=int, default=84)
+    ap.add_argument("--chunk", type=int, default=0)
+    ap.add_argument("--universe", type=int, default=1)
+    ap.add_argument("--sync", type=int, default=0)
+    args = ap.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    period = 1.0 / args.fps
+    start = time.monotonic()
+    frames = packets = 0
+    while time.monotonic() - start < args.seconds:
+        t = time.monotonic() - start
+        data = frame(t, args.leds)
+        if args.proto == "ddp":
+            pkts = ddp_packets(data, packets, args.chunk)
+            port = DDP_PORT
+        else:
+            pkts = e131_packets(data, frames % 256, args.universe, args.sync)
+            port = E131_PORT
+        for p in pkts:
+            sock.sendto(p, (args.host, port))
+            packets += 1
+        frames += 1
+        time.sleep(max(0.0, start + frames * period - time.monotonic()))
+
+    print(f"sent {frames} frames in {packets} {args.proto} packets to {args.host}")
+
+
+if __name__ == "__main__":
+    main()
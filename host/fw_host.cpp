@@ -0,0 +1,133 @@
+// Whole firmware on the host: app_main() from src/main.c with every module of src/ built against
+// the ESP-IDF stand-ins in host/stubs, in real time. Wi-Fi connects to a simulated AP, the web UI
+// and all endpoints are served on a local port and the LED strip renders into the frame stand-in,
+// so the firmware can be load-tested with ordinary HTTP tools and profiled with perf or valgrind.
+//
+//   fw_host [--port N] [--duration S] [--light RAW] [--motion-every MS] [--image FILE]
+//
+// --port          HTTP port instead of the firmware's 80 (default 8080)
+// --duration      exit after S seconds (default: until SIGINT/SIGTERM)
+// --light         light sensor reading, ADC1 channel 6 (default 4000 = dark; < 2000 is daylight)
+// --motion-every  raise the next PIR input for a second every MS milliseconds (default: no motion)
+// --image         firmware .bin for the running partition: its app description becomes the
+//                 running one and it is the base for delta OTA uploads
+//
+// On exit the metrics registry (http.req_us, led.cpu_us, ...) is printed as JSON. An OTA upload
+// that finishes with a reboot ends the process (status 0). Examples:
+//
+//   fw_host --duration 60 --motion-every 700 &
+//   ab -k -n 5000 -c 4 http://127.0.0.1:8080/led/stats
+//   curl -s 'http://127.0.0.1:8080/log?level=W'
+//   valgrind --tool=callgrind ./fw_host --duration 20 --motion-every 500
+//   perf record -g ./fw_host --duration 30 --motion-every 500
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "host_sim.h"
+#include "metrics.h"
+
+extern "C" void app_main(void);
+
+static const int k_pir_pins[] = {27, 16, 18, 19, 23, 17}; // src/pir312_monitor.cpp
+static const int k_light_channel = 6;                    // src/light_sensor_support.cpp
+static const int k_motion_ms = 1000;
+
+static volatile std::sig_atomic_t s_stop = 0;
+
+struct options
+{
+  int port = 8080;
+  int duration_s = 0; // 0: until a signal
+  int light = 4000;
+  int motion_every_ms = 0;
+  std::string image;
+};
+
+static bool parse_args(int argc, char** argv, options& opt)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string a = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (a == "--port" && has_value)
+      opt.port = atoi(argv[++i]);
+    else if (a == "--duration" && has_value)
+      opt.duration_s = atoi(argv[++i]);
+    else if (a == "--light" && has_value)
+      opt.light = atoi(argv[++i]);
+    else if (a == "--motion-every" && has_value)
+      opt.motion_every_ms = atoi(argv[++i]);
+    else if (a == "--image" && has_value)
+      opt.image = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: %s [--port N] [--duration S] [--light RAW] [--motion-every MS] [--image FILE]\n", argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void on_signal(int)
+{
+  s_stop = 1;
+}
+
+int main(int argc, char** argv)
+{
+  options opt;
+  if (!parse_args(argc, argv, opt))
+    return 2;
+  if (!opt.image.empty() && !host_flash_load_app(opt.image.c_str()))
+  {
+    fprintf(stderr, "%s is not a firmware image\n", opt.image.c_str());
+    return 2;
+  }
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  host_httpd_set_port(opt.port);
+  host_led_set_recording(false); // frames are rendered, not kept
+  host_adc_set_raw(k_light_channel, opt.light);
+  app_main();
+
+  const auto t0 = std::chrono::steady_clock::now();
+  auto next_motion = t0 + std::chrono::milliseconds(opt.motion_every_ms);
+  auto motion_off = t0;
+  int motion_pin = -1;
+  size_t pin_index = 0;
+  while (!s_stop)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const auto now = std::chrono::steady_clock::now();
+    if (opt.duration_s > 0 && now - t0 >= std::chrono::seconds(opt.duration_s))
+      break;
+    if (motion_pin >= 0 && now >= motion_off)
+    {
+      host_gpio_set_level(motion_pin, 0);
+      motion_pin = -1;
+    }
+    if (opt.motion_every_ms > 0 && now >= next_motion)
+    {
+      if (motion_pin >= 0)
+        host_gpio_set_level(motion_pin, 0);
+      motion_pin = k_pir_pins[pin_index++ % (sizeof(k_pir_pins) / sizeof(k_pir_pins[0]))];
+      host_gpio_set_level(motion_pin, 1);
+      motion_off = now + std::chrono::milliseconds(k_motion_ms);
+      next_motion = now + std::chrono::milliseconds(opt.motion_every_ms);
+    }
+  }
+
+  static char json[4096];
+  metrics_format_json(json, sizeof(json));
+  fprintf(stderr, "metrics: %s\n", json);
+  fflush(stdout);
+  fflush(stderr);
+  std::_Exit(0); // firmware tasks are detached threads that never return
+}
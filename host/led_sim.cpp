@@ -0,0 +1,371 @@
+// Host LED simulator: runs the firmware's LED pipeline (ws2812b_support.cpp with the real PIR and
+// light sensor modules) against the ESP-IDF stand-ins in virtual time, records every refreshed
+// frame and exports the recording.
+//
+//   led_sim [--scenario FILE] [--ppm FILE] [--frames DIR] [--ansi] [--every N] [--px N] [--raw] [--udp] [--target-us N]
+//           [--floor-us N]
+//
+// --udp also starts the realtime stream receiver (src/led_stream_udp.cpp) on the host's DDP and
+// E1.31 ports and runs the scenario in real time, so host/ddp_send.py can drive the strip over
+// loopback while it runs.
+//
+// --target-us fails the run (exit 1) when the motion-to-light p95 is above N microseconds, e.g.
+// with host/scenario_idle.txt to check that waking from the idle mode keeps up. --floor-us fails it
+// when the p50 is below N: every trace includes the strip's wire time, so a lower value means the
+// measurement lost it. Either check also fails when no motion onset was traced at all.
+//
+// Scenario lines are "<t_ms> <command> [args]", '#' starts a comment:
+//   gpio <pin> <0|1>      drive a PIR output (pins as in src/pir312_monitor.cpp)
+//   adc <channel> <raw>   light sensor reading (ADC1 channel 6; < 2000 means daylight)
+//   zone <n> <effect>     ws2812b_set_zone_effect()
+//   budget <mA>           ws2812b_set_power_budget_ma()
+//   expect <floor> <target>  --floor-us / --target-us for this scenario (the command line wins)
+//   end                   stop the run at this time
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp_log.h"
+#include "host_sim.h"
+#include "led_stream.h"
+#include "light_sensor_support.h"
+#include "pir312_monitor.h"
+#include "ws2812b_support.h"
+
+static const char* k_default_scenario = R"(
+0     adc 6 4000      # dark
+500   gpio 16 1       # left-left closet
+1500  gpio 16 0
+2000  gpio 19 1       # right-center closet
+2500  gpio 19 0
+3000  zone 0 breathing
+3000  zone 3 chase
+3000  gpio 23 1       # right-right closet
+9000  adc 6 900       # daylight: strip goes dark
+10000 end
+)";
+
+struct scenario_event
+{
+  int64_t t_ms;
+  std::string cmd;
+  std::string a;
+  std::string b;
+};
+
+struct options
+{
+  std::string scenario;
+  std::string ppm;
+  std::string frames_dir;
+  bool ansi = false;
+  int every = 1;
+  int px = 4;
+  bool raw = false;
+  bool udp = false;
+  uint32_t target_us = 0; // 0: no motion-to-light p95 check
+  uint32_t floor_us = 0;  // 0: no motion-to-light p50 check
+};
+
+static std::vector<scenario_event> parse_scenario(const std::string& text)
+{
+  std::vector<scenario_event> events;
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    const size_t hash = line.find('#');
+    if (hash != std::string::npos)
+      line.resize(hash);
+    std::istringstream ls(line);
+    scenario_event ev = {};
+    if (ls >> ev.t_ms >> ev.cmd)
+    {
+      ls >> ev.a >> ev.b;
+      events.push_back(ev);
+    }
+  }
+  return events;
+}
+
+static bool apply_event(const scenario_event& ev)
+{
+  if (ev.cmd == "gpio")
+    host_gpio_set_level(atoi(ev.a.c_str()), atoi(ev.b.c_str()));
+  else if (ev.cmd == "adc")
+    host_adc_set_raw(atoi(ev.a.c_str()), atoi(ev.b.c_str()));
+  else if (ev.cmd == "zone")
+  {
+    if (!ws2812b_set_zone_effect(atoi(ev.a.c_str()), ev.b.c_str()))
+      fprintf(stderr, "scenario: bad zone/effect '%s %s'\n", ev.a.c_str(), ev.b.c_str());
+  }
+  else if (ev.cmd == "budget")
+    ws2812b_set_power_budget_ma((uint32_t)atoi(ev.a.c_str()));
+  else if (ev.cmd == "end")
+    return false;
+  else if (ev.cmd == "expect")
+    ; // read before the run
+  else
+    fprintf(stderr, "scenario: unknown command '%s'\n", ev.cmd.c_str());
+  return true;
+}
+
+// LED duty is linear light; the preview maps it to display (sRGB-like) values so dim levels
+// stay visible. --raw writes the duty unchanged.
+static uint8_t to_display(uint8_t duty, bool raw)
+{
+  if (raw)
+    return duty;
+  return (uint8_t)(std::pow(duty / 255.0, 1.0 / 2.2) * 255.0 + 0.5);
+}
+
+static void write_ppm(const std::string& path, const std::vector<const host_led_frame*>& rows, int px, bool raw)
+{
+  FILE* f = fopen(path.c_str(), "wb");
+  if (f == nullptr)
+  {
+    fprintf(stderr, "cannot write %s\n", path.c_str());
+    return;
+  }
+  const int leds = rows.empty() ? 0 : (int)rows[0]->rgb.size() / 3;
+  fprintf(f, "P6\n%d %d\n255\n", leds * px, (int)rows.size() * px);
+  std::vector<uint8_t> line((size_t)leds * px * 3);
+  for (const host_led_frame* fr : rows)
+  {
+    for (int i = 0; i < leds; ++i)
+      for (int x = 0; x < px; ++x)
+        for (int c = 0; c < 3; ++c)
+          line[((size_t)i * px + x) * 3 + c] = to_display(fr->rgb[(size_t)i * 3 + c], raw);
+    for (int y = 0; y < px; ++y)
+      fwrite(line.data(), 1, line.size(), f);
+  }
+  fclose(f);
+}
+
+static void print_ansi(const host_led_frame& fr, bool raw)
+{
+  printf("%8.3f ", fr.t_us / 1e6);
+  for (size_t i = 0; i + 2 < fr.rgb.size(); i += 3)
+    printf("\x1b[48;2;%u;%u;%um ", to_display(fr.rgb[i], raw), to_display(fr.rgb[i + 1], raw), to_display(fr.rgb[i + 2], raw));
+  printf("\x1b[0m\n");
+}
+
+// Builds with several outputs (LED_OUTPUTS) refresh one strip per output. Join the latest state of
+// every output, in order of first appearance (= table order), into one frame per refresh time.
+static std::vector<host_led_frame> join_outputs(std::vector<host_led_frame> raw)
+{
+  std::vector<int> order;
+  std::map<int, std::vector<uint8_t>> latest;
+  for (const host_led_frame& fr : raw)
+  {
+    if (latest.count(fr.gpio) == 0)
+    {
+      order.push_back(fr.gpio);
+      latest[fr.gpio] = std::vector<uint8_t>(fr.rgb.size(), 0);
+    }
+  }
+  if (order.size() <= 1)
+    return raw;
+
+  std::vector<host_led_frame> joined;
+  for (size_t i = 0; i < raw.size(); ++i)
+  {
+    latest[raw[i].gpio] = raw[i].rgb;
+    if (i + 1 < raw.size() && raw[i + 1].t_us == raw[i].t_us)
+      continue;
+    host_led_frame fr = {raw[i].t_us, -1, {}};
+    for (int gpio : order)
+      fr.rgb.insert(fr.rgb.end(), latest[gpio].begin(), latest[gpio].end());
+    joined.push_back(fr);
+  }
+  return joined;
+}
+
+static bool parse_args(int argc, char** argv, options& opt)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string a = argv[i];
+    const bool has_val = (i + 1 < argc);
+    if (a == "--scenario" && has_val)
+      opt.scenario = argv[++i];
+    else if (a == "--ppm" && has_val)
+      opt.ppm = argv[++i];
+    else if (a == "--frames" && has_val)
+      opt.frames_dir = argv[++i];
+    else if (a == "--every" && has_val)
+      opt.every = std::max(1, atoi(argv[++i]));
+    else if (a == "--px" && has_val)
+      opt.px = std::max(1, atoi(argv[++i]));
+    else if (a == "--ansi")
+      opt.ansi = true;
+    else if (a == "--raw")
+      opt.raw = true;
+    else if (a == "--udp")
+      opt.udp = true;
+    else if (a == "--target-us" && has_val)
+      opt.target_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (a == "--floor-us" && has_val)
+      opt.floor_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else
+    {
+      fprintf(stderr,
+              "usage: %s [--scenario FILE] [--ppm FILE] [--frames DIR] [--ansi] [--every N] [--px N] [--raw] [--udp] "
+              "[--target-us N] [--floor-us N]\n",
+              argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  options opt;
+  if (!parse_args(argc, argv, opt))
+    return 2;
+
+  std::string text = k_default_scenario;
+  if (!opt.scenario.empty())
+  {
+    std::ifstream f(opt.scenario);
+    if (!f)
+    {
+      fprintf(stderr, "cannot read %s\n", opt.scenario.c_str());
+      return 2;
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    text = ss.str();
+  }
+  const std::vector<scenario_event> events = parse_scenario(text);
+  for (const scenario_event& ev : events)
+  {
+    if (ev.cmd == "expect")
+    {
+      opt.floor_us = opt.floor_us ? opt.floor_us : (uint32_t)strtoul(ev.a.c_str(), NULL, 10);
+      opt.target_us = opt.target_us ? opt.target_us : (uint32_t)strtoul(ev.b.c_str(), NULL, 10);
+    }
+  }
+
+  esp_log_level_set("*", ESP_LOG_WARN);
+  if (!opt.udp)
+    host_sim_use_virtual_time();
+  pir312_init();
+  light_sensor_init();
+  ws2812b_led_init();
+  if (opt.udp)
+    led_stream_start();
+
+  const auto wall0 = std::chrono::steady_clock::now();
+  int64_t end_ms = 0;
+  for (const scenario_event& ev : events)
+  {
+    if (opt.udp)
+      std::this_thread::sleep_until(wall0 + std::chrono::milliseconds(ev.t_ms));
+    else
+      host_sim_advance_to(ev.t_ms * 1000);
+    end_ms = ev.t_ms;
+    if (!apply_event(ev))
+      break;
+  }
+  if (!opt.udp)
+  {
+    host_sim_advance_to(end_ms * 1000);
+    host_sim_wait_idle();
+  }
+  host_led_set_recording(false);
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+
+  const std::vector<host_led_frame> frames = join_outputs(host_led_take_frames());
+  std::vector<const host_led_frame*> picked;
+  for (size_t i = 0; i < frames.size(); i += (size_t)opt.every)
+    picked.push_back(&frames[i]);
+
+  if (opt.ansi)
+  {
+    for (const host_led_frame* fr : picked)
+      print_ansi(*fr, opt.raw);
+  }
+  if (!opt.ppm.empty())
+  {
+    write_ppm(opt.ppm, picked, opt.px, opt.raw);
+  }
+  if (!opt.frames_dir.empty())
+  {
+    for (size_t i = 0; i < picked.size(); ++i)
+    {
+      char name[32];
+      snprintf(name, sizeof(name), "/frame_%05zu.ppm", i);
+      write_ppm(opt.frames_dir + name, std::vector<const host_led_frame*>{picked[i]}, opt.px, opt.raw);
+    }
+  }
+
+  ws2812b_stats_t st = {};
+  ws2812b_get_stats(&st);
+  fprintf(stderr,
+          "simulated %lld ms: %zu frames refreshed on %u output(s), %u skipped unchanged; %.1f ms wall, %.2f us/frame; "
+          "power avg %u mA peak %u mA\n",
+          (long long)end_ms,
+          frames.size(),
+          (unsigned)st.outputs,
+          (unsigned)st.skipped,
+          wall_s * 1e3,
+          frames.empty() ? 0.0 : wall_s * 1e6 / (double)(st.frames + st.skipped),
+          (unsigned)st.power_ma_avg,
+          (unsigned)st.power_ma_peak);
+  ws2812b_latency_t lt = {};
+  ws2812b_get_latency(&lt);
+  fprintf(stderr,
+          "motion-to-light: %u traced (%u unchanged) p50 %u us p95 %u us max %u us; "
+          "frame interval p50 %u us p95 %u us max %u us, jitter avg %u us, %u missed\n",
+          (unsigned)lt.motion_samples,
+          (unsigned)lt.motion_unchanged,
+          (unsigned)lt.motion_p50_us,
+          (unsigned)lt.motion_p95_us,
+          (unsigned)lt.motion_max_us,
+          (unsigned)lt.interval_p50_us,
+          (unsigned)lt.interval_p95_us,
+          (unsigned)lt.interval_max_us,
+          (unsigned)lt.jitter_us_avg,
+          (unsigned)lt.missed_deadlines);
+  fprintf(stderr, "idle: %u entries, %u ms (%s at the end)\n", (unsigned)st.idle_entries, (unsigned)st.idle_ms,
+          st.idle ? "idle" : "active");
+  if (opt.udp)
+  {
+    led_stream_stats_t ss = {};
+    led_stream_get_stats(&ss);
+    fprintf(stderr,
+            "stream: %u packets, %u frames, %u dropped, %u sequence gaps\n",
+            (unsigned)ss.packets,
+            (unsigned)ss.frames,
+            (unsigned)ss.dropped,
+            (unsigned)ss.seq_gaps);
+  }
+  if ((opt.target_us > 0 || opt.floor_us > 0) && lt.motion_samples == 0)
+  {
+    fprintf(stderr, "no motion onset traced, nothing to check\n");
+    return 1;
+  }
+  if (opt.target_us > 0 && lt.motion_p95_us > opt.target_us)
+  {
+    fprintf(stderr, "motion-to-light p95 %u us is above the %u us target\n", (unsigned)lt.motion_p95_us, (unsigned)opt.target_us);
+    return 1;
+  }
+  if (opt.floor_us > 0 && lt.motion_p50_us < opt.floor_us)
+  {
+    fprintf(stderr, "motion-to-light p50 %u us is below the %u us floor\n", (unsigned)lt.motion_p50_us, (unsigned)opt.floor_us);
+    return 1;
+  }
+  return 0;
+}
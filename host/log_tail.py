@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Print the device log from its RAM ring and follow it, like tail -f.
+
+    log_tail.py [--host 192.168.4.1] [--level I] [--all] [--once]
+
+Long-polls GET /log?level=&since=&wait= and continues from the X-Log-Next sequence number it
+returns. Without --all only new lines are shown; --once prints what is buffered and exits.
+"""
+
+import argparse
+import sys
+import time
+import urllib.request
+
+
+def fetch(host, level, since, wait_ms):
+    url = f"http://{host}/log?level={level}&since={since}&wait={wait_ms}"
+    with urllib.request.urlopen(url, timeout=10) as resp:
+        return resp.read().decode("utf-8", "replace"), int(resp.headers.get("X-Log-Next", since))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--host", default="192.168.4.1")
+    ap.add_argument("--level", default="I", choices="EWIDV")
+    ap.add_argument("--all", action="store_true", help="start with the lines still buffered")
+    ap.add_argument("--once", action="store_true")
+    args = ap.parse_args()
+
+    text, since = fetch(args.host, args.level, 0, 0)
+    if args.all or args.once:
+        sys.stdout.write(text)
+    while not args.once:
+        try:
+            text, nxt = fetch(args.host, args.level, since, 2000)
+        except OSError as e:
+            print(f"-- {e}, retrying", file=sys.stderr)
+            time.sleep(2)
+            continue
+        if nxt < since:
+            print("-- device restarted", file=sys.stderr)
+            text, nxt = fetch(args.host, args.level, 0, 0)
+        sys.stdout.write(text)
+        sys.stdout.flush()
+        since = nxt
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Make a delta OTA patch that turns the running firmware (base) into a new one.
+
+    ota_delta.py base.bin new.bin -o update.otad
+
+The device rebuilds the new image from its running partition and the patch (format in
+include/ota_delta.h), so only the patch crosses the network; ota_upload.py --base does this and
+gzips the patch on the fly. The patch is tied to the base through the app_elf_sha256 in its app
+descriptor, and the upload carries the SHA-256 of the new image, which the device checks before
+switching the boot partition.
+
+Matching is bsdiff-like: exact seed matches are found through a hash of base windows, then
+extended forwards while most bytes still agree. Extended regions are sent as byte differences to
+the base (mostly zeros after a code shift, which gzip squeezes well), the rest as literals.
+"""
+
+import argparse
+import struct
+import sys
+
+OP_COPY = 1
+OP_DIFF = 2
+OP_DATA = 3
+
+SEED = 24  # bytes that must match exactly to start a match
+STEP = 4  # base indexing stride; matches of at least SEED + STEP - 1 bytes are always found
+APP_DESC_SHA_OFFSET = 24 + 8 + 144  # image header + first segment header + offset in esp_app_desc_t
+
+
+def app_elf_sha256(image):
+    return image[APP_DESC_SHA_OFFSET:APP_DESC_SHA_OFFSET + 32]
+
+
+def index_base(base):
+    idx = {}
+    for j in range(0, len(base) - SEED + 1, STEP):
+        idx.setdefault(base[j:j + SEED], j)
+    return idx
+
+
+def extend(base, new, i, j):
+    """Length of the approximate match at new[i:], base[j:] (bsdiff's forward extension)."""
+    n = min(len(new) - i, len(base) - j)
+    score = best_score = best = 0
+    for k in range(n):
+        score += 1 if new[i + k] == base[j + k] else -1
+        if score > best_score:
+            best_score, best = score, k + 1
+        elif score < best_score - 64:
+            break
+    return best
+
+
+def make_patch(base, new):
+    idx = index_base(base)
+    ops = []
+    lit = 0  # start of pending literal bytes
+    i = 0
+    last_shift = None  # try the previous match offset first, it usually continues
+    while i <= len(new) - SEED:
+        j = None
+        if last_shift is not None and 0 <= i + last_shift <= len(base) - SEED and base[i + last_shift:i + last_shift + SEED] == new[i:i + SEED]:
+            j = i + last_shift
+        if j is None:
+            j = idx.get(new[i:i + SEED])
+        if j is None:
+            i += 1
+            continue
+        while i > lit and j > 0 and new[i - 1] == base[j - 1]:  # pull the start back into the literal run
+            i -= 1
+            j -= 1
+        n = extend(base, new, i, j)
+        if lit < i:
+            ops.append((OP_DATA, None, new[lit:i]))
+        diff = bytes((new[i + k] - base[j + k]) & 0xFF for k in range(n))
+        ops.append((OP_COPY, j, n) if not any(diff) else (OP_DIFF, j, diff))
+        last_shift = j - i
+        i += n
+        lit = i
+    if lit < len(new):
+        ops.append((OP_DATA, None, new[lit:]))
+
+    out = bytearray(b"OTAD" + struct.pack("<I", len(new)) + app_elf_sha256(base))
+    stats = {OP_COPY: 0, OP_DIFF: 0, OP_DATA: 0}
+    for op, src, arg in ops:
+        if op == OP_COPY:
+            out += struct.pack("<BII", op, src, arg)
+            stats[op] += arg
+        elif op == OP_DIFF:
+            out += struct.pack("<BII", op, src, len(arg)) + arg
+            stats[op] += len(arg)
+        else:
+            out += struct.pack("<BI", op, len(arg)) + arg
+            stats[op] += len(arg)
+    return bytes(out), stats
+
+
+def apply_patch(base, patch):
+    """Reference decoder, used to check a patch before it is sent."""
+    assert patch[:4] == b"OTAD"
+    size = struct.unpack_from("<I", patch, 4)[0]
+    out = bytearray()
+    p = 40
+    while len(out) < size:
+        op = patch[p]
+        if op == OP_DATA:
+            n = struct.unpack_from("<I", patch, p + 1)[0]
+            out += patch[p + 5:p + 5 + n]
+            p += 5 + n
+            continue
+        src, n = struct.unpack_from("<II", patch, p + 1)
+        if op == OP_COPY:
+            out += base[src:src + n]
+            p += 9
+        else:
+            out += bytes((b + d) & 0xFF for b, d in zip(base[src:src + n], patch[p + 9:p + 9 + n]))
+            p += 9 + n
+    return bytes(out)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("base", help="firmware currently running on the device")
+    ap.add_argument("new")
+    ap.add_argument("-o", "--output", required=True)
+    args = ap.parse_args()
+
+    base = open(args.base, "rb").read()
+    new = open(args.new, "rb").read()
+    patch, stats = make_patch(base, new)
+    if apply_patch(base, patch) != new:
+        sys.exit("internal error: patch does not reproduce the new image")
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print(f"{args.output}: {len(patch)} bytes for a {len(new)} byte image "
+          f"(copy {stats[OP_COPY]}, diff {stats[OP_DIFF]}, literal {stats[OP_DATA]})")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Write firmware.bin.gz next to firmware.bin for compressed OTA uploads.
+
+    ota_gzip.py .pio/build/firebeetle32/firmware.bin
+
+Also hooked into the PlatformIO build (extra_scripts in platformio.ini), so every build leaves
+the compressed artifact beside the image. Upload it from the /ota page or with
+`ota_upload.py firmware.bin.gz`; the device decodes it while writing.
+"""
+
+import gzip
+import os
+import sys
+
+
+def compress(path):
+    with open(path, "rb") as f:
+        image = f.read()
+    # mtime=0 keeps the output reproducible; the decoder on the device accepts any gzip header.
+    packed = gzip.compress(image, compresslevel=9, mtime=0)
+    with open(path + ".gz", "wb") as f:
+        f.write(packed)
+    print(f"{os.path.basename(path)}.gz: {len(image)} -> {len(packed)} bytes ({100 * len(packed) / len(image):.1f}%)")
+
+
+try:
+    Import("env")  # noqa: F821  (PlatformIO / SCons)
+
+    def _post_build(source, target, env):
+        compress(str(target[0]))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.bin", _post_build)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        for p in sys.argv[1:]:
+            compress(p)
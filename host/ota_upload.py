@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Upload a firmware image to the device's /update endpoint with its SHA-256 (and signature).
+
+    ota_upload.py firmware.bin[.gz] [--host 192.168.4.1] [--key release_key.pem] [--gzip] [--base running.bin]
+    ota_upload.py firmware.bin --chunk 65536
+
+The device hashes the image while writing it and refuses to switch the boot partition unless the
+digest in X-Image-SHA256 matches. With --key the digest is also signed (openssl dgst -sha256
+-sign, ECDSA P-256 recommended) and sent as X-Image-Signature; firmware built with
+include/ota_signing_key.h (OTA_SIGNING_PUBKEY_PEM, the matching public key) requires it.
+
+A .gz image (see ota_gzip.py), or any image with --gzip, is sent with Content-Encoding: gzip and
+decoded on the device; digest, signature and X-Image-Size always refer to the decoded image.
+With --base (the image the device is running now) only a gzipped delta patch is sent, see
+ota_delta.py.
+With --chunk the raw image goes to /update/chunk in Content-Range pieces; after a dropped
+connection the upload continues from the offset the device reports on /update/status.
+"""
+
+import argparse
+import base64
+import gzip
+import hashlib
+import json
+import subprocess
+import sys
+import time
+import urllib.request
+
+import ota_delta
+
+
+def sign(image, key):
+    return subprocess.run(["openssl", "dgst", "-sha256", "-sign", key], input=image, capture_output=True, check=True).stdout
+
+
+def status(host):
+    with urllib.request.urlopen(f"http://{host}/update/status", timeout=10) as resp:
+        return json.loads(resp.read())
+
+
+def upload_resumable(host, image, headers, chunk, retries):
+    offset = 0
+    failures = 0
+    while True:
+        end = min(offset + chunk, len(image)) - 1
+        h = dict(headers, **{"Content-Range": f"bytes {offset}-{end}/{len(image)}"})
+        req = urllib.request.Request(f"http://{host}/update/chunk", data=image[offset:end + 1], headers=h, method="POST")
+        try:
+            with urllib.request.urlopen(req, timeout=60) as resp:
+                body = resp.read()
+                if resp.status == 200:
+                    print("\n" + body.decode(errors="replace"))
+                    return 0
+                offset = json.loads(body)["offset"]  # 206: more to send
+                print(f"\r{offset}/{len(image)} bytes", end="", flush=True)
+                continue
+        except urllib.error.HTTPError as e:
+            body = e.read()
+            if e.code == 416:  # not where the device is: continue from its offset
+                st = json.loads(body)
+                offset = st["offset"] if st["active"] else 0
+                continue
+            if e.code != 500:
+                print(f"HTTP {e.code}: {body.decode(errors='replace')}", file=sys.stderr)
+                return 1
+        except (urllib.error.URLError, OSError) as e:
+            print(f"\nconnection lost at {offset}: {e}", file=sys.stderr)
+        failures += 1
+        if failures > retries:
+            return 1
+        time.sleep(1)
+        try:
+            st = status(host)
+            offset = st["offset"] if st["active"] else 0
+            print(f"resuming at {offset}")
+        except (urllib.error.URLError, OSError):
+            pass
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("image")
+    ap.add_argument("--host", default="192.168.4.1")
+    ap.add_argument("--key", help="PEM private key to sign the image with")
+    ap.add_argument("--gzip", action="store_true", help="compress before sending")
+    ap.add_argument("--base", help="firmware running on the device: send a delta patch against it")
+    ap.add_argument("--chunk", type=int, default=0, help="resumable upload in chunks of this many bytes")
+    ap.add_argument("--retries", type=int, default=10, help="reconnect attempts for --chunk")
+    args = ap.parse_args()
+
+    with open(args.image, "rb") as f:
+        body = f.read()
+    compressed = args.image.endswith(".gz")
+    image = gzip.decompress(body) if compressed else body
+    if args.base:
+        with open(args.base, "rb") as f:
+            patch, stats = ota_delta.make_patch(f.read(), image)
+        body = gzip.compress(patch, compresslevel=9, mtime=0)
+        compressed = True
+        print(f"delta patch: {len(patch)} bytes (copy {stats[ota_delta.OP_COPY]}, diff {stats[ota_delta.OP_DIFF]}, "
+              f"literal {stats[ota_delta.OP_DATA]})")
+    elif args.gzip and not compressed:
+        body = gzip.compress(image, compresslevel=9, mtime=0)
+        compressed = True
+
+    digest = hashlib.sha256(image).hexdigest()
+    headers = {"Content-Type": "application/octet-stream", "X-Image-SHA256": digest}
+    if args.base:
+        headers["Content-Type"] = "application/x-ota-delta"
+    if compressed:
+        headers["Content-Encoding"] = "gzip"
+        headers["X-Image-Size"] = str(len(image))
+    if args.key:
+        headers["X-Image-Signature"] = base64.b64encode(sign(image, args.key)).decode()
+
+    print(f"{args.image}: {len(image)} bytes, sha256 {digest}")
+    if compressed:
+        print(f"sending gzip: {len(body)} bytes ({100 * len(body) / len(image):.1f}%)")
+    t0 = time.monotonic()
+    if args.chunk > 0:
+        if compressed:
+            sys.exit("--chunk sends raw images only")
+        rc = upload_resumable(args.host, image, headers, args.chunk, args.retries)
+        print(f"upload took {time.monotonic() - t0:.1f} s")
+        return rc
+
+    req = urllib.request.Request(f"http://{args.host}/update", data=body, headers=headers, method="POST")
+    try:
+        with urllib.request.urlopen(req, timeout=120) as resp:
+            print(resp.read().decode(errors="replace"))
+    except urllib.error.HTTPError as e:
+        print(f"HTTP {e.code}: {e.read().decode(errors='replace')}", file=sys.stderr)
+        return 1
+    print(f"upload took {time.monotonic() - t0:.1f} s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,125 @@
+// mbedtls sha256 / base64 / pk stand-ins on OpenSSL's libcrypto. Return codes follow mbedtls:
+// 0 on success, negative on failure.
+
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+#include "mbedtls/base64.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/sha256.h"
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx)
+{
+  ctx->md_ctx = nullptr;
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx)
+{
+  EVP_MD_CTX_free((EVP_MD_CTX*)ctx->md_ctx);
+  ctx->md_ctx = nullptr;
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224)
+{
+  if (ctx->md_ctx == nullptr)
+  {
+    ctx->md_ctx = EVP_MD_CTX_new();
+  }
+  return EVP_DigestInit_ex((EVP_MD_CTX*)ctx->md_ctx, is224 ? EVP_sha224() : EVP_sha256(), nullptr) == 1 ? 0 : -1;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t ilen)
+{
+  return EVP_DigestUpdate((EVP_MD_CTX*)ctx->md_ctx, input, ilen) == 1 ? 0 : -1;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32])
+{
+  unsigned int len = 0;
+  return EVP_DigestFinal_ex((EVP_MD_CTX*)ctx->md_ctx, output, &len) == 1 ? 0 : -1;
+}
+
+int mbedtls_base64_decode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen)
+{
+  static const char k_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  // Like mbedtls: whitespace is skipped, '=' only at the end; a short (or NULL) dst sets *olen only.
+  size_t chars = 0;
+  size_t pad = 0;
+  for (size_t i = 0; i < slen; ++i)
+  {
+    const unsigned char c = src[i];
+    if (c == ' ' || c == '\r' || c == '\n')
+      continue;
+    if (c == '=')
+    {
+      ++pad;
+      continue;
+    }
+    if (pad > 0 || strchr(k_alphabet, c) == nullptr || c == '\0')
+      return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    ++chars;
+  }
+  if (pad > 2 || (chars + pad) % 4 != 0)
+  {
+    return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+  }
+  const size_t need = chars * 6 / 8;
+  *olen = need;
+  if (dst == nullptr || dlen < need)
+  {
+    return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+  }
+  uint32_t acc = 0;
+  int bits = 0;
+  size_t out = 0;
+  for (size_t i = 0; i < slen; ++i)
+  {
+    const char* p = strchr(k_alphabet, src[i]);
+    if (src[i] == '\0' || p == nullptr)
+      continue;
+    acc = (acc << 6) | (uint32_t)(p - k_alphabet);
+    bits += 6;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      dst[out++] = (unsigned char)(acc >> bits);
+    }
+  }
+  *olen = out;
+  return 0;
+}
+
+void mbedtls_pk_init(mbedtls_pk_context* ctx)
+{
+  ctx->pkey = nullptr;
+}
+
+void mbedtls_pk_free(mbedtls_pk_context* ctx)
+{
+  EVP_PKEY_free((EVP_PKEY*)ctx->pkey);
+  ctx->pkey = nullptr;
+}
+
+int mbedtls_pk_parse_public_key(mbedtls_pk_context* ctx, const unsigned char* key, size_t keylen)
+{
+  // mbedtls counts the terminating NUL of a PEM key in keylen.
+  BIO* bio = BIO_new_mem_buf(key, (int)((keylen > 0 && key[keylen - 1] == '\0') ? keylen - 1 : keylen));
+  ctx->pkey = (bio != nullptr) ? PEM_read_bio_PUBKEY(bio, nullptr, nullptr, nullptr) : nullptr;
+  BIO_free(bio);
+  return (ctx->pkey != nullptr) ? 0 : -0x3D00; // MBEDTLS_ERR_PK_KEY_INVALID_FORMAT
+}
+
+int mbedtls_pk_verify(mbedtls_pk_context* ctx, mbedtls_md_type_t md_alg, const unsigned char* hash, size_t hash_len,
+                      const unsigned char* sig, size_t sig_len)
+{
+  EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new((EVP_PKEY*)ctx->pkey, nullptr);
+  int ok = pctx != nullptr && EVP_PKEY_verify_init(pctx) == 1;
+  if (ok && md_alg == MBEDTLS_MD_SHA256)
+  {
+    ok = EVP_PKEY_CTX_set_signature_md(pctx, EVP_sha256()) == 1;
+  }
+  ok = ok && EVP_PKEY_verify(pctx, sig, sig_len, hash, hash_len) == 1;
+  EVP_PKEY_CTX_free(pctx);
+  return ok ? 0 : -0x4380; // MBEDTLS_ERR_RSA_VERIFY_FAILED
+}
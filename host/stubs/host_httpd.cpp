@@ -0,0 +1,609 @@
+// esp_http_server stand-in on POSIX sockets.
+//
+// Like the IDF server, one task polls the listening socket and every open connection and runs one
+// request at a time, so handler latency, long polls and uploads interact the way they do on the
+// device. Requests are HTTP/1.1 with keep-alive and Content-Length bodies (no chunked uploads, as
+// in IDF). Differences: the listening port can be moved (host_httpd_set_port()), and a handler
+// that returns without responding gets its connection closed instead of left hanging.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <strings.h>
+#include <utility>
+#include <vector>
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_sim.h"
+#include "lwip/sockets.h"
+
+#define HOST_HTTPD_HEAD_MAX 8192 // request line + headers
+#define HOST_HTTPD_POLL_MS  200  // how quickly httpd_stop() is noticed
+
+static const char* TAG = "host_httpd";
+
+namespace
+{
+  typedef std::vector<std::pair<std::string, std::string>> header_list;
+
+  struct route
+  {
+    std::string uri;
+    httpd_uri_t def; // def.uri points into `uri`
+  };
+
+  struct server
+  {
+    httpd_config_t cfg;
+    int listen_fd = -1;
+    std::vector<route*> routes;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> running{false};
+  };
+
+  struct connection
+  {
+    int fd;
+    std::string in; // received, not yet consumed
+    int64_t last_use_us;
+  };
+
+  // httpd_req_t::aux
+  struct request
+  {
+    server* srv;
+    int fd;
+    std::string uri;
+    header_list headers;
+    std::string pending; // body bytes that arrived with the head
+    size_t remaining;    // body bytes not yet handed to the handler
+    bool keep_alive;
+    std::string status = "200 OK";
+    std::string type = "text/html";
+    header_list resp_headers;
+    bool responded = false;
+  };
+
+  int s_port_override = 0;
+
+  int64_t now_us()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  request* state(httpd_req_t* r)
+  {
+    return (r != nullptr) ? (request*)r->aux : nullptr;
+  }
+
+  bool send_all(int fd, const char* data, size_t len)
+  {
+    while (len > 0)
+    {
+      const ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      data += n;
+      len -= (size_t)n;
+    }
+    return true;
+  }
+
+  void send_error(int fd, const char* status, const char* text)
+  {
+    char buf[256];
+    const int n = snprintf(buf, sizeof(buf),
+                           "HTTP/1.1 %s\r\nContent-Type: text/html\r\nContent-Length: %u\r\nConnection: close\r\n\r\n%s", status,
+                           (unsigned)strlen(text), text);
+    send_all(fd, buf, (size_t)n);
+  }
+
+  int method_of(const std::string& m)
+  {
+    static const char* const k_names[] = {"DELETE", "GET", "HEAD", "POST", "PUT"};
+    for (int i = 0; i < (int)(sizeof(k_names) / sizeof(k_names[0])); ++i)
+    {
+      if (m == k_names[i])
+        return i;
+    }
+    return -1;
+  }
+
+  const char* find_header(const header_list& headers, const char* field)
+  {
+    for (const auto& h : headers)
+    {
+      if (strcasecmp(h.first.c_str(), field) == 0)
+        return h.second.c_str();
+    }
+    return nullptr;
+  }
+
+  bool uri_matches(const server* srv, const route* rt, const std::string& uri)
+  {
+    const size_t path_len = std::min(uri.find('?'), uri.size());
+    if (srv->cfg.uri_match_fn != nullptr)
+    {
+      return srv->cfg.uri_match_fn(rt->uri.c_str(), uri.c_str(), path_len);
+    }
+    return rt->uri.size() == path_len && uri.compare(0, path_len, rt->uri) == 0;
+  }
+
+  // Parses the head in c.in (complete up to head_len) and runs the handler. Returns false when the
+  // connection must be closed.
+  bool serve(server* srv, connection& c, size_t head_len)
+  {
+    const std::string head = c.in.substr(0, head_len);
+    size_t line_end = head.find("\r\n");
+    const std::string line = head.substr(0, line_end);
+    const size_t sp1 = line.find(' ');
+    const size_t sp2 = (sp1 == std::string::npos) ? std::string::npos : line.find(' ', sp1 + 1);
+    if (sp2 == std::string::npos)
+    {
+      send_error(c.fd, "400 Bad Request", "Bad request syntax");
+      return false;
+    }
+    const std::string version = line.substr(sp2 + 1);
+
+    request rq;
+    rq.srv = srv;
+    rq.fd = c.fd;
+    rq.uri = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    for (size_t pos = line_end + 2; pos < head_len;)
+    {
+      const size_t end = head.find("\r\n", pos);
+      const std::string h = head.substr(pos, end - pos);
+      pos = end + 2;
+      const size_t colon = h.find(':');
+      if (h.empty() || colon == std::string::npos)
+        continue;
+      const size_t v = h.find_first_not_of(" \t", colon + 1);
+      rq.headers.emplace_back(h.substr(0, colon), (v == std::string::npos) ? "" : h.substr(v));
+    }
+    const char* conn_hdr = find_header(rq.headers, "Connection");
+    rq.keep_alive = (version == "HTTP/1.1") ? !(conn_hdr && strcasecmp(conn_hdr, "close") == 0)
+                                            : (conn_hdr && strcasecmp(conn_hdr, "keep-alive") == 0);
+    const char* te = find_header(rq.headers, "Transfer-Encoding");
+    const char* cl = find_header(rq.headers, "Content-Length");
+    const size_t content_len = (cl != nullptr) ? (size_t)strtoull(cl, nullptr, 10) : 0;
+    const int method = method_of(line.substr(0, sp1));
+    if (te != nullptr || method < 0 || rq.uri.size() > HTTPD_MAX_URI_LEN)
+    {
+      send_error(c.fd, "501 Method Not Implemented", "Server has encountered an unsupported request");
+      return false;
+    }
+
+    const size_t body_now = std::min(content_len, c.in.size() - head_len);
+    rq.pending = c.in.substr(head_len, body_now);
+    rq.remaining = content_len;
+    c.in.erase(0, head_len + body_now);
+
+    const route* match = nullptr;
+    bool other_method = false;
+    for (const route* rt : srv->routes)
+    {
+      if (uri_matches(srv, rt, rq.uri))
+      {
+        if (rt->def.method == method)
+        {
+          match = rt;
+          break;
+        }
+        other_method = true;
+      }
+    }
+    if (match == nullptr)
+    {
+      if (other_method)
+        send_error(c.fd, "405 Method Not Allowed", "Request method for this URI is not handled by server");
+      else
+        send_error(c.fd, "404 Not Found", "Nothing matches the given URI");
+      return false;
+    }
+
+    httpd_req_t req = {};
+    req.handle = srv;
+    req.method = method;
+    snprintf((char*)req.uri, sizeof(req.uri), "%s", rq.uri.c_str());
+    req.content_len = content_len;
+    req.aux = &rq;
+    req.user_ctx = match->def.user_ctx;
+    const esp_err_t err = match->def.handler(&req);
+    if (err != ESP_OK || !rq.responded)
+    {
+      return false;
+    }
+
+    // Whatever body the handler left unread is discarded (as in IDF).
+    char sink[1024];
+    while (rq.remaining > 0)
+    {
+      if (httpd_req_recv(&req, sink, sizeof(sink)) <= 0)
+        return false;
+    }
+    return rq.keep_alive;
+  }
+
+  void close_connection(std::vector<connection>& conns, size_t i)
+  {
+    close(conns[i].fd);
+    conns.erase(conns.begin() + (long)i);
+  }
+
+  void server_task(void* arg)
+  {
+    server* srv = (server*)arg;
+    std::vector<connection> conns;
+    std::vector<pollfd> fds;
+    while (!srv->stop)
+    {
+      fds.clear();
+      fds.push_back(pollfd{srv->listen_fd, POLLIN, 0});
+      for (const connection& c : conns)
+        fds.push_back(pollfd{c.fd, POLLIN, 0});
+      if (poll(fds.data(), fds.size(), HOST_HTTPD_POLL_MS) <= 0)
+        continue;
+
+      // Connections first (indices match fds[1..]), from the back so closing one keeps the rest valid.
+      for (size_t i = conns.size(); i-- > 0;)
+      {
+        if ((fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+          continue;
+        connection& c = conns[i];
+        char buf[4096];
+        const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+          close_connection(conns, i);
+          continue;
+        }
+        c.in.append(buf, (size_t)n);
+        c.last_use_us = now_us();
+        bool keep = true;
+        for (size_t head_end; keep && (head_end = c.in.find("\r\n\r\n")) != std::string::npos;)
+        {
+          keep = serve(srv, c, head_end + 4);
+        }
+        if (keep && c.in.size() > HOST_HTTPD_HEAD_MAX)
+        {
+          send_error(c.fd, "431 Request Header Fields Too Large", "Header fields are too long");
+          keep = false;
+        }
+        if (!keep)
+          close_connection(conns, i);
+      }
+
+      if (fds[0].revents & POLLIN)
+      {
+        const int fd = accept(srv->listen_fd, nullptr, nullptr);
+        if (fd < 0)
+          continue;
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (conns.size() >= srv->cfg.max_open_sockets)
+        {
+          if (!srv->cfg.lru_purge_enable)
+          {
+            close(fd);
+            continue;
+          }
+          size_t lru = 0;
+          for (size_t i = 1; i < conns.size(); ++i)
+          {
+            if (conns[i].last_use_us < conns[lru].last_use_us)
+              lru = i;
+          }
+          close_connection(conns, lru);
+        }
+        conns.push_back(connection{fd, std::string(), now_us()});
+      }
+    }
+    for (const connection& c : conns)
+      close(c.fd);
+    close(srv->listen_fd);
+    srv->running = false;
+    vTaskDelete(nullptr);
+  }
+
+  esp_err_t copy_out(const char* value, char* out, size_t size)
+  {
+    if (out == nullptr || size == 0)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    snprintf(out, size, "%s", value);
+    return (strlen(value) >= size) ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+  }
+} // namespace
+
+// ---------- host control ----------
+void host_httpd_set_port(int port)
+{
+  s_port_override = port;
+}
+
+// ---------- server ----------
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config)
+{
+  if (handle == nullptr || config == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  server* srv = new server();
+  srv->cfg = *config;
+  const int port = (s_port_override > 0) ? s_port_override : config->server_port;
+  srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  const int one = 1;
+  setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (srv->listen_fd < 0 || bind(srv->listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(srv->listen_fd, config->backlog_conn) != 0)
+  {
+    ESP_LOGE(TAG, "cannot listen on port %d: %s", port, strerror(errno));
+    if (srv->listen_fd >= 0)
+      close(srv->listen_fd);
+    delete srv;
+    return ESP_FAIL;
+  }
+  srv->running = true;
+  if (xTaskCreatePinnedToCore(server_task, "httpd", (uint32_t)config->stack_size, srv, config->task_priority, nullptr,
+                              config->core_id) != pdPASS)
+  {
+    close(srv->listen_fd);
+    delete srv;
+    return ESP_ERR_HTTPD_TASK;
+  }
+  ESP_LOGI(TAG, "listening on port %d", port);
+  *handle = srv;
+  return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+  server* srv = (server*)handle;
+  if (srv == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  srv->stop = true;
+  if (xTaskGetCurrentTaskHandle() != nullptr && srv->running)
+  {
+    // From a task: wait for the server task to close its sockets (not from a handler, it would
+    // wait for itself; there the server leaks, which only matters for repeated restarts).
+    for (int i = 0; i < 50 && srv->running; ++i)
+      vTaskDelay(pdMS_TO_TICKS(HOST_HTTPD_POLL_MS / 5));
+  }
+  return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler)
+{
+  server* srv = (server*)handle;
+  if (srv == nullptr || uri_handler == nullptr || uri_handler->uri == nullptr || uri_handler->handler == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (const route* rt : srv->routes)
+  {
+    if (rt->uri == uri_handler->uri && rt->def.method == uri_handler->method)
+      return ESP_ERR_HTTPD_HANDLER_EXISTS;
+  }
+  if (srv->routes.size() >= srv->cfg.max_uri_handlers)
+  {
+    return ESP_ERR_HTTPD_HANDLERS_FULL;
+  }
+  route* rt = new route{uri_handler->uri, *uri_handler};
+  rt->def.uri = rt->uri.c_str();
+  srv->routes.push_back(rt);
+  return ESP_OK;
+}
+
+// Same rules as IDF: a trailing '*' matches any rest, a trailing '?' makes the character before
+// it optional, and "?*" combines both.
+bool httpd_uri_match_wildcard(const char* uri_template, const char* uri_to_match, size_t match_upto)
+{
+  const size_t tpl_len = strlen(uri_template);
+  const char last = (tpl_len > 0) ? uri_template[tpl_len - 1] : 0;
+  const char prevlast = (tpl_len > 1) ? uri_template[tpl_len - 2] : 0;
+  const bool asterisk = last == '*' || (prevlast == '*' && last == '?');
+  const bool quest = last == '?' || (prevlast == '?' && last == '*');
+  const size_t special = (asterisk ? 1 : 0) + (quest ? 2 : 0);
+  if (tpl_len < special)
+  {
+    return false;
+  }
+  const size_t exact = tpl_len - special;
+  if (match_upto < exact)
+  {
+    return false;
+  }
+  if (!quest)
+  {
+    if (!asterisk && match_upto != exact)
+      return false;
+    return strncmp(uri_template, uri_to_match, exact) == 0;
+  }
+  if (match_upto > exact && uri_template[exact] != uri_to_match[exact])
+  {
+    return false;
+  }
+  if (strncmp(uri_template, uri_to_match, exact) != 0)
+  {
+    return false;
+  }
+  return asterisk || match_upto <= exact + 1;
+}
+
+// ---------- request ----------
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len)
+{
+  request* rq = state(r);
+  if (rq == nullptr || buf == nullptr)
+  {
+    return HTTPD_SOCK_ERR_INVALID;
+  }
+  const size_t want = std::min(buf_len, rq->remaining);
+  if (want == 0)
+  {
+    return 0;
+  }
+  if (!rq->pending.empty())
+  {
+    const size_t n = std::min(want, rq->pending.size());
+    memcpy(buf, rq->pending.data(), n);
+    rq->pending.erase(0, n);
+    rq->remaining -= n;
+    return (int)n;
+  }
+  pollfd p = {rq->fd, POLLIN, 0};
+  const int ready = poll(&p, 1, rq->srv->cfg.recv_wait_timeout * 1000);
+  if (ready == 0)
+  {
+    return HTTPD_SOCK_ERR_TIMEOUT;
+  }
+  const ssize_t n = (ready > 0) ? recv(rq->fd, buf, want, 0) : -1;
+  if (n <= 0)
+  {
+    return HTTPD_SOCK_ERR_FAIL;
+  }
+  rq->remaining -= (size_t)n;
+  return (int)n;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field)
+{
+  request* rq = state(r);
+  const char* v = (rq != nullptr && field != nullptr) ? find_header(rq->headers, field) : nullptr;
+  return (v != nullptr) ? strlen(v) : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val, size_t val_size)
+{
+  request* rq = state(r);
+  if (rq == nullptr || field == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const char* v = find_header(rq->headers, field);
+  return (v != nullptr) ? copy_out(v, val, val_size) : ESP_ERR_NOT_FOUND;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t* r)
+{
+  request* rq = state(r);
+  const size_t q = (rq != nullptr) ? rq->uri.find('?') : std::string::npos;
+  return (q != std::string::npos) ? rq->uri.size() - q - 1 : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len)
+{
+  request* rq = state(r);
+  if (rq == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const size_t q = rq->uri.find('?');
+  return (q != std::string::npos) ? copy_out(rq->uri.c_str() + q + 1, buf, buf_len) : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size)
+{
+  if (qry == nullptr || key == nullptr || val == nullptr || val_size == 0)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const size_t key_len = strlen(key);
+  for (const char* p = qry; *p != '\0';)
+  {
+    const char* end = strchr(p, '&');
+    end = (end != nullptr) ? end : p + strlen(p);
+    const char* eq = (const char*)memchr(p, '=', (size_t)(end - p));
+    const char* key_end = (eq != nullptr) ? eq : end;
+    if ((size_t)(key_end - p) == key_len && strncmp(p, key, key_len) == 0)
+    {
+      const std::string value = (eq != nullptr) ? std::string(eq + 1, end) : std::string();
+      return copy_out(value.c_str(), val, val_size);
+    }
+    p = (*end == '&') ? end + 1 : end;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+// ---------- response ----------
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status)
+{
+  request* rq = state(r);
+  if (rq == nullptr || status == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  rq->status = status;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type)
+{
+  request* rq = state(r);
+  if (rq == nullptr || type == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  rq->type = type;
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value)
+{
+  request* rq = state(r);
+  if (rq == nullptr || field == nullptr || value == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (rq->resp_headers.size() >= rq->srv->cfg.max_resp_headers)
+  {
+    return ESP_ERR_HTTPD_RESP_HDR;
+  }
+  rq->resp_headers.emplace_back(field, value);
+  return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len)
+{
+  request* rq = state(r);
+  if (rq == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const size_t len = (buf == nullptr) ? 0 : (buf_len == HTTPD_RESP_USE_STRLEN) ? strlen(buf) : (size_t)buf_len;
+  std::string head = "HTTP/1.1 " + rq->status + "\r\nContent-Type: " + rq->type + "\r\nContent-Length: " + std::to_string(len) + "\r\n";
+  for (const auto& h : rq->resp_headers)
+  {
+    if (strcasecmp(h.first.c_str(), "Content-Length") == 0)
+      continue; // always sent from buf_len above
+    head += h.first + ": " + h.second + "\r\n";
+  }
+  if (!rq->keep_alive)
+  {
+    head += "Connection: close\r\n";
+  }
+  head += "\r\n";
+  rq->responded = true;
+  if (!send_all(rq->fd, head.data(), head.size()) || !send_all(rq->fd, buf, len))
+  {
+    return ESP_ERR_HTTPD_RESP_SEND;
+  }
+  return ESP_OK;
+}
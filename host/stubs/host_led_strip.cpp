@@ -0,0 +1,132 @@
+// led_strip stand-in: keeps the pixel buffer and records every refresh as a frame. A refresh takes
+// the WS2812 wire time (30 us per pixel plus the latch reset), so waiting for it moves the clock
+// as on the device and motion-to-light latencies include the transmission.
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "esp_timer.h"
+#include "host_sim.h"
+#include "led_strip.h"
+#include "led_strip_rmt.h"
+#include "led_strip_spi.h"
+
+struct led_strip_t
+{
+  int gpio;
+  std::vector<uint8_t> rgb;
+  int64_t busy_until_us; // end of the transmission in flight
+};
+
+namespace
+{
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  bool s_recording = true;
+  std::vector<host_led_frame> s_frames;
+  const int64_t k_pixel_us = 30;  // 24 bits at 800 kHz
+  const int64_t k_reset_us = 280; // latch reset of current WS2812B parts
+
+  esp_err_t new_strip(const led_strip_config_t* cfg, led_strip_handle_t* out)
+  {
+    if (cfg == nullptr || out == nullptr || cfg->max_leds == 0)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    *out = new led_strip_t{cfg->strip_gpio_num, std::vector<uint8_t>(cfg->max_leds * 3, 0), 0};
+    return ESP_OK;
+  }
+} // namespace
+
+std::vector<host_led_frame> host_led_take_frames()
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  std::vector<host_led_frame> out;
+  out.swap(s_frames);
+  return out;
+}
+
+void host_led_set_recording(bool on)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_recording = on;
+}
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t* led_config, const led_strip_rmt_config_t*, led_strip_handle_t* ret_strip)
+{
+  return new_strip(led_config, ret_strip);
+}
+
+esp_err_t led_strip_new_spi_device(const led_strip_config_t* led_config, const led_strip_spi_config_t*, led_strip_handle_t* ret_strip)
+{
+  return new_strip(led_config, ret_strip);
+}
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
+{
+  if (strip == nullptr || index * 3 >= strip->rgb.size())
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  strip->rgb[index * 3 + 0] = (uint8_t)red;
+  strip->rgb[index * 3 + 1] = (uint8_t)green;
+  strip->rgb[index * 3 + 2] = (uint8_t)blue;
+  return ESP_OK;
+}
+
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip)
+{
+  if (strip == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const int64_t now = esp_timer_get_time();
+  std::lock_guard<std::mutex> lk(s_mu);
+  strip->busy_until_us = now + (int64_t)(strip->rgb.size() / 3) * k_pixel_us + k_reset_us;
+  if (s_recording)
+  {
+    s_frames.push_back(host_led_frame{now, strip->gpio, strip->rgb});
+  }
+  return ESP_OK;
+}
+
+esp_err_t led_strip_refresh_wait_done(led_strip_handle_t strip)
+{
+  if (strip == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t busy_until_us = 0;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    busy_until_us = strip->busy_until_us;
+  }
+  const int64_t left_us = busy_until_us - esp_timer_get_time();
+  if (left_us > 0)
+  {
+    host_sim_sleep_us(left_us);
+  }
+  return ESP_OK;
+}
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip)
+{
+  const esp_err_t err = led_strip_refresh_async(strip);
+  return (err == ESP_OK) ? led_strip_refresh_wait_done(strip) : err;
+}
+
+esp_err_t led_strip_clear(led_strip_handle_t strip)
+{
+  if (strip == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::fill(strip->rgb.begin(), strip->rgb.end(), 0);
+  return led_strip_refresh(strip); // the real backends also send the cleared frame
+}
+
+esp_err_t led_strip_del(led_strip_handle_t strip)
+{
+  delete strip;
+  return ESP_OK;
+}
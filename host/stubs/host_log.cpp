@@ -0,0 +1,95 @@
+// esp_log / esp_err stand-ins.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace
+{
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  esp_log_level_t s_default = ESP_LOG_INFO;
+  std::map<std::string, esp_log_level_t> s_levels;
+  vprintf_like_t s_vprintf = &vprintf;
+} // namespace
+
+void esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (tag == nullptr || strcmp(tag, "*") == 0)
+  {
+    s_default = level;
+    s_levels.clear();
+    return;
+  }
+  s_levels[tag] = level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  vprintf_like_t prev = s_vprintf;
+  s_vprintf = func;
+  return prev;
+}
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+  vprintf_like_t out = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    auto it = s_levels.find(tag ? tag : "");
+    const esp_log_level_t limit = (it != s_levels.end()) ? it->second : s_default;
+    if (level > limit)
+    {
+      return;
+    }
+    out = s_vprintf;
+  }
+  va_list ap;
+  va_start(ap, format);
+  out(format, ap);
+  va_end(ap);
+}
+
+const char* esp_err_to_name(esp_err_t code)
+{
+  switch (code)
+  {
+  case ESP_OK:
+    return "ESP_OK";
+  case ESP_FAIL:
+    return "ESP_FAIL";
+  case ESP_ERR_NO_MEM:
+    return "ESP_ERR_NO_MEM";
+  case ESP_ERR_INVALID_ARG:
+    return "ESP_ERR_INVALID_ARG";
+  case ESP_ERR_INVALID_STATE:
+    return "ESP_ERR_INVALID_STATE";
+  case ESP_ERR_INVALID_SIZE:
+    return "ESP_ERR_INVALID_SIZE";
+  case ESP_ERR_NOT_FOUND:
+    return "ESP_ERR_NOT_FOUND";
+  case ESP_ERR_NOT_SUPPORTED:
+    return "ESP_ERR_NOT_SUPPORTED";
+  case ESP_ERR_TIMEOUT:
+    return "ESP_ERR_TIMEOUT";
+  case ESP_ERR_INVALID_RESPONSE:
+    return "ESP_ERR_INVALID_RESPONSE";
+  case ESP_ERR_INVALID_VERSION:
+    return "ESP_ERR_INVALID_VERSION";
+  default:
+    return "UNKNOWN ERROR";
+  }
+}
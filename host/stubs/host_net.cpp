@@ -0,0 +1,531 @@
+// esp_event (default loop), esp_netif, esp_wifi, provisioning and mdns stand-ins.
+//
+// The "network" is simulated: the device is provisioned for the AP "host-sim", every connect
+// succeeds after HOST_WIFI_ASSOC_MS and DHCP hands out 192.168.4.2/24. Events run on the loop
+// task like on the device, so the firmware's own connect/reconnect logic is what runs. The HTTP
+// server and UDP sockets bind to the host's real interfaces (see host_httpd.cpp).
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "mdns.h"
+#include "wifi_provisioning/manager.h"
+#include "wifi_provisioning/scheme_softap.h"
+
+#define HOST_WIFI_ASSOC_MS 150
+#define HOST_WIFI_DHCP_MS  50
+#define HOST_EVENT_DATA    64
+
+const esp_event_base_t WIFI_EVENT = "WIFI_EVENT";
+const esp_event_base_t IP_EVENT = "IP_EVENT";
+const wifi_prov_scheme_t wifi_prov_scheme_softap = {0};
+
+static const char* TAG = "host_net";
+
+struct esp_netif_obj
+{
+  const char* if_key;
+  char hostname[33];
+  bool dhcpc = true;
+  esp_netif_ip_info_t ip = {};
+  esp_netif_dns_info_t dns = {};
+};
+
+namespace
+{
+  struct handler_entry
+  {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t fn;
+    void* arg;
+  };
+
+  struct event_msg
+  {
+    esp_event_base_t base;
+    int32_t id;
+    size_t size;
+    uint8_t data[HOST_EVENT_DATA];
+  };
+
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  QueueHandle_t s_events = nullptr;
+  std::vector<handler_entry> s_handlers;
+
+  esp_netif_obj s_sta_netif = {"WIFI_STA_DEF", "espressif"};
+  esp_netif_obj s_ap_netif = {"WIFI_AP_DEF", "espressif"};
+  bool s_sta_created = false;
+  bool s_ap_created = false;
+
+  bool s_wifi_init = false;
+  bool s_wifi_started = false;
+  bool s_connected = false;
+  wifi_mode_t s_mode = WIFI_MODE_NULL;
+  wifi_ps_type_t s_ps = WIFI_PS_MIN_MODEM;
+  wifi_config_t s_sta_cfg = {};
+  esp_timer_handle_t s_assoc_timer = nullptr;
+  esp_timer_handle_t s_dhcp_timer = nullptr;
+  const uint8_t k_ap_bssid[6] = {0x02, 0x00, 0x00, 0x5e, 0x00, 0x01};
+  const uint8_t k_ap_channel = 6;
+
+  uint32_t ip4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24); // lwIP order
+  }
+
+  void event_task(void*)
+  {
+    event_msg msg;
+    for (;;)
+    {
+      xQueueReceive(s_events, &msg, portMAX_DELAY);
+      std::vector<handler_entry> matching;
+      {
+        std::lock_guard<std::mutex> lk(s_mu);
+        for (const handler_entry& h : s_handlers)
+        {
+          if (h.base == msg.base && (h.id == ESP_EVENT_ANY_ID || h.id == msg.id))
+            matching.push_back(h);
+        }
+      }
+      for (const handler_entry& h : matching)
+      {
+        h.fn(h.arg, msg.base, msg.id, msg.size ? msg.data : nullptr);
+      }
+    }
+  }
+
+  // Association, then the DHCP lease (or the static address) HOST_WIFI_DHCP_MS later.
+  void assoc_timer_cb(void*)
+  {
+    {
+      std::lock_guard<std::mutex> lk(s_mu);
+      if (!s_wifi_started || s_connected)
+      {
+        return;
+      }
+      s_connected = true;
+    }
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, nullptr, 0, portMAX_DELAY);
+    esp_timer_start_once(s_dhcp_timer, HOST_WIFI_DHCP_MS * 1000ULL);
+  }
+
+  void dhcp_timer_cb(void*)
+  {
+    ip_event_got_ip_t ev = {};
+    {
+      std::lock_guard<std::mutex> lk(s_mu);
+      if (!s_connected)
+      {
+        return;
+      }
+      if (s_sta_netif.dhcpc)
+      {
+        s_sta_netif.ip.ip.addr = ip4(192, 168, 4, 2);
+        s_sta_netif.ip.netmask.addr = ip4(255, 255, 255, 0);
+        s_sta_netif.ip.gw.addr = ip4(192, 168, 4, 1);
+        s_sta_netif.dns.ip.type = ESP_IPADDR_TYPE_V4;
+        s_sta_netif.dns.ip.u_addr.ip4.addr = ip4(192, 168, 4, 1);
+      }
+      ev.esp_netif = &s_sta_netif;
+      ev.ip_info = s_sta_netif.ip;
+    }
+    esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &ev, sizeof(ev), portMAX_DELAY);
+  }
+} // namespace
+
+// ---------- esp_event ----------
+esp_err_t esp_event_loop_create_default(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    if (s_events != nullptr)
+    {
+      return ESP_ERR_INVALID_STATE;
+    }
+    s_events = xQueueCreate(32, sizeof(event_msg));
+  }
+  return (xTaskCreate(event_task, "sys_evt", 2304, nullptr, 20, nullptr) == pdPASS) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void* arg)
+{
+  if (base == nullptr || handler == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_handlers.push_back(handler_entry{base, id, handler, arg});
+  return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void* data, size_t size, TickType_t timeout)
+{
+  if (s_events == nullptr)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (size > HOST_EVENT_DATA)
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  event_msg msg = {base, id, size, {}};
+  if (data != nullptr && size > 0)
+  {
+    memcpy(msg.data, data, size);
+  }
+  return (xQueueSend(s_events, &msg, timeout) == pdPASS) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// ---------- esp_netif ----------
+esp_err_t esp_netif_init(void)
+{
+  return ESP_OK;
+}
+
+esp_netif_t* esp_netif_create_default_wifi_ap(void)
+{
+  s_ap_created = true;
+  return &s_ap_netif;
+}
+
+esp_netif_t* esp_netif_create_default_wifi_sta(void)
+{
+  s_sta_created = true;
+  return &s_sta_netif;
+}
+
+esp_netif_t* esp_netif_get_handle_from_ifkey(const char* if_key)
+{
+  if (if_key != nullptr && s_sta_created && strcmp(if_key, s_sta_netif.if_key) == 0)
+    return &s_sta_netif;
+  if (if_key != nullptr && s_ap_created && strcmp(if_key, s_ap_netif.if_key) == 0)
+    return &s_ap_netif;
+  return nullptr;
+}
+
+esp_err_t esp_netif_set_hostname(esp_netif_t* netif, const char* hostname)
+{
+  if (netif == nullptr || hostname == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  strncpy(netif->hostname, hostname, sizeof(netif->hostname) - 1);
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_get_hostname(esp_netif_t* netif, const char** hostname)
+{
+  if (netif == nullptr || hostname == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *hostname = netif->hostname;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t* netif)
+{
+  if (netif == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  netif->dhcpc = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t* netif)
+{
+  if (netif == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!netif->dhcpc)
+  {
+    return ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED;
+  }
+  netif->dhcpc = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t* netif, const esp_netif_ip_info_t* ip_info)
+{
+  if (netif == nullptr || ip_info == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  netif->ip = *ip_info;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t* netif, esp_netif_ip_info_t* ip_info)
+{
+  if (netif == nullptr || ip_info == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  *ip_info = netif->ip;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_set_dns_info(esp_netif_t* netif, esp_netif_dns_type_t type, esp_netif_dns_info_t* dns)
+{
+  if (netif == nullptr || dns == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (type == ESP_NETIF_DNS_MAIN)
+  {
+    netif->dns = *dns;
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_get_dns_info(esp_netif_t* netif, esp_netif_dns_type_t type, esp_netif_dns_info_t* dns)
+{
+  if (netif == nullptr || dns == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  *dns = (type == ESP_NETIF_DNS_MAIN) ? netif->dns : esp_netif_dns_info_t{};
+  return ESP_OK;
+}
+
+// ---------- esp_wifi ----------
+esp_err_t esp_wifi_init(const wifi_init_config_t*)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_wifi_init)
+  {
+    s_wifi_init = true;
+    strcpy((char*)s_sta_cfg.sta.ssid, "host-sim");
+    strcpy((char*)s_sta_cfg.sta.password, "host-sim-pass");
+    esp_timer_create_args_t args = {};
+    args.callback = assoc_timer_cb;
+    args.name = "host_wifi_assoc";
+    esp_timer_create(&args, &s_assoc_timer);
+    args.callback = dhcp_timer_cb;
+    args.name = "host_wifi_dhcp";
+    esp_timer_create(&args, &s_dhcp_timer);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_mode = mode;
+  return s_wifi_init ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    if (!s_wifi_init)
+    {
+      return ESP_ERR_WIFI_NOT_INIT;
+    }
+    s_wifi_started = true;
+  }
+  ESP_LOGI(TAG, "simulated STA, AP \"host-sim\" on channel %u", (unsigned)k_ap_channel);
+  return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, nullptr, 0, portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_wifi_started)
+  {
+    return ESP_ERR_WIFI_NOT_STARTED;
+  }
+  esp_timer_stop(s_assoc_timer);
+  return esp_timer_start_once(s_assoc_timer, HOST_WIFI_ASSOC_MS * 1000ULL);
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    if (!s_connected)
+    {
+      return ESP_OK;
+    }
+    s_connected = false;
+  }
+  wifi_event_sta_disconnected_t ev = {};
+  ev.reason = 8; // WIFI_REASON_ASSOC_LEAVE
+  return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &ev, sizeof(ev), portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_ps = type;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t* type)
+{
+  if (type == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  *type = s_ps;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t)
+{
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf)
+{
+  if (conf == nullptr || interface != WIFI_IF_STA)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  *conf = s_sta_cfg;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf)
+{
+  if (conf == nullptr || interface != WIFI_IF_STA)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_sta_cfg = *conf;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info)
+{
+  if (ap_info == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_connected)
+  {
+    return ESP_ERR_WIFI_NOT_CONNECT;
+  }
+  *ap_info = wifi_ap_record_t{};
+  memcpy(ap_info->bssid, k_ap_bssid, sizeof(ap_info->bssid));
+  memcpy(ap_info->ssid, s_sta_cfg.sta.ssid, sizeof(s_sta_cfg.sta.ssid));
+  ap_info->primary = k_ap_channel;
+  ap_info->rssi = -52;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6])
+{
+  const uint8_t base[6] = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01};
+  memcpy(mac, base, 6);
+  mac[5] += (ifx == WIFI_IF_AP) ? 1 : 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_protocol(wifi_interface_t, uint8_t* protocol_bitmap)
+{
+  *protocol_bitmap = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t, wifi_bandwidth_t* bw)
+{
+  *bw = WIFI_BW_HT20;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_max_tx_power(int8_t* power)
+{
+  *power = 78; // 0.25 dBm units: 19.5 dBm
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_country(wifi_country_t* country)
+{
+  *country = wifi_country_t{{'0', '1', 0}, 1, 11, 20};
+  return ESP_OK;
+}
+
+// ---------- wifi_provisioning ----------
+esp_err_t wifi_prov_mgr_init(wifi_prov_mgr_config_t)
+{
+  return ESP_OK;
+}
+
+void wifi_prov_mgr_deinit(void)
+{
+}
+
+esp_err_t wifi_prov_mgr_is_provisioned(bool* provisioned)
+{
+  *provisioned = true;
+  return ESP_OK;
+}
+
+esp_err_t wifi_prov_mgr_start_provisioning(wifi_prov_security_t, const void*, const char*, const char*)
+{
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+// ---------- mdns ----------
+esp_err_t mdns_init(void)
+{
+  return ESP_OK;
+}
+
+void mdns_free(void)
+{
+}
+
+esp_err_t mdns_hostname_set(const char* hostname)
+{
+  ESP_LOGI(TAG, "mdns: hostname %s (not announced on the host)", hostname);
+  return ESP_OK;
+}
+
+esp_err_t mdns_instance_name_set(const char*)
+{
+  return ESP_OK;
+}
+
+esp_err_t mdns_service_add(const char*, const char* service_type, const char* proto, uint16_t port, mdns_txt_item_t txt[],
+                           size_t num_items)
+{
+  ESP_LOGI(TAG, "mdns: service %s.%s port %u, %u TXT items", service_type, proto, (unsigned)port, (unsigned)num_items);
+  for (size_t i = 0; i < num_items; ++i)
+  {
+    ESP_LOGD(TAG, "mdns:   %s=%s", txt[i].key, txt[i].value);
+  }
+  return ESP_OK;
+}
+
+esp_err_t mdns_service_txt_item_set(const char* service_type, const char*, const char* key, const char* value)
+{
+  ESP_LOGD(TAG, "mdns: %s %s=%s", service_type, key, value);
+  return ESP_OK;
+}
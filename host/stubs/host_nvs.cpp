@@ -0,0 +1,193 @@
+// nvs / nvs_flash stand-ins: an in-memory store, empty at every start (a freshly erased device).
+// Values keep their type, so reading a key with the wrong getter fails as on the device.
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+namespace
+{
+  enum value_type
+  {
+    TYPE_U8,
+    TYPE_U32,
+    TYPE_BLOB,
+  };
+
+  struct value
+  {
+    value_type type;
+    std::vector<uint8_t> bytes;
+  };
+
+  struct open_handle
+  {
+    std::string ns;
+    nvs_open_mode_t mode;
+  };
+
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  bool s_init = false;
+  std::map<std::string, std::map<std::string, value>> s_store;
+  std::map<nvs_handle_t, open_handle> s_handles;
+  nvs_handle_t s_next_handle = 1;
+
+  esp_err_t set_value(nvs_handle_t handle, const char* key, value_type type, const void* data, size_t len)
+  {
+    if (key == nullptr || (data == nullptr && len > 0))
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lk(s_mu);
+    auto h = s_handles.find(handle);
+    if (h == s_handles.end())
+    {
+      return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->second.mode == NVS_READONLY)
+    {
+      return ESP_ERR_NVS_READ_ONLY;
+    }
+    const uint8_t* bytes = (const uint8_t*)data;
+    s_store[h->second.ns][key] = value{type, std::vector<uint8_t>(bytes, bytes + len)};
+    return ESP_OK;
+  }
+
+  // *len in: buffer size (ignored for fixed-size types), out: stored size. out may be NULL for blobs.
+  esp_err_t get_value(nvs_handle_t handle, const char* key, value_type type, void* out, size_t* len)
+  {
+    if (key == nullptr || len == nullptr)
+    {
+      return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lk(s_mu);
+    auto h = s_handles.find(handle);
+    if (h == s_handles.end())
+    {
+      return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    auto ns = s_store.find(h->second.ns);
+    if (ns == s_store.end())
+    {
+      return ESP_ERR_NVS_NOT_FOUND;
+    }
+    auto it = ns->second.find(key);
+    if (it == ns->second.end() || it->second.type != type)
+    {
+      return ESP_ERR_NVS_NOT_FOUND;
+    }
+    const std::vector<uint8_t>& bytes = it->second.bytes;
+    if (out != nullptr)
+    {
+      if (*len < bytes.size())
+      {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+      }
+      memcpy(out, bytes.data(), bytes.size());
+    }
+    *len = bytes.size();
+    return ESP_OK;
+  }
+} // namespace
+
+esp_err_t nvs_flash_init(void)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_init = true;
+  return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_store.clear();
+  return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name_space, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+  if (name_space == nullptr || out_handle == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_init)
+  {
+    return ESP_ERR_INVALID_STATE; // ESP_ERR_NVS_NOT_INITIALIZED
+  }
+  if (open_mode == NVS_READONLY && s_store.find(name_space) == s_store.end())
+  {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  *out_handle = s_next_handle++;
+  s_handles[*out_handle] = open_handle{name_space, open_mode};
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_handles.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return (s_handles.count(handle) != 0) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key)
+{
+  if (key == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  auto h = s_handles.find(handle);
+  if (h == s_handles.end())
+  {
+    return ESP_ERR_NVS_INVALID_HANDLE;
+  }
+  if (h->second.mode == NVS_READONLY)
+  {
+    return ESP_ERR_NVS_READ_ONLY;
+  }
+  return (s_store[h->second.ns].erase(key) != 0) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+  return set_value(handle, key, TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+  return get_value(handle, key, TYPE_BLOB, out_value, length);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value)
+{
+  return set_value(handle, key, TYPE_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value)
+{
+  size_t len = sizeof(*out_value);
+  return get_value(handle, key, TYPE_U8, out_value, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value)
+{
+  return set_value(handle, key, TYPE_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out_value)
+{
+  size_t len = sizeof(*out_value);
+  return get_value(handle, key, TYPE_U32, out_value, &len);
+}
@@ -0,0 +1,199 @@
+// GPIO input / ISR and ADC one-shot stand-ins. Levels and raw readings come from host_sim.h.
+
+#include <map>
+#include <mutex>
+
+#include "driver/gpio.h"
+#include "esp_adc/adc_oneshot.h"
+#include "esp_sleep.h"
+#include "host_sim.h"
+
+struct adc_oneshot_unit_ctx_t
+{
+  adc_unit_t unit;
+};
+
+namespace
+{
+  struct isr_entry
+  {
+    gpio_isr_t fn;
+    void* arg;
+    gpio_int_type_t type;
+  };
+
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  bool s_isr_service = false;
+  int s_level[GPIO_NUM_MAX] = {};
+  gpio_int_type_t s_intr[GPIO_NUM_MAX] = {};
+  std::map<int, isr_entry> s_isr;
+  std::map<int, int> s_adc_raw;
+
+  bool valid_pin(int pin)
+  {
+    return pin >= 0 && pin < GPIO_NUM_MAX;
+  }
+} // namespace
+
+void host_gpio_set_level(int pin, int level)
+{
+  if (!valid_pin(pin))
+  {
+    return;
+  }
+  isr_entry isr = {};
+  bool fire = false;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    const int prev = s_level[pin];
+    s_level[pin] = level ? 1 : 0;
+    auto it = s_isr.find(pin);
+    if (it != s_isr.end() && prev != s_level[pin])
+    {
+      isr = it->second;
+      const bool rising = s_level[pin] != 0;
+      // A level type fires once on entering the level (the handler is expected to switch it off).
+      fire = isr.type == GPIO_INTR_ANYEDGE || ((isr.type == GPIO_INTR_POSEDGE || isr.type == GPIO_INTR_HIGH_LEVEL) && rising) ||
+             ((isr.type == GPIO_INTR_NEGEDGE || isr.type == GPIO_INTR_LOW_LEVEL) && !rising);
+    }
+  }
+  if (fire)
+  {
+    isr.fn(isr.arg);
+  }
+}
+
+void host_adc_set_raw(int channel, int raw)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_adc_raw[channel] = raw;
+}
+
+esp_err_t gpio_config(const gpio_config_t* cfg)
+{
+  if (cfg == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  for (int pin = 0; pin < GPIO_NUM_MAX; ++pin)
+  {
+    if (cfg->pin_bit_mask & (1ULL << pin))
+    {
+      s_intr[pin] = cfg->intr_type;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (s_isr_service)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  s_isr_service = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg)
+{
+  if (!valid_pin(pin) || handler == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_isr_service)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  s_isr[pin] = isr_entry{handler, arg, s_intr[pin]};
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_isr.erase(pin);
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t intr_type)
+{
+  if (!valid_pin(pin))
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_intr[pin] = intr_type;
+  auto it = s_isr.find(pin);
+  if (it != s_isr.end())
+  {
+    it->second.type = intr_type;
+  }
+  return ESP_OK;
+}
+
+// As on the ESP32, enabling wake-up switches the pin to the given level interrupt type.
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t intr_type)
+{
+  if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return gpio_set_intr_type(pin, intr_type);
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin)
+{
+  return valid_pin(pin) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void)
+{
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+  if (!valid_pin(pin))
+  {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  return s_level[pin];
+}
+
+esp_err_t adc_oneshot_new_unit(const adc_oneshot_unit_init_cfg_t* cfg, adc_oneshot_unit_handle_t* out)
+{
+  if (cfg == nullptr || out == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out = new adc_oneshot_unit_ctx_t{cfg->unit_id};
+  return ESP_OK;
+}
+
+esp_err_t adc_oneshot_config_channel(adc_oneshot_unit_handle_t handle, adc_channel_t, const adc_oneshot_chan_cfg_t* cfg)
+{
+  return (handle != nullptr && cfg != nullptr) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t adc_oneshot_read(adc_oneshot_unit_handle_t handle, adc_channel_t channel, int* out_raw)
+{
+  if (handle == nullptr || out_raw == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  auto it = s_adc_raw.find(channel);
+  *out_raw = (it != s_adc_raw.end()) ? it->second : 0;
+  return ESP_OK;
+}
+
+esp_err_t adc_oneshot_del_unit(adc_oneshot_unit_handle_t handle)
+{
+  delete handle;
+  return ESP_OK;
+}
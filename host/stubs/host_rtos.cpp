@@ -0,0 +1,607 @@
+// FreeRTOS task/notify/queue/critical-section and esp_timer stand-ins on std::thread.
+//
+// Real-time mode: tasks are free-running threads, timers fire from a timer thread.
+// Virtual-time mode: the clock only advances in host_sim_advance_to(); the driver fires due
+// events one timestamp at a time and waits until every task is blocked again before moving on.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_sim.h"
+
+struct host_task
+{
+  std::string name;
+  uint32_t notify = 0;
+  bool blocked = false;
+  int64_t wake_at_us = -1; // virtual time: deadline of the current block, -1 = none
+};
+
+struct host_queue
+{
+  size_t length = 0;
+  size_t item_size = 0; // 0: semaphore, only the count matters
+  std::deque<std::vector<uint8_t>> items;
+  std::vector<host_task*> waiters; // tasks blocked in send or receive
+};
+
+struct esp_timer
+{
+  esp_timer_cb_t cb = nullptr;
+  void* arg = nullptr;
+  uint64_t period_us = 0;
+  int64_t next_us = -1; // -1 = stopped
+};
+
+namespace
+{
+  // Leaked on purpose: detached task threads may still be blocked on them during process exit.
+  std::mutex& s_mu = *new std::mutex;
+  std::condition_variable& s_cv = *new std::condition_variable;
+  std::recursive_mutex& s_critical = *new std::recursive_mutex;
+  bool s_virtual = false;
+  int64_t s_vnow_us = 0;
+  int s_runnable = 0;
+  std::vector<host_task*> s_tasks;
+  std::vector<esp_timer*> s_timers;
+  thread_local host_task* s_self = nullptr;
+  const auto s_t0 = std::chrono::steady_clock::now();
+  bool s_timer_thread_started = false;
+
+  int64_t real_now_us()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_t0).count();
+  }
+
+  int64_t now_locked()
+  {
+    return s_virtual ? s_vnow_us : real_now_us();
+  }
+
+  int64_t ticks_to_us(TickType_t ticks)
+  {
+    return (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+  }
+
+  // Block the calling task until `ready()` or the timeout passes. Returns ready().
+  template <typename Pred>
+  bool block_until(std::unique_lock<std::mutex>& lk, TickType_t timeout, Pred ready)
+  {
+    if (ready())
+    {
+      return true;
+    }
+    if (timeout == 0)
+    {
+      return false;
+    }
+    host_task* self = s_self;
+    const bool forever = (timeout == portMAX_DELAY);
+    const int64_t deadline = forever ? -1 : now_locked() + ticks_to_us(timeout);
+
+    if (s_virtual && self != nullptr)
+    {
+      self->blocked = true;
+      self->wake_at_us = deadline;
+      --s_runnable;
+      s_cv.notify_all();
+      // The waker (notify or clock) clears `blocked` and counts the task runnable again.
+      s_cv.wait(lk, [&] { return !self->blocked; });
+      self->wake_at_us = -1;
+      return ready();
+    }
+
+    if (forever)
+    {
+      s_cv.wait(lk, ready);
+      return true;
+    }
+    const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(deadline - now_locked());
+    return s_cv.wait_until(lk, until, ready);
+  }
+
+  void wake_locked(host_task* t)
+  {
+    if (t->blocked)
+    {
+      t->blocked = false;
+      ++s_runnable;
+    }
+    s_cv.notify_all();
+  }
+
+  // block_until() for a queue: registers the task as a waiter (queue changes wake it) and keeps
+  // waiting after a wake-up that another task beat it to, until ready() or the timeout.
+  template <typename Pred>
+  bool queue_wait(std::unique_lock<std::mutex>& lk, host_queue* q, TickType_t timeout, Pred ready)
+  {
+    const bool forever = (timeout == portMAX_DELAY);
+    const int64_t deadline = forever ? -1 : now_locked() + ticks_to_us(timeout);
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    for (;;)
+    {
+      if (ready())
+      {
+        return true;
+      }
+      const int64_t left = forever ? 0 : deadline - now_locked();
+      if (!forever && left <= 0)
+      {
+        return false;
+      }
+      host_task* self = s_self;
+      if (self != nullptr)
+      {
+        q->waiters.push_back(self);
+      }
+      const bool ok = block_until(lk, forever ? portMAX_DELAY : (TickType_t)((left + tick_us - 1) / tick_us), ready);
+      q->waiters.erase(std::remove(q->waiters.begin(), q->waiters.end(), self), q->waiters.end());
+      if (ok)
+      {
+        return true;
+      }
+    }
+  }
+
+  void queue_changed_locked(host_queue* q)
+  {
+    for (host_task* t : q->waiters)
+    {
+      wake_locked(t);
+    }
+    s_cv.notify_all();
+  }
+
+  void timer_thread()
+  {
+    std::unique_lock<std::mutex> lk(s_mu);
+    for (;;)
+    {
+      int64_t next = -1;
+      for (esp_timer* t : s_timers)
+      {
+        if (t->next_us >= 0 && (next < 0 || t->next_us < next))
+          next = t->next_us;
+      }
+      if (next < 0)
+      {
+        s_cv.wait(lk);
+        continue;
+      }
+      const int64_t now = real_now_us();
+      if (next > now)
+      {
+        s_cv.wait_for(lk, std::chrono::microseconds(next - now));
+        continue;
+      }
+      std::vector<esp_timer*> due;
+      for (esp_timer* t : s_timers)
+      {
+        if (t->next_us >= 0 && t->next_us <= now)
+        {
+          due.push_back(t);
+          // skip_unhandled_events semantics: a late periodic timer fires once, then realigns.
+          t->next_us = t->period_us ? std::max(t->next_us + (int64_t)t->period_us, now) : -1;
+        }
+      }
+      lk.unlock();
+      for (esp_timer* t : due)
+        t->cb(t->arg);
+      lk.lock();
+    }
+  }
+} // namespace
+
+// ---------- host control ----------
+void host_sim_use_virtual_time()
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_virtual = true;
+  s_vnow_us = 0;
+}
+
+bool host_sim_is_virtual_time()
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return s_virtual;
+}
+
+void host_sim_wait_idle()
+{
+  std::unique_lock<std::mutex> lk(s_mu);
+  s_cv.wait(lk, [] { return s_runnable == 0; });
+}
+
+void host_sim_advance_to(int64_t t_us)
+{
+  std::unique_lock<std::mutex> lk(s_mu);
+  for (;;)
+  {
+    s_cv.wait(lk, [] { return s_runnable == 0; });
+
+    int64_t next = -1;
+    for (esp_timer* t : s_timers)
+    {
+      if (t->next_us >= 0 && (next < 0 || t->next_us < next))
+        next = t->next_us;
+    }
+    for (host_task* t : s_tasks)
+    {
+      if (t->blocked && t->wake_at_us >= 0 && (next < 0 || t->wake_at_us < next))
+        next = t->wake_at_us;
+    }
+    if (next < 0 || next > t_us)
+    {
+      break;
+    }
+    s_vnow_us = std::max(s_vnow_us, next);
+
+    for (host_task* t : s_tasks)
+    {
+      if (t->blocked && t->wake_at_us >= 0 && t->wake_at_us <= s_vnow_us)
+        wake_locked(t);
+    }
+    std::vector<esp_timer*> due;
+    for (esp_timer* t : s_timers)
+    {
+      if (t->next_us >= 0 && t->next_us <= s_vnow_us)
+      {
+        due.push_back(t);
+        t->next_us = t->period_us ? t->next_us + (int64_t)t->period_us : -1;
+      }
+    }
+    lk.unlock();
+    for (esp_timer* t : due)
+      t->cb(t->arg);
+    lk.lock();
+  }
+  s_vnow_us = std::max(s_vnow_us, t_us);
+}
+
+// ---------- critical sections ----------
+void host_critical_enter(portMUX_TYPE*)
+{
+  s_critical.lock();
+}
+
+void host_critical_exit(portMUX_TYPE*)
+{
+  s_critical.unlock();
+}
+
+// ---------- tasks ----------
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* arg,
+                                   UBaseType_t prio,
+                                   TaskHandle_t* out,
+                                   BaseType_t core)
+{
+  (void)stack_depth;
+  (void)prio;
+  (void)core;
+  host_task* t = new host_task();
+  t->name = name ? name : "";
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    s_tasks.push_back(t);
+    ++s_runnable;
+  }
+  if (out != nullptr)
+  {
+    *out = t;
+  }
+  std::thread([t, fn, arg] {
+    s_self = t;
+    fn(arg);
+    vTaskDelete(nullptr);
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t prio, TaskHandle_t* out)
+{
+  return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, prio, out, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  if (task != nullptr && task != s_self)
+  {
+    return; // deleting another task is not supported on the host
+  }
+  host_task* self = s_self;
+  if (self != nullptr)
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    s_tasks.erase(std::remove(s_tasks.begin(), s_tasks.end(), self), s_tasks.end());
+    --s_runnable;
+    s_cv.notify_all();
+  }
+  // The thread function returns right after this.
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  std::unique_lock<std::mutex> lk(s_mu);
+  block_until(lk, ticks ? ticks : 1, [] { return false; });
+}
+
+void host_sim_sleep_us(int64_t us)
+{
+  std::unique_lock<std::mutex> lk(s_mu);
+  host_task* self = s_self;
+  if (!s_virtual)
+  {
+    lk.unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    return;
+  }
+  if (self == nullptr)
+  {
+    return; // only tasks wait for the virtual clock
+  }
+  const int64_t deadline = s_vnow_us + us;
+  while (s_vnow_us < deadline) // a notification wakes the task early; its count stays pending
+  {
+    self->blocked = true;
+    self->wake_at_us = deadline;
+    --s_runnable;
+    s_cv.notify_all();
+    s_cv.wait(lk, [&] { return !self->blocked; });
+    self->wake_at_us = -1;
+  }
+}
+
+void vTaskDelayUntil(TickType_t* prev_wake, TickType_t increment)
+{
+  const TickType_t now = xTaskGetTickCount();
+  const TickType_t target = *prev_wake + increment;
+  *prev_wake = target;
+  if ((int32_t)(target - now) > 0)
+  {
+    vTaskDelay(target - now);
+  }
+}
+
+TickType_t xTaskGetTickCount()
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return (TickType_t)(now_locked() / (portTICK_PERIOD_MS * 1000));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return s_self;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  if (task == nullptr)
+  {
+    return pdFAIL;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  ++task->notify;
+  wake_locked(task);
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_prio_woken)
+{
+  xTaskNotifyGive(task);
+  if (higher_prio_woken != nullptr)
+  {
+    *higher_prio_woken = pdFALSE;
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout)
+{
+  host_task* self = s_self;
+  if (self == nullptr)
+  {
+    return 0;
+  }
+  std::unique_lock<std::mutex> lk(s_mu);
+  block_until(lk, timeout, [self] { return self->notify > 0; });
+  const uint32_t value = self->notify;
+  if (value > 0)
+  {
+    self->notify = clear_on_exit ? 0 : value - 1;
+  }
+  return value;
+}
+
+// ---------- queues and semaphores ----------
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  if (length == 0)
+  {
+    return nullptr;
+  }
+  host_queue* q = new host_queue();
+  q->length = length;
+  q->item_size = item_size;
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t timeout)
+{
+  if (q == nullptr)
+  {
+    return pdFAIL;
+  }
+  std::unique_lock<std::mutex> lk(s_mu);
+  if (!queue_wait(lk, q, timeout, [q] { return q->items.size() < q->length; }))
+  {
+    return pdFAIL; // errQUEUE_FULL
+  }
+  q->items.emplace_back(q->item_size);
+  if (item != nullptr && q->item_size > 0)
+  {
+    memcpy(q->items.back().data(), item, q->item_size);
+  }
+  queue_changed_locked(q);
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* higher_prio_woken)
+{
+  if (higher_prio_woken != nullptr)
+  {
+    *higher_prio_woken = pdFALSE;
+  }
+  return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* out, TickType_t timeout)
+{
+  if (q == nullptr)
+  {
+    return pdFAIL;
+  }
+  std::unique_lock<std::mutex> lk(s_mu);
+  if (!queue_wait(lk, q, timeout, [q] { return !q->items.empty(); }))
+  {
+    return pdFAIL;
+  }
+  if (out != nullptr && q->item_size > 0)
+  {
+    memcpy(out, q->items.front().data(), q->item_size);
+  }
+  q->items.pop_front();
+  queue_changed_locked(q);
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return (q != nullptr) ? (UBaseType_t)q->items.size() : 0;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+  delete q;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+  SemaphoreHandle_t m = xQueueCreate(1, 0);
+  xSemaphoreGive(m);
+  return m;
+}
+
+// ---------- esp_timer ----------
+int64_t esp_timer_get_time()
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return now_locked();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out)
+{
+  if (args == nullptr || args->callback == nullptr || out == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_timer* t = new esp_timer();
+  t->cb = args->callback;
+  t->arg = args->arg;
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_timers.push_back(t);
+  if (!s_timer_thread_started)
+  {
+    s_timer_thread_started = true;
+    std::thread([] {
+      // The timer thread only serves real-time mode; in virtual time the driver fires timers.
+      {
+        std::unique_lock<std::mutex> lk2(s_mu);
+        if (s_virtual)
+          return;
+      }
+      timer_thread();
+    }).detach();
+  }
+  *out = t;
+  return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t t, uint64_t first_us, uint64_t period_us)
+{
+  if (t == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  t->period_us = period_us;
+  t->next_us = now_locked() + (int64_t)first_us;
+  s_cv.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+  return timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+  return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+  if (timer == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (timer->next_us < 0)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->next_us = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+  if (timer == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_timers.erase(std::remove(s_timers.begin(), s_timers.end(), timer), s_timers.end());
+  delete timer;
+  return ESP_OK;
+}
+
+void esp_rom_delay_us(uint32_t us)
+{
+  if (host_sim_is_virtual_time())
+  {
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
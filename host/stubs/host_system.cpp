@@ -0,0 +1,500 @@
+// esp_system, app description, partitions/OTA, chip/flash/heap info, esp_random, esp_pm, ROM
+// CRC and cycle counter stand-ins.
+//
+// Partitions follow partitions_16mb_ota.csv and live in RAM (erased = 0xFF, writes can only clear
+// bits, as on NOR flash). The app "runs" from ota_0; host_flash_load_app() puts a real firmware
+// image there, which then also provides the running app description (needed for delta OTA).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+#include <zlib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "esp_app_desc.h"
+#include "esp_app_format.h"
+#include "esp_chip_info.h"
+#include "esp_cpu.h"
+#include "esp_flash.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_pm.h"
+#include "esp_psram.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "host_sim.h"
+
+#ifndef HOST_APP_VERSION
+#define HOST_APP_VERSION "host"
+#endif
+
+#define HOST_SECTOR_SIZE 4096
+
+struct esp_partition_iterator_opaque_
+{
+  size_t index;
+  esp_partition_type_t type;
+  esp_partition_subtype_t subtype;
+  const char* label;
+};
+
+struct esp_pm_lock
+{
+  const char* name;
+  int count;
+};
+
+static const char* TAG = "host_system";
+
+namespace
+{
+  const esp_partition_t k_parts[] = {
+      {ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x9000, 0x6000, HOST_SECTOR_SIZE, "nvs", false},
+      {ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_PHY, 0xF000, 0x1000, HOST_SECTOR_SIZE, "phy_init", false},
+      {ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_OTA, 0x10000, 0x2000, HOST_SECTOR_SIZE, "ota_data", false},
+      {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x20000, 0x400000, HOST_SECTOR_SIZE, "ota_0", false},
+      {ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x420000, 0x400000, HOST_SECTOR_SIZE, "ota_1", false},
+  };
+  const size_t k_part_count = sizeof(k_parts) / sizeof(k_parts[0]);
+  const esp_partition_t* const k_running = &k_parts[3];
+
+  struct ota_session
+  {
+    const esp_partition_t* part;
+    size_t written;
+  };
+
+  std::mutex& s_mu = *new std::mutex; // outlives detached task threads
+  std::map<const esp_partition_t*, std::vector<uint8_t>> s_flash;
+  std::map<esp_ota_handle_t, ota_session> s_ota;
+  esp_ota_handle_t s_next_ota = 1;
+  const esp_partition_t* s_boot = k_running;
+  esp_app_desc_t s_app_desc = {};
+  bool s_app_desc_ready = false;
+
+  // Partition contents, erased (0xFF) on first use.
+  std::vector<uint8_t>& contents_locked(const esp_partition_t* p)
+  {
+    std::vector<uint8_t>& c = s_flash[p];
+    if (c.empty())
+    {
+      c.assign(p->size, 0xFF);
+    }
+    return c;
+  }
+
+  bool known(const esp_partition_t* p)
+  {
+    return p >= &k_parts[0] && p < &k_parts[k_part_count];
+  }
+
+  bool matches(const esp_partition_t& p, const esp_partition_iterator_opaque_& it)
+  {
+    return (it.type == ESP_PARTITION_TYPE_ANY || p.type == it.type) &&
+           (it.subtype == ESP_PARTITION_SUBTYPE_ANY || p.subtype == it.subtype) && (it.label == nullptr || strcmp(p.label, it.label) == 0);
+  }
+
+  esp_partition_iterator_t find_from(size_t index, const esp_partition_iterator_opaque_& filter)
+  {
+    for (; index < k_part_count; ++index)
+    {
+      if (matches(k_parts[index], filter))
+      {
+        esp_partition_iterator_t it = new esp_partition_iterator_opaque_(filter);
+        it->index = index;
+        return it;
+      }
+    }
+    return nullptr;
+  }
+
+  void fill_builtin_desc(esp_app_desc_t* d)
+  {
+    *d = esp_app_desc_t{};
+    d->magic_word = ESP_APP_DESC_MAGIC_WORD;
+    snprintf(d->version, sizeof(d->version), "%s", HOST_APP_VERSION);
+    snprintf(d->project_name, sizeof(d->project_name), "BILLY_AMBIENT");
+    snprintf(d->time, sizeof(d->time), "%s", __TIME__);
+    snprintf(d->date, sizeof(d->date), "%s", __DATE__);
+    snprintf(d->idf_ver, sizeof(d->idf_ver), "%s", esp_get_idf_version());
+  }
+} // namespace
+
+// ---------- host control ----------
+bool host_flash_load_app(const char* path)
+{
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  std::vector<uint8_t>& c = contents_locked(k_running);
+  std::fill(c.begin(), c.end(), 0xFF);
+  const size_t n = fread(c.data(), 1, c.size(), f);
+  const bool whole = feof(f) || fgetc(f) == EOF;
+  fclose(f);
+  const size_t desc_offset = sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
+  esp_app_desc_t desc;
+  if (!whole || n < desc_offset + sizeof(desc) || c[0] != ESP_IMAGE_HEADER_MAGIC)
+  {
+    return false;
+  }
+  memcpy(&desc, c.data() + desc_offset, sizeof(desc));
+  if (desc.magic_word != ESP_APP_DESC_MAGIC_WORD)
+  {
+    return false;
+  }
+  s_app_desc = desc;
+  s_app_desc_ready = true;
+  return true;
+}
+
+// ---------- esp_system ----------
+void esp_restart(void)
+{
+  ESP_LOGI(TAG, "esp_restart: exiting (next boot from %s)", s_boot->label);
+  fflush(stdout);
+  fflush(stderr);
+  std::_Exit(0); // task threads are detached; skip static destructors they may still use
+}
+
+esp_reset_reason_t esp_reset_reason(void)
+{
+  return ESP_RST_POWERON;
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+  return 180 * 1024;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+  return 160 * 1024;
+}
+
+const char* esp_get_idf_version(void)
+{
+  return "host";
+}
+
+const esp_app_desc_t* esp_app_get_description(void)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (!s_app_desc_ready)
+  {
+    fill_builtin_desc(&s_app_desc);
+    s_app_desc_ready = true;
+  }
+  return &s_app_desc;
+}
+
+void esp_chip_info(esp_chip_info_t* out_info)
+{
+  out_info->model = CHIP_ESP32;
+  out_info->features = CHIP_FEATURE_WIFI_BGN | CHIP_FEATURE_BT | CHIP_FEATURE_BLE;
+  out_info->revision = 301;
+  out_info->cores = 2;
+}
+
+esp_err_t esp_flash_get_size(esp_flash_t*, uint32_t* out_size)
+{
+  *out_size = 16 * 1024 * 1024;
+  return ESP_OK;
+}
+
+esp_err_t esp_flash_read_id(esp_flash_t*, uint32_t* out_id)
+{
+  *out_id = 0xEF4018; // W25Q128
+  return ESP_OK;
+}
+
+size_t heap_caps_get_total_size(uint32_t caps)
+{
+  return (caps & MALLOC_CAP_SPIRAM) ? 0 : 300 * 1024;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+  return (caps & MALLOC_CAP_SPIRAM) ? 0 : esp_get_free_heap_size();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+  return (caps & MALLOC_CAP_SPIRAM) ? 0 : 110 * 1024;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+  return (caps & MALLOC_CAP_SPIRAM) ? 0 : esp_get_minimum_free_heap_size();
+}
+
+bool esp_psram_is_initialized(void)
+{
+  return false;
+}
+
+size_t esp_psram_get_size(void)
+{
+  return 0;
+}
+
+uint32_t esp_random(void)
+{
+  static std::mutex mu;
+  static std::mt19937 gen(std::random_device{}());
+  std::lock_guard<std::mutex> lk(mu);
+  return gen();
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return (esp_cpu_cycle_count_t)__rdtsc();
+#else
+  return (esp_cpu_cycle_count_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len)
+{
+  return (uint32_t)crc32(crc, buf, len);
+}
+
+// ---------- esp_pm ----------
+esp_err_t esp_pm_configure(const void* config)
+{
+  return (config != nullptr) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t, int, const char* name, esp_pm_lock_handle_t* out_handle)
+{
+  if (out_handle == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out_handle = new esp_pm_lock{name, 0};
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
+{
+  if (handle == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  ++handle->count;
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle)
+{
+  if (handle == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  if (handle->count == 0)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  --handle->count;
+  return ESP_OK;
+}
+
+// ---------- esp_partition ----------
+esp_partition_iterator_t esp_partition_find(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label)
+{
+  return find_from(0, esp_partition_iterator_opaque_{0, type, subtype, label});
+}
+
+const esp_partition_t* esp_partition_get(esp_partition_iterator_t iterator)
+{
+  return (iterator != nullptr) ? &k_parts[iterator->index] : nullptr;
+}
+
+esp_partition_iterator_t esp_partition_next(esp_partition_iterator_t iterator)
+{
+  if (iterator == nullptr)
+  {
+    return nullptr;
+  }
+  esp_partition_iterator_t next = find_from(iterator->index + 1, *iterator);
+  delete iterator;
+  return next;
+}
+
+void esp_partition_iterator_release(esp_partition_iterator_t iterator)
+{
+  delete iterator;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size)
+{
+  if (!known(partition) || dst == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (src_offset > partition->size || size > partition->size - src_offset)
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  memcpy(dst, contents_locked(partition).data() + src_offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size)
+{
+  if (!known(partition) || src == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (dst_offset > partition->size || size > partition->size - dst_offset)
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  uint8_t* dst = contents_locked(partition).data() + dst_offset;
+  const uint8_t* bytes = (const uint8_t*)src;
+  for (size_t i = 0; i < size; ++i)
+  {
+    dst[i] &= bytes[i]; // NOR flash: a write without an erase can only clear bits
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size)
+{
+  if (!known(partition))
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (offset > partition->size || size > partition->size - offset)
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (offset % HOST_SECTOR_SIZE != 0 || size % HOST_SECTOR_SIZE != 0)
+  {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  memset(contents_locked(partition).data() + offset, 0xFF, size);
+  return ESP_OK;
+}
+
+// ---------- esp_ota_ops ----------
+const esp_partition_t* esp_ota_get_running_partition(void)
+{
+  return k_running;
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from)
+{
+  const esp_partition_t* from = (start_from != nullptr) ? start_from : k_running;
+  return (from == &k_parts[3]) ? &k_parts[4] : &k_parts[3];
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t* partition, size_t image_size, esp_ota_handle_t* out_handle)
+{
+  if (!known(partition) || partition->type != ESP_PARTITION_TYPE_APP || out_handle == nullptr)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (partition == k_running)
+  {
+    return ESP_ERR_INVALID_STATE; // ESP_ERR_OTA_PARTITION_CONFLICT
+  }
+  if (image_size != OTA_WITH_SEQUENTIAL_WRITES)
+  {
+    const size_t size = (image_size == OTA_SIZE_UNKNOWN) ? partition->size : image_size;
+    if (size > partition->size)
+    {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    const esp_err_t err =
+        esp_partition_erase_range(partition, 0, (size + HOST_SECTOR_SIZE - 1) / HOST_SECTOR_SIZE * HOST_SECTOR_SIZE);
+    if (err != ESP_OK)
+    {
+      return err;
+    }
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  *out_handle = s_next_ota++;
+  s_ota[*out_handle] = ota_session{partition, 0};
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size)
+{
+  const esp_partition_t* part = nullptr;
+  size_t offset = 0;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    auto it = s_ota.find(handle);
+    if (it == s_ota.end())
+    {
+      return ESP_ERR_INVALID_ARG; // ESP_ERR_OTA_HANDLE_INVALID
+    }
+    if (it->second.written == 0 && size > 0 && ((const uint8_t*)data)[0] != ESP_IMAGE_HEADER_MAGIC)
+    {
+      return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    part = it->second.part;
+    offset = it->second.written;
+    it->second.written += size;
+  }
+  return esp_partition_write(part, offset, data, size);
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+  ota_session session;
+  {
+    std::lock_guard<std::mutex> lk(s_mu);
+    auto it = s_ota.find(handle);
+    if (it == s_ota.end())
+    {
+      return ESP_ERR_NOT_FOUND;
+    }
+    session = it->second;
+    s_ota.erase(it);
+  }
+  esp_image_header_t hdr;
+  if (session.written < sizeof(hdr) || esp_partition_read(session.part, 0, &hdr, sizeof(hdr)) != ESP_OK ||
+      hdr.magic != ESP_IMAGE_HEADER_MAGIC)
+  {
+    return ESP_ERR_OTA_VALIDATE_FAILED;
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+  std::lock_guard<std::mutex> lk(s_mu);
+  return (s_ota.erase(handle) != 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition)
+{
+  if (!known(partition) || partition->type != ESP_PARTITION_TYPE_APP)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lk(s_mu);
+  s_boot = partition;
+  return ESP_OK;
+}
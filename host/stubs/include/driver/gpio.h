@@ -0,0 +1,92 @@
+#pragma once
+/* Host stand-in for ESP-IDF driver/gpio.h. Input levels are set by the host (host_sim.h); edges
+ * call the registered ISR handlers synchronously. */
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_2 = 2,
+  GPIO_NUM_4 = 4,
+  GPIO_NUM_5 = 5,
+  GPIO_NUM_12 = 12,
+  GPIO_NUM_13 = 13,
+  GPIO_NUM_14 = 14,
+  GPIO_NUM_15 = 15,
+  GPIO_NUM_16 = 16,
+  GPIO_NUM_17 = 17,
+  GPIO_NUM_18 = 18,
+  GPIO_NUM_19 = 19,
+  GPIO_NUM_21 = 21,
+  GPIO_NUM_22 = 22,
+  GPIO_NUM_23 = 23,
+  GPIO_NUM_25 = 25,
+  GPIO_NUM_26 = 26,
+  GPIO_NUM_27 = 27,
+  GPIO_NUM_32 = 32,
+  GPIO_NUM_33 = 33,
+  GPIO_NUM_34 = 34,
+  GPIO_NUM_35 = 35,
+  GPIO_NUM_MAX = 40,
+} gpio_num_t;
+
+typedef enum
+{
+  GPIO_MODE_DISABLE = 0,
+  GPIO_MODE_INPUT = 1,
+  GPIO_MODE_OUTPUT = 2,
+} gpio_mode_t;
+
+typedef enum
+{
+  GPIO_PULLUP_DISABLE = 0,
+  GPIO_PULLUP_ENABLE = 1,
+} gpio_pullup_t;
+
+typedef enum
+{
+  GPIO_PULLDOWN_DISABLE = 0,
+  GPIO_PULLDOWN_ENABLE = 1,
+} gpio_pulldown_t;
+
+typedef enum
+{
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE = 1,
+  GPIO_INTR_NEGEDGE = 2,
+  GPIO_INTR_ANYEDGE = 3,
+  GPIO_INTR_LOW_LEVEL = 4,
+  GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+typedef struct
+{
+  uint64_t pin_bit_mask;
+  gpio_mode_t mode;
+  gpio_pullup_t pull_up_en;
+  gpio_pulldown_t pull_down_en;
+  gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)(void* arg);
+
+esp_err_t gpio_config(const gpio_config_t* cfg);
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t handler, void* arg);
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin);
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t intr_type);
+esp_err_t gpio_wakeup_disable(gpio_num_t pin);
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t intr_type);
+int gpio_get_level(gpio_num_t pin);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_attr.h: placement attributes have no meaning on the host. */
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define NOINLINE_ATTR __attribute__((noinline))
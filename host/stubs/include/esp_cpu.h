@@ -0,0 +1,23 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_cpu.h: the cycle counter is the x86 TSC (low 32 bits, like the
+ * Xtensa CCOUNT register it replaces) or, on other hosts, nanoseconds. Both are shared by all
+ * cores, so every thread reports core 0. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+static inline int esp_cpu_get_core_id(void)
+{
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
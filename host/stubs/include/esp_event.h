@@ -0,0 +1,29 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_event.h: the default loop only. Events are queued and the handlers
+ * run on the loop's own task, as on the device. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef const char* esp_event_base_t;
+typedef void (*esp_event_handler_t)(void* arg, esp_event_base_t base, int32_t id, void* data);
+
+#define ESP_EVENT_ANY_ID -1
+
+extern const esp_event_base_t WIFI_EVENT;
+extern const esp_event_base_t IP_EVENT;
+
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void* arg);
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void* data, size_t size, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
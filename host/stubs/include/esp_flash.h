@@ -0,0 +1,19 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_flash.h: a 16 MB part (partitions_16mb_ota.csv) with a fixed JEDEC id. */
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_flash_t esp_flash_t;
+
+esp_err_t esp_flash_get_size(esp_flash_t* chip, uint32_t* out_size);
+esp_err_t esp_flash_read_id(esp_flash_t* chip, uint32_t* out_id);
+
+#ifdef __cplusplus
+}
+#endif
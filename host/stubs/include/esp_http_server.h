@@ -0,0 +1,107 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_http_server.h on POSIX sockets (host/stubs/host_httpd.cpp). As on
+ * the device, one server task serves every open socket in turn, so a slow handler blocks the
+ * others; handlers, query/header helpers and response calls behave like the IDF ones. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_HTTPD_BASE           0xb000
+#define ESP_ERR_HTTPD_HANDLERS_FULL  (ESP_ERR_HTTPD_BASE + 1)
+#define ESP_ERR_HTTPD_HANDLER_EXISTS (ESP_ERR_HTTPD_BASE + 2)
+#define ESP_ERR_HTTPD_INVALID_REQ    (ESP_ERR_HTTPD_BASE + 3)
+#define ESP_ERR_HTTPD_RESULT_TRUNC   (ESP_ERR_HTTPD_BASE + 4)
+#define ESP_ERR_HTTPD_RESP_HDR       (ESP_ERR_HTTPD_BASE + 5)
+#define ESP_ERR_HTTPD_RESP_SEND      (ESP_ERR_HTTPD_BASE + 6)
+#define ESP_ERR_HTTPD_TASK           (ESP_ERR_HTTPD_BASE + 8)
+
+#define HTTPD_RESP_USE_STRLEN -1
+#define HTTPD_SOCK_ERR_FAIL    -1
+#define HTTPD_SOCK_ERR_INVALID -2
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+#define HTTPD_MAX_URI_LEN      512
+
+typedef void* httpd_handle_t;
+
+typedef enum
+{
+  HTTP_DELETE = 0,
+  HTTP_GET = 1,
+  HTTP_HEAD = 2,
+  HTTP_POST = 3,
+  HTTP_PUT = 4,
+} httpd_method_t;
+
+typedef bool (*httpd_uri_match_func_t)(const char* reference_uri, const char* uri_to_match, size_t match_upto);
+
+typedef struct
+{
+  unsigned task_priority;
+  size_t stack_size;
+  int core_id;
+  uint16_t server_port;
+  uint16_t ctrl_port;
+  uint16_t max_open_sockets;
+  uint16_t max_uri_handlers;
+  uint16_t max_resp_headers;
+  uint16_t backlog_conn;
+  bool lru_purge_enable;
+  uint16_t recv_wait_timeout; /* seconds */
+  uint16_t send_wait_timeout; /* seconds */
+  httpd_uri_match_func_t uri_match_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG()                                                                                                             \
+  {                                                                                                                                        \
+    .task_priority = 5, .stack_size = 4096, .core_id = 0x7FFFFFFF, .server_port = 80, .ctrl_port = 32768, .max_open_sockets = 7,           \
+    .max_uri_handlers = 8, .max_resp_headers = 8, .backlog_conn = 5, .lru_purge_enable = false, .recv_wait_timeout = 5,                  \
+    .send_wait_timeout = 5, .uri_match_fn = NULL,                                                                                          \
+  }
+
+typedef struct httpd_req
+{
+  httpd_handle_t handle;
+  int method;
+  const char uri[HTTPD_MAX_URI_LEN + 1];
+  size_t content_len;
+  void* aux; /* host request state */
+  void* user_ctx;
+  void* sess_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri
+{
+  const char* uri;
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t* r);
+  void* user_ctx;
+} httpd_uri_t;
+
+esp_err_t httpd_start(httpd_handle_t* handle, const httpd_config_t* config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t* uri_handler);
+bool httpd_uri_match_wildcard(const char* uri_template, const char* uri_to_match, size_t match_upto);
+
+int httpd_req_recv(httpd_req_t* r, char* buf, size_t buf_len);
+size_t httpd_req_get_hdr_value_len(httpd_req_t* r, const char* field);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t* r, const char* field, char* val, size_t val_size);
+size_t httpd_req_get_url_query_len(httpd_req_t* r);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t* r, char* buf, size_t buf_len);
+esp_err_t httpd_query_key_value(const char* qry, const char* key, char* val, size_t val_size);
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status);
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value);
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t buf_len);
+
+#ifdef __cplusplus
+}
+#endif
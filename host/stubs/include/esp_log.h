@@ -0,0 +1,39 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_log.h: same macros, printed to stderr. */
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+  ESP_LOG_NONE,
+  ESP_LOG_ERROR,
+  ESP_LOG_WARN,
+  ESP_LOG_INFO,
+  ESP_LOG_DEBUG,
+  ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+typedef int (*vprintf_like_t)(const char*, va_list);
+
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+uint32_t esp_log_timestamp(void);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define ESP_LOG_LEVEL_(level, letter, tag, format, ...)                                                                                  \
+  esp_log_write(level, tag, letter " (%u) %s: " format "\n", (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_LOG_LEVEL_(ESP_LOG_DEBUG, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_LOG_LEVEL_(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
@@ -0,0 +1,87 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_netif.h. The STA interface reports a fixed simulated lease
+ * (192.168.4.2/24); see host/stubs/host_net.cpp. */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct
+{
+  uint32_t addr; /* network byte order */
+} esp_ip4_addr_t;
+
+typedef struct
+{
+  esp_ip4_addr_t ip;
+  esp_ip4_addr_t netmask;
+  esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+#define ESP_IPADDR_TYPE_V4 0
+
+typedef struct
+{
+  union
+  {
+    esp_ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} esp_ip_addr_t;
+
+typedef struct
+{
+  esp_ip_addr_t ip;
+} esp_netif_dns_info_t;
+
+typedef enum
+{
+  ESP_NETIF_DNS_MAIN,
+  ESP_NETIF_DNS_BACKUP,
+  ESP_NETIF_DNS_FALLBACK,
+} esp_netif_dns_type_t;
+
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED 0x5004
+
+typedef struct
+{
+  esp_netif_t* esp_netif;
+  esp_netif_ip_info_t ip_info;
+  bool ip_changed;
+} ip_event_got_ip_t;
+
+typedef enum
+{
+  IP_EVENT_STA_GOT_IP,
+  IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+#define IPSTR "%d.%d.%d.%d"
+#define esp_ip4_addr_get_byte(ipaddr, idx) (((const uint8_t*)(&(ipaddr)->addr))[idx])
+#define IP2STR(ipaddr)                                                                                                                     \
+  esp_ip4_addr_get_byte(ipaddr, 0), esp_ip4_addr_get_byte(ipaddr, 1), esp_ip4_addr_get_byte(ipaddr, 2), esp_ip4_addr_get_byte(ipaddr, 3)
+
+esp_err_t esp_netif_init(void);
+esp_netif_t* esp_netif_create_default_wifi_ap(void);
+esp_netif_t* esp_netif_create_default_wifi_sta(void);
+esp_netif_t* esp_netif_get_handle_from_ifkey(const char* if_key);
+esp_err_t esp_netif_set_hostname(esp_netif_t* netif, const char* hostname);
+esp_err_t esp_netif_get_hostname(esp_netif_t* netif, const char** hostname);
+esp_err_t esp_netif_dhcpc_start(esp_netif_t* netif);
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t* netif);
+esp_err_t esp_netif_set_ip_info(esp_netif_t* netif, const esp_netif_ip_info_t* ip_info);
+esp_err_t esp_netif_get_ip_info(esp_netif_t* netif, esp_netif_ip_info_t* ip_info);
+esp_err_t esp_netif_set_dns_info(esp_netif_t* netif, esp_netif_dns_type_t type, esp_netif_dns_info_t* dns);
+esp_err_t esp_netif_get_dns_info(esp_netif_t* netif, esp_netif_dns_type_t type, esp_netif_dns_info_t* dns);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_psram.h: no PSRAM. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool esp_psram_is_initialized(void);
+size_t esp_psram_get_size(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_random.h. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_rom_crc.h (zlib's CRC-32, the same polynomial and convention). */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_rom_sys.h. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void esp_rom_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_sleep.h: wake sources are accepted, the host never sleeps. */
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void);
+
+#ifdef __cplusplus
+}
+#endif
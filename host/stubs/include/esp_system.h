@@ -0,0 +1,36 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_system.h. esp_restart() ends the process (exit status 0), so a
+ * supervisor or shell loop can start the next "boot". */
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+void esp_restart(void) __attribute__((noreturn));
+esp_reset_reason_t esp_reset_reason(void);
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+const char* esp_get_idf_version(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,139 @@
+#pragma once
+/* Host stand-in for ESP-IDF esp_wifi.h. There is no radio: esp_wifi_connect() "associates" with a
+ * simulated AP and posts the usual STA events (see host/stubs/host_net.cpp). */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+  WIFI_IF_STA,
+  WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum
+{
+  WIFI_MODE_NULL,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef enum
+{
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM,
+} wifi_ps_type_t;
+
+typedef enum
+{
+  WIFI_STORAGE_FLASH,
+  WIFI_STORAGE_RAM,
+} wifi_storage_t;
+
+typedef enum
+{
+  WIFI_FAST_SCAN,
+  WIFI_ALL_CHANNEL_SCAN,
+} wifi_scan_method_t;
+
+typedef enum
+{
+  WIFI_BW_HT20 = 1,
+  WIFI_BW_HT40,
+} wifi_bandwidth_t;
+
+#define ESP_ERR_WIFI_BASE        0x3000
+#define ESP_ERR_WIFI_NOT_INIT    (ESP_ERR_WIFI_BASE + 1)
+#define ESP_ERR_WIFI_NOT_STARTED (ESP_ERR_WIFI_BASE + 2)
+#define ESP_ERR_WIFI_NOT_CONNECT (ESP_ERR_WIFI_BASE + 15)
+
+#define WIFI_PROTOCOL_11B 0x1
+#define WIFI_PROTOCOL_11G 0x2
+#define WIFI_PROTOCOL_11N 0x4
+#define WIFI_PROTOCOL_LR  0x8
+
+typedef struct
+{
+  uint8_t ssid[32];
+  uint8_t password[64];
+  wifi_scan_method_t scan_method;
+  bool bssid_set;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint16_t listen_interval;
+} wifi_sta_config_t;
+
+typedef union
+{
+  wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct
+{
+  uint8_t bssid[6];
+  uint8_t ssid[33];
+  uint8_t primary;
+  int8_t rssi;
+} wifi_ap_record_t;
+
+typedef struct
+{
+  char cc[3];
+  uint8_t schan;
+  uint8_t nchan;
+  int8_t max_tx_power;
+} wifi_country_t;
+
+typedef struct
+{
+  uint8_t ssid[32];
+  uint8_t ssid_len;
+  uint8_t bssid[6];
+  uint8_t reason;
+  int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+typedef struct
+{
+  int unused;
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT() {0}
+
+typedef enum
+{
+  WIFI_EVENT_STA_START = 2,
+  WIFI_EVENT_STA_STOP,
+  WIFI_EVENT_STA_CONNECTED,
+  WIFI_EVENT_STA_DISCONNECTED,
+} wifi_event_t;
+
+esp_err_t esp_wifi_init(const wifi_init_config_t* config);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t* type);
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t* ap_info);
+esp_err_t esp_wifi_get_mac(wifi_interface_t ifx, uint8_t mac[6]);
+esp_err_t esp_wifi_get_protocol(wifi_interface_t ifx, uint8_t* protocol_bitmap);
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t ifx, wifi_bandwidth_t* bw);
+esp_err_t esp_wifi_get_max_tx_power(int8_t* power);
+esp_err_t esp_wifi_get_country(wifi_country_t* country);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+/* Host stand-in for FreeRTOS.h: tasks are threads, see host/stubs/host_rtos.cpp. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdPASS              1
+#define pdFAIL              0
+#define configTICK_RATE_HZ  100
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define tskNO_AFFINITY      0x7FFFFFFF
+#define configMAX_PRIORITIES 25
+
+/* Critical sections map to one process-wide recursive lock. */
+typedef struct
+{
+  int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void host_critical_enter(portMUX_TYPE* mux);
+void host_critical_exit(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)     host_critical_enter(mux)
+#define portEXIT_CRITICAL(mux)      host_critical_exit(mux)
+#define portENTER_CRITICAL_ISR(mux) host_critical_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)  host_critical_exit(mux)
+#define portYIELD_FROM_ISR(x)       (void)(x)
+#define xPortInIsrContext()         0 // simulated ISRs run on their own threads, never inside a task
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+/* Host stand-in for FreeRTOS queue.h: fixed-size item copies, blocking with the task timeouts of
+ * host/stubs/host_rtos.cpp. */
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_queue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t timeout);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_prio_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* out, TickType_t timeout);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+/* Host stand-in for FreeRTOS semphr.h. As in FreeRTOS, a semaphore is a queue of zero-size items;
+ * a mutex starts given and has no priority inheritance. */
+
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+#define xSemaphoreTake(sem, timeout) xQueueReceive((sem), NULL, (timeout))
+#define xSemaphoreGive(sem)          xQueueSend((sem), NULL, 0)
+#define vSemaphoreDelete(sem)        vQueueDelete(sem)
+
+#ifdef __cplusplus
+}
+#endif
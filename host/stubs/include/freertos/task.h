@@ -0,0 +1,33 @@
+#pragma once
+/* Host stand-in for FreeRTOS task.h. */
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* arg,
+                                   UBaseType_t prio,
+                                   TaskHandle_t* out,
+                                   BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t prio, TaskHandle_t* out);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* prev_wake, TickType_t increment);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_prio_woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+/* Host-only controls for the ESP-IDF stand-ins: clock, sensor inputs, the LED frame recorder and
+ * the whole-firmware host build (fw_host).
+ * Not an ESP-IDF header; only host tools include it. */
+
+#include <stdint.h>
+#include <vector>
+
+/* Clock. Real time by default. In virtual time the clock only moves inside host_sim_advance_to(),
+ * which fires due esp_timers and task wake-ups in order and lets every task run until it blocks
+ * again, so runs are deterministic and independent of host speed. */
+void host_sim_use_virtual_time();
+bool host_sim_is_virtual_time();
+void host_sim_advance_to(int64_t t_us);
+void host_sim_wait_idle();
+/* Block the calling task for us microseconds of the clock (stand-ins that model hardware time). */
+void host_sim_sleep_us(int64_t us);
+
+/* Inputs. A level change on a pin with an ISR handler runs the handler on the calling thread. */
+void host_gpio_set_level(int pin, int level);
+void host_adc_set_raw(int channel, int raw);
+
+/* Every led_strip_refresh()/refresh_async() appends one frame (packed RGB, strip order). */
+struct host_led_frame
+{
+  int64_t t_us;
+  int gpio;
+  std::vector<uint8_t> rgb;
+};
+
+std::vector<host_led_frame> host_led_take_frames();
+void host_led_set_recording(bool on);
+
+/* HTTP server port in place of the one the firmware configures (80 needs privileges); 0 = as configured. */
+void host_httpd_set_port(int port);
+
+/* Load a firmware image (.bin) into the running app partition; its app description then becomes
+ * the running one, so delta OTA against it works. false if the file is missing or not an app image. */
+bool host_flash_load_app(const char* path);
@@ -0,0 +1,34 @@
+#pragma once
+/* Host stand-in for the espressif/led_strip SPI backend. */
+
+#include "led_strip.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int spi_clock_source_t;
+#define SPI_CLK_SRC_DEFAULT 0
+
+typedef enum
+{
+  SPI1_HOST = 0,
+  SPI2_HOST = 1,
+  SPI3_HOST = 2,
+} spi_host_device_t;
+
+typedef struct
+{
+  spi_clock_source_t clk_src;
+  spi_host_device_t spi_bus;
+  struct
+  {
+    uint32_t with_dma : 1;
+  } flags;
+} led_strip_spi_config_t;
+
+esp_err_t led_strip_new_spi_device(const led_strip_config_t* led_config, const led_strip_spi_config_t* spi_config, led_strip_handle_t* ret_strip);
+
+#ifdef __cplusplus
+}
+#endif
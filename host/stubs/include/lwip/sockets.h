@@ -0,0 +1,10 @@
+#pragma once
+/* Host stand-in: lwIP's BSD socket API maps onto the POSIX one. */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
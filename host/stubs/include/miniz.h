@@ -0,0 +1,71 @@
+#pragma once
+/* Host stand-in for the ROM miniz inflater (tinfl) on zlib. Raw deflate streams only (no
+ * TINFL_FLAG_PARSE_ZLIB_HEADER), which is all ota_inflate.cpp feeds it. zlib keeps its own 32 KB
+ * history, so the wrapping output window of the caller works unchanged. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TINFL_LZ_DICT_SIZE        32768
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+
+typedef enum
+{
+  TINFL_STATUS_BAD_PARAM = -3,
+  TINFL_STATUS_ADLER32_MISMATCH = -2,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct
+{
+  z_stream z;
+  int started;
+} tinfl_decompressor;
+
+static inline void tinfl_init(tinfl_decompressor* d)
+{
+  memset(d, 0, sizeof(*d));
+}
+
+/* The zlib state is released when the stream ends or fails; an abandoned stream leaks it. */
+static inline tinfl_status tinfl_decompress(tinfl_decompressor* d, const uint8_t* in, size_t* in_size, uint8_t* out_start,
+                                            uint8_t* out_next, size_t* out_size, uint32_t flags)
+{
+  (void)out_start;
+  (void)flags;
+  if (!d->started)
+  {
+    if (inflateInit2(&d->z, -15) != Z_OK)
+    {
+      return TINFL_STATUS_FAILED;
+    }
+    d->started = 1;
+  }
+  d->z.next_in = (Bytef*)in;
+  d->z.avail_in = (uInt)*in_size;
+  d->z.next_out = out_next;
+  d->z.avail_out = (uInt)*out_size;
+  const int r = inflate(&d->z, Z_NO_FLUSH);
+  *in_size -= d->z.avail_in;
+  *out_size -= d->z.avail_out;
+  if (r == Z_STREAM_END || (r != Z_OK && r != Z_BUF_ERROR))
+  {
+    inflateEnd(&d->z);
+    d->started = 0;
+    return (r == Z_STREAM_END) ? TINFL_STATUS_DONE : TINFL_STATUS_FAILED;
+  }
+  return (d->z.avail_out == 0) ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+/* Host stand-in for ESP-IDF nvs_flash.h. */
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_NVS_NO_FREE_PAGES     0x110d
+#define ESP_ERR_NVS_NEW_VERSION_FOUND 0x1110
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
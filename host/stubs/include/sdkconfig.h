@@ -0,0 +1,9 @@
+#pragma once
+/* Host stand-in for the generated sdkconfig.h: the options the firmware reads, as set in the
+ * project's sdkconfig for the ESP32. Power management stays off on the host. */
+
+#define CONFIG_IDF_TARGET               "esp32"
+#define CONFIG_IDF_FIRMWARE_CHIP_ID     0x0000
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 240
+#define CONFIG_ESPTOOLPY_FLASHMODE_DIO  1
+#define CONFIG_ESPTOOLPY_FLASHFREQ_40M  1
@@ -0,0 +1,48 @@
+#pragma once
+/* Host stand-in for ESP-IDF wifi_provisioning/manager.h. The host device is always provisioned
+ * (simulated credentials), so the SoftAP portal never starts. */
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+  int unused;
+} wifi_prov_scheme_t;
+
+typedef struct
+{
+  void* event_cb;
+  void* user_data;
+} wifi_prov_event_handler_t;
+
+#define WIFI_PROV_EVENT_HANDLER_NONE {NULL, NULL}
+
+typedef struct
+{
+  wifi_prov_scheme_t scheme;
+  wifi_prov_event_handler_t scheme_event_handler;
+  wifi_prov_event_handler_t app_event_handler;
+} wifi_prov_mgr_config_t;
+
+typedef enum
+{
+  WIFI_PROV_SECURITY_0,
+  WIFI_PROV_SECURITY_1,
+  WIFI_PROV_SECURITY_2,
+} wifi_prov_security_t;
+
+esp_err_t wifi_prov_mgr_init(wifi_prov_mgr_config_t config);
+void wifi_prov_mgr_deinit(void);
+esp_err_t wifi_prov_mgr_is_provisioned(bool* provisioned);
+esp_err_t wifi_prov_mgr_start_provisioning(wifi_prov_security_t security, const void* sec_params, const char* service_name,
+                                           const char* service_key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+/* Host stand-in for ESP-IDF wifi_provisioning/scheme_softap.h. */
+
+#include "manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const wifi_prov_scheme_t wifi_prov_scheme_softap;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Measure HTTP round trips in each Wi-Fi power save mode of the device.
+
+    wifi_ps_probe.py [--host 192.168.4.1] [--requests 50] [--interval 0.2] [--wake 3]
+
+Pins the radio on (WIFI_PS_NONE), then in modem sleep (WIFI_PS_MIN_MODEM), through
+POST /wifi/power and times GET /wifi/power in each. Then it restores the auto policy and, --wake
+times, waits out the device's quiet period and times the first request, which is the one that
+pays for waking the radio. The device's per-mode time and estimated current follow at the end.
+"""
+
+import argparse
+import json
+import statistics
+import time
+import urllib.request
+
+
+def call(host, method, path):
+    t0 = time.perf_counter()
+    req = urllib.request.Request(f"http://{host}{path}", method=method, data=b"" if method == "POST" else None)
+    with urllib.request.urlopen(req, timeout=10) as resp:
+        body = resp.read()
+    return (time.perf_counter() - t0) * 1000.0, json.loads(body)
+
+
+def summary(name, rtts):
+    rtts = sorted(rtts)
+    p95 = rtts[min(len(rtts) - 1, int(len(rtts) * 0.95))]
+    print(f"{name:>10}: n={len(rtts):3d}  p50 {statistics.median(rtts):6.1f} ms  p95 {p95:6.1f} ms  max {rtts[-1]:6.1f} ms")
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--host", default="192.168.4.1")
+    ap.add_argument("--requests", type=int, default=50)
+    ap.add_argument("--interval", type=float, default=0.2, help="seconds between requests")
+    ap.add_argument("--wake", type=int, default=3, help="wake-up samples under the auto policy (0 to skip)")
+    ap.add_argument("--quiet", type=float, default=32.0, help="idle time before a wake-up sample, above WIFI_PS_QUIET_MS")
+    args = ap.parse_args()
+
+    for policy, name in (("on", "none"), ("save", "min_modem")):
+        call(args.host, "POST", f"/wifi/power?policy={policy}")
+        time.sleep(1.0)
+        rtts = []
+        for _ in range(args.requests):
+            rtts.append(call(args.host, "GET", "/wifi/power")[0])
+            time.sleep(args.interval)
+        summary(name, rtts)
+
+    _, stats = call(args.host, "POST", "/wifi/power?policy=auto")
+    if args.wake > 0:
+        rtts = []
+        for _ in range(args.wake):
+            time.sleep(args.quiet)
+            rtt, stats = call(args.host, "GET", "/wifi/power")
+            rtts.append(rtt)
+        summary("auto wake", rtts)
+
+    for name, m in stats["modes"].items():
+        print(f"{name:>10}: {m['time_ms'] / 1000:8.1f} s, {m['entries']} entries, {m['requests']} requests, ~{m['datasheet_ma']} mA (datasheet)")
+    print(f"average current (datasheet estimate): {stats['avg_ma_datasheet']} mA")
+
+
+if __name__ == "__main__":
+    main()
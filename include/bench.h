@@ -0,0 +1,29 @@
+#pragma once
+
+/** \file bench.h
+ *  \brief Microbenchmarks of the firmware's hot paths, run in place: JSON escaping and the
+ *  /hw_details document, the /pir312/status body, LED frame composition and PIR state evaluation.
+ *  Each case runs in batches and is timed with the CPU cycle counter and esp_timer; the best batch
+ *  shows the cost without preemption, the mean what the calling task saw. The same code serves
+ *  GET /bench on the device and host/bench_hot_paths.cpp on the host, with the same JSON.
+ */
+
+#include <stddef.h>
+#include <string>
+
+#define BENCH_CASE_BUDGET_MS 200 /* a case stops after this long even below the requested iterations */
+
+/** Run the cases whose name contains filter (NULL or "": all), each up to iterations times, and write
+ *  the results into out as JSON:
+ *  {"context":{...},"benchmarks":[{"name","iterations","real_time","time_unit","cycles","cycles_min","migrated"}]}
+ *  (the field names follow Google Benchmark's JSON output so its compare tools can read it).
+ *  Batches that moved to the other core count in "migrated" and are left out of the cycles.
+ *  Returns the length written, truncated to size - 1. */
+size_t bench_run_json(const char* filter, int iterations, char* out, size_t size);
+
+/* Hot paths of web_page_main.cpp measured by the cases. */
+void json_escape_append(std::string& out, const char* s);
+std::string build_inspect_json();
+
+/* GET /bench?name=<filter>&n=<iterations> */
+void bench_register_web_route_handlers(void);
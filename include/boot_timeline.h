@@ -0,0 +1,36 @@
+#pragma once
+
+/** \file boot_timeline.h
+ *  \brief Named boot checkpoints, timestamped with esp_timer (us since the app started; the
+ *  second-stage bootloader is not included). Callable from any task; shown in /hw_details.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_TIMELINE_MAX 24
+
+typedef struct
+{
+  const char* name; /* string literal passed to boot_mark() */
+  int64_t us;
+} boot_checkpoint_t;
+
+/** Record a checkpoint; name must stay valid (use a literal). Extra marks past the limit are dropped. */
+void boot_mark(const char* name);
+
+/** Copy up to max checkpoints in recording order; returns how many were copied. */
+int boot_timeline_get(boot_checkpoint_t* out, int max);
+
+/** Microseconds of the first checkpoint with that name, -1 if not reached. */
+int64_t boot_timeline_find(const char* name);
+
+/** Log the timeline with the step between checkpoints. */
+void boot_timeline_dump(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+/** \file latency_histogram.h
+ *  \brief Fixed-size log-linear histogram for durations in microseconds.
+ *  Each power of two is split into 2^SubBits linear buckets, so any recorded value is known to
+ *  within 1/2^SubBits (12.5 % with the default) over the full uint32_t range, in under 1 KB
+ *  and without allocation. Not thread safe; callers guard it like their other stats.
+ *  Header-only, no ESP-IDF dependencies.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace latency
+{
+  template <int SubBits = 3>
+  struct log_histogram
+  {
+    static const int k_sub = 1 << SubBits;
+    static const int k_buckets = (32 - SubBits + 1) * k_sub;
+
+    uint32_t counts[k_buckets];
+    uint32_t total;
+    uint32_t max;
+    uint64_t sum;
+
+    static int bucket_of(uint32_t v)
+    {
+      if (v < (uint32_t)k_sub)
+      {
+        return (int)v;
+      }
+      const int shift = (31 - __builtin_clz(v)) - SubBits;
+      return (shift + 1) * k_sub + (int)((v >> shift) & (k_sub - 1));
+    }
+
+    /** Largest value that falls into bucket b. */
+    static uint32_t bucket_upper(int b)
+    {
+      if (b < k_sub)
+      {
+        return (uint32_t)b;
+      }
+      const int shift = b / k_sub - 1;
+      const uint64_t lower = (uint64_t)(k_sub + b % k_sub) << shift;
+      return (uint32_t)(lower + ((uint64_t)1 << shift) - 1);
+    }
+
+    void reset()
+    {
+      memset(this, 0, sizeof(*this));
+    }
+
+    void record(uint32_t v)
+    {
+      ++counts[bucket_of(v)];
+      ++total;
+      sum += v;
+      if (v > max)
+      {
+        max = v;
+      }
+    }
+
+    /** Upper bound of the bucket holding the p-th percentile (0..100), capped at the maximum. */
+    uint32_t percentile(uint32_t p) const
+    {
+      if (total == 0)
+      {
+        return 0;
+      }
+      const uint64_t rank = ((uint64_t)total * p + 99) / 100;
+      uint64_t seen = 0;
+      for (int b = 0; b < k_buckets; ++b)
+      {
+        seen += counts[b];
+        if (seen >= rank && seen > 0)
+        {
+          const uint32_t upper = bucket_upper(b);
+          return (upper < max) ? upper : max;
+        }
+      }
+      return max;
+    }
+
+    uint32_t mean() const
+    {
+      return total ? (uint32_t)(sum / total) : 0;
+    }
+  };
+} // namespace latency
@@ -0,0 +1,125 @@
+#pragma once
+
+/** \file led_color.h
+ *  \brief Gamma correction and temporal dithering for WS2812B pixel data.
+ *  Header-only and free of ESP-IDF dependencies, so it also builds on the host (see host/).
+ *  Colors are given as perceptual 8-bit levels; the gamma table maps them to 8.8 fixed-point
+ *  PWM duty and the dither carries the fractional part from frame to frame.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef LED_GAMMA_X100
+#define LED_GAMMA_X100 260 // WS2812B perceived brightness is close to duty^(1/2.6)
+#endif
+
+namespace led_color
+{
+  namespace detail
+  {
+    // Minimal constexpr ln/exp so the tables are built by the compiler (std::pow is not constexpr).
+    constexpr double ln(double x)
+    {
+      int k = 0;
+      while (x > 1.5)
+      {
+        x *= 0.5;
+        ++k;
+      }
+      while (x < 0.75)
+      {
+        x *= 2.0;
+        --k;
+      }
+      // ln(x) = 2 * atanh((x - 1) / (x + 1)), |t| < 0.2 here so the series converges fast.
+      const double t = (x - 1.0) / (x + 1.0);
+      const double t2 = t * t;
+      double term = t;
+      double sum = 0.0;
+      for (int n = 1; n < 40; n += 2)
+      {
+        sum += term / n;
+        term *= t2;
+      }
+      return 2.0 * sum + k * 0.69314718055994530942;
+    }
+
+    constexpr double exp(double x)
+    {
+      // exp(x) = exp(x / 2^m)^(2^m) with |x / 2^m| < 0.5
+      int m = 0;
+      while (x > 0.5 || x < -0.5)
+      {
+        x *= 0.5;
+        ++m;
+      }
+      double sum = 1.0;
+      double term = 1.0;
+      for (int n = 1; n < 20; ++n)
+      {
+        term *= x / n;
+        sum += term;
+      }
+      while (m-- > 0)
+      {
+        sum *= sum;
+      }
+      return sum;
+    }
+
+    constexpr double pow(double base, double e)
+    {
+      return (base <= 0.0) ? 0.0 : exp(e * ln(base));
+    }
+  } // namespace detail
+
+  /** 256-entry table: perceptual level 0..255 -> PWM duty in 8.8 fixed point (0..65280). */
+  template <int GammaX100>
+  struct gamma_table
+  {
+    uint16_t v[256];
+
+    constexpr gamma_table()
+        : v()
+    {
+      for (int i = 0; i < 256; ++i)
+      {
+        const double duty = detail::pow(i / 255.0, GammaX100 / 100.0) * 255.0 * 256.0;
+        v[i] = (uint16_t)(duty + 0.5);
+      }
+    }
+  };
+
+  inline constexpr gamma_table<LED_GAMMA_X100> k_gamma{};
+
+  static_assert(k_gamma.v[0] == 0, "gamma(0) must be off");
+  static_assert(k_gamma.v[255] == 255 * 256, "gamma(255) must be full duty");
+
+  /** Seed the per-channel error accumulators with a spread pattern, so neighbouring pixels at
+   *  the same level do not toggle in the same frame. */
+  inline void dither_seed(uint8_t* err, size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      err[i] = (uint8_t)(i * 97u);
+    }
+  }
+
+  /** Perceptual RGB -> gamma-corrected 8-bit duty with first-order temporal dithering.
+   *  \param in        packed channel values (n bytes)
+   *  \param out       dithered output for this frame (n bytes)
+   *  \param err       per-channel fractional remainder carried between frames (n bytes)
+   *  \param scale_q16 global brightness factor applied to the duty, 65536 = unchanged
+   *  The time average of out[i] equals the 8.8 table value, so levels between two 8-bit duty
+   *  steps are reproduced as long as the strip is refreshed fast enough (>= 100 Hz). */
+  inline void gamma_dither(const uint8_t* in, uint8_t* out, uint8_t* err, size_t n, uint32_t scale_q16 = 65536)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      const uint32_t v = (((uint32_t)k_gamma.v[in[i]] * scale_q16) >> 16) + err[i];
+      out[i] = (uint8_t)(v >> 8);
+      err[i] = (uint8_t)v;
+    }
+  }
+} // namespace led_color
@@ -0,0 +1,201 @@
+#pragma once
+
+/** \file led_effects.h
+ *  \brief Lighting effects for strip zones and their compile-time registry.
+ *  An effect is a struct with a name, a per-frame prepare() and a per-pixel kernel:
+ *
+ *    struct effect_x
+ *    {
+ *      static constexpr const char* name = "x";
+ *      struct state { ... };
+ *      static state prepare(const zone_ctx& z);          // once per zone and frame
+ *      static rgb pixel(const state& s, int i, int n);   // once per pixel, inlined
+ *    };
+ *
+ *  render<Effect>() instantiates the pixel loop for each effect, so the only runtime dispatch is
+ *  one table lookup per zone and frame. To add an effect, define it here and append it to
+ *  `registry` at the bottom. Header-only, no ESP-IDF dependencies.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace led_effects
+{
+  struct rgb
+  {
+    uint8_t r, g, b;
+  };
+
+  /** Per-zone, per-frame inputs. Colors are perceptual levels (gamma is applied on output). */
+  struct zone_ctx
+  {
+    uint32_t t_ms;   // frame time
+    bool motion;     // the zone's own sensor is active
+    bool any_motion; // any sensor is active
+    rgb color;       // zone color
+    rgb ambient;     // background color while anyone is around
+  };
+
+  static inline rgb scale(rgb c, uint32_t level) // level 0..256
+  {
+    return rgb{(uint8_t)((c.r * level) >> 8), (uint8_t)((c.g * level) >> 8), (uint8_t)((c.b * level) >> 8)};
+  }
+
+  template <typename Effect>
+  static inline void render(const zone_ctx& z, uint8_t* out, int n)
+  {
+    const typename Effect::state s = Effect::prepare(z);
+    for (int i = 0; i < n; ++i, out += 3)
+    {
+      const rgb c = Effect::pixel(s, i, n);
+      out[0] = c.r;
+      out[1] = c.g;
+      out[2] = c.b;
+    }
+  }
+
+  struct effect_off
+  {
+    static constexpr const char* name = "off";
+    struct state
+    {
+    };
+    static state prepare(const zone_ctx&)
+    {
+      return state{};
+    }
+    static rgb pixel(const state&, int, int)
+    {
+      return rgb{0, 0, 0};
+    }
+  };
+
+  struct effect_static
+  {
+    static constexpr const char* name = "static";
+    struct state
+    {
+      rgb c;
+    };
+    static state prepare(const zone_ctx& z)
+    {
+      return state{z.color};
+    }
+    static rgb pixel(const state& s, int, int)
+    {
+      return s.c;
+    }
+  };
+
+  /** Triangle-wave brightness between 1/16 and full, 4 s period. */
+  struct effect_breathing
+  {
+    static constexpr const char* name = "breathing";
+    static const uint32_t k_period_ms = 4000;
+    struct state
+    {
+      rgb c;
+    };
+    static state prepare(const zone_ctx& z)
+    {
+      const uint32_t phase = z.t_ms % k_period_ms;
+      const uint32_t half = k_period_ms / 2;
+      const uint32_t tri = (phase < half) ? phase : (k_period_ms - phase); // 0..half
+      return state{scale(z.color, 16 + (tri * 240) / half)};
+    }
+    static rgb pixel(const state& s, int, int)
+    {
+      return s.c;
+    }
+  };
+
+  /** A block of the zone color running over the ambient background. */
+  struct effect_chase
+  {
+    static constexpr const char* name = "chase";
+    static const int k_width = 5;
+    static const uint32_t k_px_per_s = 20;
+    struct state
+    {
+      rgb c;
+      rgb bg;
+      uint32_t head;
+    };
+    static state prepare(const zone_ctx& z)
+    {
+      return state{z.color, z.ambient, (uint32_t)((uint64_t)z.t_ms * k_px_per_s / 1000)};
+    }
+    static rgb pixel(const state& s, int i, int n)
+    {
+      const uint32_t d = (s.head + (uint32_t)n - (uint32_t)i) % (uint32_t)n;
+      return (d < (uint32_t)k_width) ? s.c : s.bg;
+    }
+  };
+
+  /** Original closet behavior: zone color while its sensor sees motion, ambient while any
+   *  other sensor does, dark otherwise. */
+  struct effect_motion_follow
+  {
+    static constexpr const char* name = "motion";
+    struct state
+    {
+      rgb c;
+    };
+    static state prepare(const zone_ctx& z)
+    {
+      return state{z.motion ? z.color : (z.any_motion ? z.ambient : rgb{0, 0, 0})};
+    }
+    static rgb pixel(const state& s, int, int)
+    {
+      return s.c;
+    }
+  };
+
+  template <typename... Effects>
+  struct registry_of
+  {
+    typedef void (*render_fn)(const zone_ctx&, uint8_t*, int);
+
+    static constexpr int count = (int)sizeof...(Effects);
+    static constexpr const char* names[] = {Effects::name...};
+    static constexpr render_fn renderers[] = {&led_effects::render<Effects>...};
+
+    /** Compile-time index of an effect type in the registry, or -1. */
+    template <typename Effect>
+    static constexpr int index_of()
+    {
+      constexpr bool match[] = {std::is_same<Effect, Effects>::value...};
+      for (int i = 0; i < count; ++i)
+      {
+        if (match[i])
+        {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+    /** Index of the effect called `name`, or -1. */
+    static int find(const char* name)
+    {
+      for (int i = 0; i < count; ++i)
+      {
+        if (name != NULL && strcmp(names[i], name) == 0)
+        {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+    static void render_zone(int index, const zone_ctx& z, uint8_t* out, int n)
+    {
+      renderers[(index >= 0 && index < count) ? index : 0](z, out, n);
+    }
+  };
+
+  typedef registry_of<effect_off, effect_static, effect_breathing, effect_chase, effect_motion_follow> registry;
+} // namespace led_effects
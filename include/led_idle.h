@@ -0,0 +1,70 @@
+#pragma once
+
+/** \file led_idle.h
+ *  \brief Active/idle decision for the LED task. While nothing is lit, nobody moves and no stream
+ *  runs, the task can stop its 200 Hz frame timer and let the chip light-sleep; any of those
+ *  coming back (or an explicit wake request) returns it to full rate.
+ *  Header-only, no ESP-IDF dependencies, so host/led_sim exercises the same logic.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace led_idle
+{
+  struct inputs
+  {
+    bool lit;          // the frame just composed has a non-zero level
+    bool motion;       // any PIR reports motion
+    bool streaming;    // a realtime stream owns the strip
+    bool hold;         // something else needs full-rate frames (flash sync during OTA)
+    bool wake_request; // PIR edge, stream frame or zone change since the last evaluation
+  };
+
+  struct tracker
+  {
+    uint32_t idle_after_ms; // quiet time before going idle
+    bool idle;
+    bool quiet;
+    uint32_t quiet_since_ms;
+
+    /** Evaluate once per frame (active) or poll (idle); true when the mode changed.
+     *  Wrap-safe over the uint32_t millisecond clock. */
+    bool update(const inputs& in, uint32_t now_ms)
+    {
+      if (in.lit || in.motion || in.streaming || in.hold || in.wake_request)
+      {
+        quiet = false;
+        if (idle)
+        {
+          idle = false;
+          return true;
+        }
+        return false;
+      }
+      if (!quiet)
+      {
+        quiet = true;
+        quiet_since_ms = now_ms;
+      }
+      if (!idle && now_ms - quiet_since_ms >= idle_after_ms)
+      {
+        idle = true;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  inline bool any_lit(const uint8_t* levels, size_t n)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (levels[i] != 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+} // namespace led_idle
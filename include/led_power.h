@@ -0,0 +1,81 @@
+#pragma once
+
+/** \file led_power.h
+ *  \brief Per-frame current estimate and global brightness limit for the WS2812B strip.
+ *  The strip shares one 5V PSU with the board (see data/project_doc.md), so a frame that would
+ *  exceed the budget is scaled down as a whole instead of browning out the ESP32.
+ *  Header-only, no ESP-IDF dependencies.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "led_color.h"
+
+#ifndef LED_MA_PER_CHANNEL
+#define LED_MA_PER_CHANNEL 20 // one WS2812B color channel at full duty
+#endif
+#ifndef LED_IDLE_UA_PER_PIXEL
+#define LED_IDLE_UA_PER_PIXEL 1000 // driver IC quiescent current, LEDs off
+#endif
+
+namespace led_power
+{
+  static const uint32_t k_full_scale_q16 = 65536;
+
+  /** Sum of gamma-corrected duties (8.8 fixed point) over n channel levels.
+   *  Four independent accumulators keep the loads from serializing on one add chain;
+   *  the total fits 32 bits for up to 65793 channels. */
+  inline uint32_t duty_sum(const uint8_t* levels, size_t n)
+  {
+    uint32_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      a0 += led_color::k_gamma.v[levels[i + 0]];
+      a1 += led_color::k_gamma.v[levels[i + 1]];
+      a2 += led_color::k_gamma.v[levels[i + 2]];
+      a3 += led_color::k_gamma.v[levels[i + 3]];
+    }
+    for (; i < n; ++i)
+    {
+      a0 += led_color::k_gamma.v[levels[i]];
+    }
+    return a0 + a1 + a2 + a3;
+  }
+
+  inline uint32_t idle_ma(size_t pixels)
+  {
+    return (uint32_t)(pixels * LED_IDLE_UA_PER_PIXEL / 1000);
+  }
+
+  /** Estimated strip current for a frame: quiescent draw plus duty-weighted channel current. */
+  inline uint32_t estimate_ma(uint32_t duty_sum_q8, size_t pixels)
+  {
+    return idle_ma(pixels) + (uint32_t)(((uint64_t)duty_sum_q8 * LED_MA_PER_CHANNEL) / (255u * 256u));
+  }
+
+  /** Brightness factor (Q16, 65536 = unchanged) that brings the channel current of the frame
+   *  within budget_ma. The quiescent part cannot be scaled and is subtracted first. */
+  inline uint32_t limit_scale_q16(uint32_t est_ma, size_t pixels, uint32_t budget_ma)
+  {
+    const uint32_t idle = idle_ma(pixels);
+    if (est_ma <= budget_ma || est_ma <= idle)
+    {
+      return k_full_scale_q16;
+    }
+    const uint32_t allowed = (budget_ma > idle) ? (budget_ma - idle) : 0;
+    return (uint32_t)(((uint64_t)allowed << 16) / (est_ma - idle));
+  }
+
+  /** Channel current after applying a Q16 scale, for telemetry. */
+  inline uint32_t scaled_ma(uint32_t est_ma, size_t pixels, uint32_t scale_q16)
+  {
+    const uint32_t idle = idle_ma(pixels);
+    if (est_ma <= idle)
+    {
+      return est_ma;
+    }
+    return idle + (uint32_t)(((uint64_t)(est_ma - idle) * scale_q16) >> 16);
+  }
+} // namespace led_power
@@ -0,0 +1,36 @@
+#pragma once
+
+/** \file led_stream.h
+ *  \brief Realtime pixel streaming over UDP (DDP on port 4048, E1.31 / sACN on port 5568).
+ *  Received pixels drive the strip directly; without packets for LED_STREAM_TIMEOUT_MS the
+ *  strip returns to the sensor-driven zones (see ws2812b_support.h).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \brief Open the UDP sockets and start the receiver task. Safe to call more than once. */
+void led_stream_start(void);
+
+/** Called from the receiver task for every accepted datagram (Wi-Fi power save keeps the radio on). */
+typedef void (*led_stream_activity_hook_t)(void);
+void led_stream_set_activity_hook(led_stream_activity_hook_t hook);
+
+#ifdef __cplusplus
+}
+#endif
+
+typedef struct
+{
+  bool active;        /* the strip currently shows streamed pixels */
+  uint32_t packets;   /* datagrams accepted */
+  uint32_t frames;    /* frames committed (DDP push / last E1.31 universe or sync) */
+  uint32_t dropped;   /* datagrams rejected: not DDP/E1.31 data, or outside the strip */
+  uint32_t seq_gaps;  /* DDP sequence numbers skipped (lost or reordered datagrams) */
+} led_stream_stats_t;
+
+void led_stream_get_stats(led_stream_stats_t* out);
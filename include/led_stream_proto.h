@@ -0,0 +1,131 @@
+#pragma once
+
+/** \file led_stream_proto.h
+ *  \brief Header parsing for realtime pixel streaming over UDP: DDP and E1.31 (sACN).
+ *  Only the protocol headers are parsed here; the receiver reads the pixel payload straight
+ *  into the LED stream buffer at the returned offset. Header-only, no ESP-IDF dependencies.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace led_stream
+{
+  static const uint16_t k_ddp_port = 4048;
+  static const uint16_t k_e131_port = 5568;
+
+  static const size_t k_ddp_header_len = 10;
+  static const size_t k_ddp_header_len_tc = 14; // with the optional timecode field
+  static const size_t k_e131_header_len = 126;  // up to and including the DMX start code
+  static const size_t k_e131_sync_len = 49;     // synchronization packet
+  static const uint32_t k_e131_universe_bytes = 510; // 170 RGB pixels per universe
+  static const uint8_t k_acn_id[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+  /** Where the payload of a datagram goes in the pixel buffer. */
+  struct packet_info
+  {
+    bool valid;
+    size_t header_len; // bytes before the pixel data
+    uint32_t offset;   // byte offset of the first channel in the pixel buffer
+    uint32_t length;   // payload bytes announced by the header
+    bool push;         // frame complete, display it
+    uint32_t universe;      // E1.31: universe of the packet
+    uint32_t sync_universe; // E1.31: the frame is shown by a sync packet on this universe (0: none)
+  };
+
+  static inline uint32_t be16(const uint8_t* p)
+  {
+    return ((uint32_t)p[0] << 8) | p[1];
+  }
+
+  static inline uint32_t be32(const uint8_t* p)
+  {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+  }
+
+  /** DDP (Distributed Display Protocol) header, version 1.
+   *  byte 0 flags (VV-T-SRQP: version 01, timecode, storage, reply, query, push), 1 sequence,
+   *  2 data type, 3 destination id, 4..7 offset, 8..9 length. Only RGB/8-bit data to the default
+   *  output (id 1) is accepted; query/reply/storage packets are ignored. */
+  static inline packet_info parse_ddp(const uint8_t* p, size_t n)
+  {
+    packet_info info = {};
+    if (n < k_ddp_header_len)
+    {
+      return info;
+    }
+    const uint8_t flags = p[0];
+    const uint8_t type = p[2];
+    const uint8_t id = p[3];
+    if ((flags & 0xC0) != 0x40 || (flags & 0x0E) != 0)
+    {
+      return info; // wrong version, or query/reply/storage
+    }
+    if (id != 1 || (type != 0x00 && type != 0x0B && type != 0x01))
+    {
+      return info; // 0x00 = legacy "undefined", 0x0B / 0x01 = RGB 8 bit per channel
+    }
+    info.header_len = (flags & 0x10) ? k_ddp_header_len_tc : k_ddp_header_len;
+    if (n < info.header_len)
+    {
+      return info;
+    }
+    info.offset = be32(p + 4);
+    info.length = be16(p + 8);
+    info.push = (flags & 0x01) != 0;
+    info.valid = true;
+    return info;
+  }
+
+  /** E1.31 data packet (ANSI E1.31-2018). Universes starting at first_universe map to
+   *  consecutive 510-byte slices of the pixel buffer; a packet that reaches the end of the
+   *  buffer completes the frame. The receiver also completes it on the highest universe the
+   *  sender uses, or on the sync packet when sync_universe is set. Non-zero start codes are
+   *  ignored. */
+  static inline packet_info parse_e131(const uint8_t* p, size_t n, uint16_t first_universe, size_t buffer_size)
+  {
+    packet_info info = {};
+    if (n < k_e131_header_len || memcmp(p + 4, k_acn_id, sizeof(k_acn_id)) != 0)
+    {
+      return info;
+    }
+    if (be32(p + 18) != 0x00000004 || be32(p + 40) != 0x00000002 || p[117] != 0x02 || p[125] != 0x00)
+    {
+      return info; // root vector DATA, framing vector DATA, DMP set property, DMX start code 0
+    }
+    const uint32_t universe = be16(p + 113);
+    const uint32_t slots = be16(p + 123); // property value count, includes the start code
+    if (universe < first_universe || slots < 1)
+    {
+      return info;
+    }
+    info.header_len = k_e131_header_len;
+    info.offset = (universe - first_universe) * k_e131_universe_bytes;
+    info.length = slots - 1;
+    if (info.length > k_e131_universe_bytes)
+    {
+      info.length = k_e131_universe_bytes; // slots 511/512 would split a pixel
+    }
+    info.push = (info.offset + info.length >= buffer_size);
+    info.universe = universe;
+    info.sync_universe = be16(p + 109);
+    info.valid = true;
+    return info;
+  }
+
+  /** E1.31 synchronization packet: root vector EXTENDED, framing vector SYNCHRONIZATION.
+   *  Returns its synchronization universe, 0 for any other packet. */
+  static inline uint32_t parse_e131_sync(const uint8_t* p, size_t n)
+  {
+    if (n < k_e131_sync_len || memcmp(p + 4, k_acn_id, sizeof(k_acn_id)) != 0)
+    {
+      return 0;
+    }
+    if (be32(p + 18) != 0x00000008 || be32(p + 40) != 0x00000001)
+    {
+      return 0;
+    }
+    return be16(p + 45);
+  }
+} // namespace led_stream
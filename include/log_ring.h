@@ -0,0 +1,56 @@
+#pragma once
+
+/** \file log_ring.h
+ *  \brief RAM ring for ESP_LOG output. The esp_log vprintf hook formats each line into a slot of
+ *  a fixed ring (lock-free: a slot is claimed with an atomic increment and published with its
+ *  sequence number), and a low-priority task copies new lines to the UART. Logging tasks no longer
+ *  wait for 115200 baud, and the last LOG_RING_SLOTS lines stay readable over HTTP (GET /log).
+ *  Lines still in the ring at a crash are not on the UART; the panic handler output is unaffected.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_RING_SLOTS 64  /* power of two */
+#define LOG_RING_LINE  152 /* longer lines are cut */
+
+typedef struct
+{
+  uint32_t seq;  /* 1-based, increases by one per line */
+  char level;    /* 'E', 'W', 'I', 'D', 'V' or '?' when the line has no esp_log prefix */
+  uint16_t len;
+  char text[LOG_RING_LINE];
+} log_ring_line_t;
+
+/** Install the vprintf hook and start the UART task. Call early in app_main. */
+void log_ring_init(void);
+
+/** Sequence number the next line will get. */
+uint32_t log_ring_next_seq(void);
+
+/** Copy the oldest line with seq >= *from into out and set *from past it. Returns false when there
+ *  is no such line yet; lines already overwritten are skipped (out->seq shows the gap). */
+bool log_ring_read(uint32_t* from, log_ring_line_t* out);
+
+/** true: bypass the ring and write to the UART in the calling task (the old behavior), to compare
+ *  logging cost; the log.ring_us / log.sync_us histograms in GET /metrics hold both. */
+void log_ring_set_sync(bool sync);
+bool log_ring_sync(void);
+
+/** Lines overwritten before the UART task copied them. */
+uint32_t log_ring_uart_dropped(void);
+
+/** 'E' < 'W' < 'I' < 'D' < 'V' as esp_log levels 1..5; 0 for anything else. */
+int log_ring_level_rank(char level);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/* GET /log (buffered lines, level filter, long-poll tail) and POST /log/mode. */
+void log_register_web_route_handlers(void);
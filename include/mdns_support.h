@@ -10,12 +10,20 @@ extern "C" {
 #endif
 
 /** \brief Start mDNS responder, set hostname/instance and advertise services.
+ *  `_http._tcp` carries static TXT metadata (firmware version and build, sensor/LED/zone counts,
+ *  endpoint paths); `_telemetry._tcp` carries live state, see mdns_update_txt().
  *  \param hostname  host name used by mDNS (e.g., "arduino_1") -> "arduino_1.local"
  *  \param instance  human‑friendly instance name (shown in browsers)
  *  \return 0 on success; negative on failure
  */
 int mdns_start(const char *hostname, const char *instance);
 
+/** \brief Re-announce the live TXT items of the `_telemetry._tcp` service (LED mode, motion,
+ *  daylight) whose value changed since the last call. Cheap when nothing changed; called once a
+ *  second from the monitor task.
+ */
+void mdns_update_txt(void);
+
 /** \brief Stop mDNS and free resources. */
 void mdns_stop(void);
 
@@ -0,0 +1,53 @@
+#pragma once
+
+/** \file metrics.h
+ *  \brief Shared registry of named counters, gauges and histograms. Modules register their metrics
+ *  once at init and publish into them with a store or an atomic add, so publishing costs about
+ *  as much as the plain counters it replaces. The monitor task logs what changed
+ *  (metrics_log_changes()) and GET /metrics serves the same registry as JSON.
+ *  Registration returns NULL when the registry is full; every call accepts NULL and does nothing.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_MAX            32
+#define METRICS_HISTOGRAMS_MAX 4  /* ~1 KB each (latency_histogram.h) */
+#define METRICS_LOG_INTERVAL_S 60 /* full summary even when no gauge moved */
+
+typedef struct metric* metric_t;
+
+/** Register (or look up, if the name exists) a metric. name must stay valid (use a literal); the
+ *  usual form is "<module>.<what>", e.g. "pir.onsets". */
+metric_t metrics_counter(const char* name);
+/** A gauge change smaller than deadband does not trigger a log line on its own (e.g. ADC noise). */
+metric_t metrics_gauge(const char* name, uint32_t deadband);
+/** Log-linear histogram of microsecond durations (or any uint32_t value). */
+metric_t metrics_histogram(const char* name);
+
+/** Counter += n. Safe from ISRs and any task. */
+void metrics_add(metric_t m, uint32_t n);
+/** Gauge = v. Safe from ISRs and any task. */
+void metrics_set(metric_t m, int32_t v);
+/** Histogram sample. Task context (takes a spinlock for the bucket update). */
+void metrics_record(metric_t m, uint32_t v);
+
+/** Current value of a counter or gauge by name (histograms: sample count); false if unknown. */
+bool metrics_value(const char* name, int32_t* out);
+
+/** Log one compact line of what changed since the previous line: gauges as name=value, counters as
+ *  name+delta, histograms as name n+delta p95. Emitted when a gauge moved past its deadband or
+ *  every METRICS_LOG_INTERVAL_S; otherwise nothing is written. Call periodically from one task. */
+void metrics_log_changes(void);
+
+/** All metrics as JSON into buf; returns the length written (the output is cut at size - 1). */
+size_t metrics_format_json(char* buf, size_t size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
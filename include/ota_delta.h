@@ -0,0 +1,43 @@
+#pragma once
+
+/** \file ota_delta.h
+ *  \brief Streaming decoder for delta OTA patches (made by host/ota_delta.py).
+ *  The new image is rebuilt from the running partition plus the patch and handed to a sink as it
+ *  is produced; the patch can itself arrive gzip-compressed through ota_inflate.h.
+ *
+ *  Patch format, integers little-endian:
+ *    "OTAD" | u32 new image size | 32 B app_elf_sha256 of the base firmware
+ *    then ops until the new image is complete:
+ *      0x01 COPY  u32 src, u32 len             len bytes of the base at src
+ *      0x02 DIFF  u32 src, u32 len, len bytes  base bytes at src plus the given bytes (mod 256)
+ *      0x03 DATA  u32 len, len bytes           literal bytes
+ *  One stream at a time.
+ */
+
+#include <esp_err.h>
+#include <esp_partition.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef bool (*ota_delta_sink_t)(const uint8_t* data, size_t len);
+
+typedef struct
+{
+  uint32_t patch_bytes;
+  uint32_t copy_bytes; /* image bytes taken unchanged from the base */
+  uint32_t diff_bytes; /* image bytes from base + difference */
+  uint32_t data_bytes; /* literal image bytes */
+} ota_delta_stats_t;
+
+/** Start decoding against base, the running app partition. */
+esp_err_t ota_delta_begin(const esp_partition_t* base);
+
+/** Decode the next len patch bytes. ESP_ERR_INVALID_RESPONSE on a malformed patch,
+ *  ESP_ERR_INVALID_VERSION when it was made for another base, ESP_FAIL when the sink stopped. */
+esp_err_t ota_delta_feed(const uint8_t* in, size_t len, ota_delta_sink_t sink);
+
+/** After the last feed: true when exactly the announced image size was produced. */
+bool ota_delta_complete(void);
+
+void ota_delta_get_stats(ota_delta_stats_t* out);
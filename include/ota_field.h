@@ -0,0 +1,37 @@
+#pragma once
+
+/** \file ota_field.h
+ *  \brief Fixed-size fields of the streamed OTA formats (gzip header and trailer, delta header and
+ *  op arguments), which may arrive split across feeds. Shared by ota_inflate.cpp and ota_delta.cpp.
+ *  Header-only, no ESP-IDF dependencies.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace ota_field
+{
+  static inline uint32_t le32(const uint8_t* p)
+  {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  template <size_t N> struct buffer
+  {
+    uint8_t data[N];
+    size_t len;
+
+    /** Take bytes from *in (advancing it and *in_len) until `want` are collected; returns true once
+     *  they are. Set len to 0 to start the next field. */
+    bool collect(const uint8_t** in, size_t* in_len, size_t want)
+    {
+      const size_t n = (want - len < *in_len) ? want - len : *in_len;
+      memcpy(data + len, *in, n);
+      len += n;
+      *in += n;
+      *in_len -= n;
+      return len == want;
+    }
+  };
+} // namespace ota_field
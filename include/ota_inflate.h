@@ -0,0 +1,30 @@
+#pragma once
+
+/** \file ota_inflate.h
+ *  \brief Streaming gzip decoder for compressed OTA uploads.
+ *  Uses the inflater in the chip ROM (miniz tinfl). Memory is bounded by the 32 KB deflate
+ *  window plus the ~11 KB decoder state, independent of the image size. Decoded bytes are
+ *  handed to a sink as soon as they are produced; the gzip CRC-32 and length trailer are checked
+ *  at the end. One stream at a time.
+ */
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Receives decoded data. Returns false to stop decoding (the sink's own error). */
+typedef bool (*ota_inflate_sink_t)(const uint8_t* data, size_t len);
+
+esp_err_t ota_inflate_begin(void);
+
+/** Decode the next len compressed bytes. ESP_ERR_INVALID_RESPONSE on a corrupt stream,
+ *  ESP_FAIL when the sink stopped. */
+esp_err_t ota_inflate_feed(const uint8_t* in, size_t len, ota_inflate_sink_t sink);
+
+/** After the last feed: true when the stream ended with a matching trailer. */
+bool ota_inflate_complete(void);
+
+uint32_t ota_inflate_out_bytes(void);
+
+void ota_inflate_end(void);
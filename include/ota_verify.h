@@ -0,0 +1,37 @@
+#pragma once
+
+/** \file ota_verify.h
+ *  \brief Streaming verification of OTA images.
+ *  The image is hashed (SHA-256) chunk by chunk as it is received, so checking it needs no
+ *  second pass over flash. The expected identity comes with the upload:
+ *    X-Image-SHA256     64 hex chars, digest of the whole image
+ *    X-Image-Signature  base64 signature (ECDSA or RSA, over the SHA-256) by the release key
+ *  A signature is required when the firmware is built with a release public key, i.e. when an
+ *  `ota_signing_key.h` defining OTA_SIGNING_PUBKEY_PEM is on the include path.
+ *  One session at a time, like ota_writer.h.
+ */
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Start a session. sha256_hex / signature_b64 may be NULL or empty when not supplied.
+ *  Fails (with a reason in err) on malformed values or a missing required signature. */
+bool ota_verify_begin(const char* sha256_hex, const char* signature_b64, char* err, size_t err_size);
+
+/* Image header, first segment header and esp_app_desc_t: what ota_verify_image_header() reads. */
+#define OTA_VERIFY_HEADER_BYTES 288
+
+/** Check the image and app headers in the first OTA_VERIFY_HEADER_BYTES of the upload against the
+ *  running app: magic, target chip and project name. Lets a wrong file fail after the first buffer. */
+bool ota_verify_image_header(const uint8_t* data, size_t len, char* err, size_t err_size);
+
+void ota_verify_update(const uint8_t* data, size_t len);
+
+/** Finish hashing and compare with the expected digest and signature. Returns false with a
+ *  reason on mismatch. out_sha256 (32 bytes, optional) receives the computed digest. */
+bool ota_verify_finish(uint8_t* out_sha256, char* err, size_t err_size);
+
+/** Drop the session without checking (aborted upload). */
+void ota_verify_abort(void);
@@ -0,0 +1,72 @@
+#pragma once
+
+/** \file ota_writer.h
+ *  \brief Pipelined OTA flash writer.
+ *  The HTTP handler only receives: it takes a free buffer, fills it from the socket and submits
+ *  it. A writer task drains submitted buffers into the update partition with esp_ota_write()
+ *  while the next ones are being received, and erases the partition ahead of the write position
+ *  whenever it is waiting for data, so erases rarely stall the network.
+ *  Flash operations stall code running from flash on both cores, so they are split into short
+ *  erases and writes that run between LED strip transmissions (ws2812b_flash_claim) and take at
+ *  most a configured share of the time.
+ *  One session at a time; begin/acquire/submit/finish/abort are called from the same task.
+ */
+
+#include <esp_err.h>
+#include <esp_partition.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+  uint32_t bytes;          /* image bytes written */
+  uint32_t total_ms;       /* ota_writer_begin() -> ota_writer_finish() */
+  uint32_t recv_ms;        /* handler blocked in web_recv(), filled in by the caller */
+  uint32_t wire_bytes;     /* bytes received (compressed size for gzip uploads), filled in by the caller */
+  uint32_t decode_ms;      /* decompressing / applying a delta patch, filled in by the caller */
+  uint32_t buf_wait_ms;    /* handler blocked waiting for a free buffer (flash slower than network) */
+  uint32_t write_ms;       /* writer task in esp_ota_write() */
+  uint32_t erase_ms;       /* writer task erasing */
+  uint32_t idle_ms;        /* writer task waiting for data with nothing left to erase */
+  uint32_t end_ms;         /* esp_ota_end(): image verification */
+  uint32_t kib_per_s;      /* end-to-end throughput */
+  uint32_t gap_wait_ms;    /* writer task waiting for a gap between LED transmissions */
+  uint32_t duty_wait_ms;   /* writer task held back by the flash duty budget */
+  uint32_t led_frames;     /* LED frames sent during the update */
+  uint32_t led_missed;     /* LED frame deadlines missed during the update */
+  uint32_t led_deferred;   /* LED frames put off because a flash operation held the strip */
+  uint32_t led_skipped;    /* LED frame periods given up to erases */
+} ota_report_t;
+
+typedef struct
+{
+  uint32_t erase_chunk;    /* bytes per erase, multiple of 4096; 65536 uses block erases */
+  uint32_t write_slice;    /* bytes per esp_ota_write(), multiple of 16 */
+  uint32_t duty_pct;       /* share of the update's wall time flash operations may take */
+  bool led_sync;           /* schedule flash operations between LED transmissions */
+} ota_writer_config_t;
+
+/** Flash scheduling used by the next session. Fails with ESP_ERR_INVALID_STATE during one. */
+esp_err_t ota_writer_set_config(const ota_writer_config_t* cfg);
+void ota_writer_get_config(ota_writer_config_t* out);
+
+/** Open the update session for an image of image_size bytes and start the writer task. */
+esp_err_t ota_writer_begin(const esp_partition_t* part, size_t image_size);
+
+/** Next free buffer to receive into (blocks while all are queued for writing). NULL once the
+ *  writer has failed; the session must then be aborted. */
+uint8_t* ota_writer_acquire(size_t* capacity);
+
+/** Queue len bytes of an acquired buffer for writing. */
+void ota_writer_submit(uint8_t* buf, size_t len);
+
+/** Return an acquired buffer unwritten (its data was not received completely). */
+void ota_writer_discard(uint8_t* buf);
+
+/** Wait for all queued data to be written, close the session with esp_ota_end() and fill report.
+ *  Returns the first write error, or the esp_ota_end() result. */
+esp_err_t ota_writer_finish(ota_report_t* report);
+
+/** Stop the writer and discard the session. */
+void ota_writer_abort(void);
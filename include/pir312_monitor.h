@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -15,5 +16,21 @@ void pir312_dump_status();
 
 bool pir312_get_state(int index);
 int pir312_count();
+/* All sensors as a mask (bit i: sensor i sees motion); also publishes the pir.motion gauge.
+ * Called by the LED task with each sensor sample, the only publisher. */
+uint32_t pir312_sample_motion(void);
+/* ISR timestamp (esp_timer us) of the latest idle -> motion edge not yet taken, 0 if none. */
+uint64_t pir312_take_onset_us(int index);
+
+/* Called from the PIR ISR on every edge; must be ISR-safe. */
+typedef void (*pir312_edge_hook_t)(void);
+void pir312_set_edge_hook(pir312_edge_hook_t hook);
+
+/* Make the next edge on any PIR pin a light-sleep wake source; the ISR disarms on the first edge. */
+void pir312_arm_wakeup(void);
+void pir312_disarm_wakeup(void);
+
+/* GET /pir312/status body: sensor states and light reading as JSON. Returns the length. */
+size_t pir312_format_status(char* buf, size_t size);
 
 void pir312_register_web_route_handlers();
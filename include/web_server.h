@@ -24,3 +24,6 @@ void web_send_binary(int code, const char* content_type, const void* data, size_
 int web_recv(void* buf, size_t maxlen);
 size_t web_content_length();
 bool web_set_resp_header(const char* name, const char* value);
+bool web_header_str(const char* name, char* out, size_t size);
+bool web_query_str(const char* key, char* out, size_t size);
+bool web_query_int(const char* key, int* out);
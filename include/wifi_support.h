@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,6 +16,94 @@ void wifi_set_hostname(const char* name);
 
 const char* wifi_get_ap_password();
 
+/** How the STA got its first IP after boot. */
+typedef enum
+{
+  WIFI_CONNECT_NONE,         /* no IP yet / provisioning */
+  WIFI_CONNECT_FULL_SCAN,    /* no usable cache: full scan + DHCP */
+  WIFI_CONNECT_FAST,         /* cached BSSID/channel + DHCP */
+  WIFI_CONNECT_FAST_STATIC,  /* cached BSSID/channel + cached lease as static IP */
+  WIFI_CONNECT_FALLBACK,     /* cached AP failed, full scan + DHCP */
+} wifi_connect_path_t;
+
+typedef struct
+{
+  wifi_connect_path_t path;
+  uint32_t boot_to_ip_ms;  /* 0 until the first IP */
+  uint32_t start_to_ip_ms; /* from esp_wifi_start() */
+  bool cached;             /* an AP/lease cache exists in NVS */
+  bool static_ip;          /* static IP from the cached lease is enabled */
+} wifi_connect_stats_t;
+
+void wifi_get_connect_stats(wifi_connect_stats_t* out);
+const char* wifi_connect_path_name(wifi_connect_path_t path);
+
+typedef enum
+{
+  WIFI_BREAKER_CLOSED,    /* reconnecting with backoff */
+  WIFI_BREAKER_OPEN,      /* too many failures: waiting out the cooldown */
+  WIFI_BREAKER_HALF_OPEN, /* one probe attempt after the cooldown */
+} wifi_breaker_state_t;
+
+typedef struct
+{
+  uint32_t disconnects;
+  uint32_t last_reason;       /* wifi_err_reason_t of the latest disconnect */
+  int64_t last_disconnect_us; /* esp_timer, 0 if never */
+  uint32_t attempts;          /* esp_wifi_connect() calls */
+  uint32_t consecutive_failures;
+  uint32_t next_delay_ms;     /* delay before the pending retry */
+  wifi_breaker_state_t breaker;
+  uint32_t breaker_trips;
+  uint32_t attempt_ms;        /* radio time in connect attempts (scan/auth/assoc until connected or failed) */
+  uint32_t outage_ms;         /* time without IP after a disconnect, current outage included */
+  uint32_t cpu_us;            /* time in the reconnect path (disconnect handler and retry timer) */
+} wifi_reconnect_stats_t;
+
+void wifi_get_reconnect_stats(wifi_reconnect_stats_t* out);
+const char* wifi_breaker_name(wifi_breaker_state_t state);
+
+typedef enum
+{
+  WIFI_POWER_AUTO,        /* modem sleep when idle, radio on while active */
+  WIFI_POWER_ALWAYS_ON,   /* WIFI_PS_NONE */
+  WIFI_POWER_ALWAYS_SAVE, /* WIFI_PS_MIN_MODEM */
+} wifi_power_policy_t;
+
+typedef struct
+{
+  uint32_t time_ms;  /* time spent in the mode */
+  uint32_t entries;
+  uint32_t requests; /* activity (HTTP requests) that arrived while in the mode */
+  uint32_t datasheet_ma; /* datasheet current of the mode (not measured), for the estimate */
+} wifi_power_mode_stats_t;
+
+typedef struct
+{
+  wifi_power_policy_t policy;
+  bool saving;    /* currently in modem sleep */
+  uint32_t holds; /* sessions keeping the radio on */
+  uint32_t idle_ms;
+  wifi_power_mode_stats_t mode[2]; /* [0] WIFI_PS_NONE, [1] WIFI_PS_MIN_MODEM */
+  uint32_t avg_ma_datasheet;       /* time-weighted from the datasheet currents, an estimate */
+} wifi_power_stats_t;
+
+/** Keep the radio out of power save while a session runs (auto policy); pair with release. */
+void wifi_power_hold();
+void wifi_power_release();
+/** One-off activity (a stream datagram): radio on now, modem sleep again after the quiet period. */
+void wifi_power_activity(void);
+
+void wifi_power_set_policy(wifi_power_policy_t policy);
+const char* wifi_power_policy_name(wifi_power_policy_t policy);
+void wifi_get_power_stats(wifi_power_stats_t* out);
+
+/** Use the cached lease as a static IP on the next boot (stored in NVS). */
+void wifi_set_static_ip(bool on);
+
+/** Drop the cached AP and lease; the next boot does a full scan. */
+void wifi_forget_fast_connect();
+
 void wifi_reset();
 
 #ifdef __cplusplus
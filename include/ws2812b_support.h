@@ -4,6 +4,10 @@
  * Comments in English only; line width <= 128.
  */
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -14,4 +18,86 @@ void ws2812b_led_init(void);
 } /* extern "C" */
 #endif
 
+/* Refresh timing counters accumulated since the strip was created. */
+typedef struct
+{
+  const char* backend;      /* "rmt", "spi-dma" or "mixed" */
+  uint32_t outputs;         /* strips driven in parallel */
+  uint32_t frames;          /* frames sent to the strip */
+  uint32_t skipped;         /* frames identical to the previous one, not re-sent */
+  uint32_t cpu_us_last;     /* pixel push + refresh kick, i.e. time the LED task is busy */
+  uint32_t cpu_us_avg;
+  uint32_t wait_us_last;    /* time blocked waiting for the previous transmission */
+  uint32_t wait_us_max;
+  uint32_t power_budget_ma; /* strip current budget enforced by the limiter */
+  uint32_t power_ma_last;   /* estimated strip current of the last frame, after limiting */
+  uint32_t power_ma_avg;
+  uint32_t power_ma_peak;
+  uint32_t power_req_peak_ma; /* highest estimate before limiting */
+  uint32_t power_limited;     /* frames scaled down to fit the budget */
+  uint32_t flash_deferred;    /* frames put off to the next tick while a flash write held the strip */
+  uint32_t flash_skipped;     /* frame periods given up to erases longer than a gap between frames */
+  bool idle;                  /* frame timer slowed, light sleep allowed (see led_idle.h) */
+  uint32_t idle_entries;
+  uint32_t idle_ms;           /* total time spent idle */
+} ws2812b_stats_t;
+
+void ws2812b_get_stats(ws2812b_stats_t* out);
+void ws2812b_set_power_budget_ma(uint32_t budget_ma);
+
+/* Motion-to-light latency (PIR ISR edge -> refresh of the first frame showing it done) and LED task
+ * frame pacing, accumulated since boot or the last reset. Percentiles are histogram bucket bounds
+ * (within 12.5 %). */
+typedef struct
+{
+  uint32_t motion_samples;   /* motion onsets traced to the strip */
+  uint32_t motion_unchanged; /* onsets whose frame changed nothing (already lit, daylight, streaming) */
+  uint32_t motion_p50_us;
+  uint32_t motion_p95_us;
+  uint32_t motion_max_us;
+  uint32_t motion_avg_us;
+  uint32_t frame_us;         /* nominal frame period */
+  uint32_t interval_p50_us;  /* time between LED task frame starts */
+  uint32_t interval_p95_us;
+  uint32_t interval_max_us;
+  uint32_t jitter_us_avg;    /* mean |interval - frame_us| */
+  uint32_t missed_deadlines; /* frames started more than half a period late */
+} ws2812b_latency_t;
+
+void ws2812b_get_latency(ws2812b_latency_t* out);
+void ws2812b_reset_latency(void);
+
+/* Strip zones (one per closet segment) and their lighting effect, see led_effects.h. */
+int ws2812b_zone_count(void);
+const char* ws2812b_zone_effect(int zone);
+bool ws2812b_set_zone_effect(int zone, const char* effect);
+
+/* Realtime pixel streaming (see led_stream_udp.cpp). Receivers write packed perceptual RGB levels
+ * into the stream back buffer and commit it as a frame. The strip follows the stream while commits
+ * keep coming and falls back to the zones after LED_STREAM_TIMEOUT_MS without one. */
+uint8_t* ws2812b_stream_buffer(size_t* size);
+void ws2812b_stream_commit(void);
+bool ws2812b_stream_active(void);
+
+/* Flash writers (OTA) and the strip take turns: with sync on, each transmission is waited for,
+ * a claim is only granted while none is in flight and the next frame is not due within est_us
+ * (longer operations only wait for the transmission to end, and the frame periods they cover
+ * count as skipped, not missed), and frames due during a claim are deferred. Flash operations
+ * then never stall the RMT refill in the middle of a frame.
+ * ws2812b_flash_wait_gap() blocks until the next transmission ends, at most one tick. */
+void ws2812b_set_flash_sync(bool on);
+bool ws2812b_flash_claim(uint32_t est_us);
+void ws2812b_flash_release(void);
+void ws2812b_flash_wait_gap(void);
+
+/* Leave the idle mode now (task context); PIR edges and stream frames do this by themselves. */
+void ws2812b_wake(void);
+
+/* Benchmark hook (bench.h): one frame as the LED task builds it (zone effects, power limit, gamma
+ * and dither) into scratch buffers, dark and with PIR sensor i in motion for bit i of motion_mask.
+ * Leaves the strip and its statistics alone. Returns a value derived from the frame. */
+uint32_t ws2812b_bench_frame(uint32_t t_ms, uint32_t motion_mask);
+
+void ws2812b_register_web_route_handlers();
+
 #endif /* WS2812B_SUPPORT_H */
@@ -0,0 +1,143 @@
+#include <esp_cpu.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "bench.h"
+#include "pir312_monitor.h"
+#include "ws2812b_support.h"
+
+// Keep the compiler from dropping the work of a case.
+static inline void clobber(const void* p)
+{
+  asm volatile("" : : "r"(p) : "memory");
+}
+
+static volatile uint32_t s_sink = 0;
+
+struct bench_case
+{
+  const char* name;
+  int batch; // calls per timed batch: enough to dwarf reading the counters
+  void (*fn)(uint32_t i);
+};
+
+// A task name / partition label with the characters that need escaping, as in /hw_details.
+static void case_json_escape(uint32_t i)
+{
+  static std::string out;
+  out.clear();
+  json_escape_append(out, (i & 1) ? "ws2812b_led_task" : "ota_1 \"spare\"\t\\ \x01 app");
+  clobber(out.data());
+}
+
+static void case_inspect_json(uint32_t i)
+{
+  const std::string j = build_inspect_json();
+  s_sink = s_sink + (uint32_t)j.size();
+}
+
+static void case_pir312_status(uint32_t i)
+{
+  char buf[256];
+  s_sink = s_sink + (uint32_t)pir312_format_status(buf, sizeof(buf));
+  clobber(buf);
+}
+
+// 5 ms per call as at the frame rate; sensors 1..4 take turns so motion_follow moves.
+static void case_led_frame(uint32_t i)
+{
+  s_sink = s_sink + ws2812b_bench_frame(i * 5, 1u << (1 + (i / 64) % 4));
+}
+
+static void case_pir_state(uint32_t i)
+{
+  uint32_t mask = 0;
+  for (int s = 0; s < pir312_count(); ++s)
+  {
+    mask |= pir312_get_state(s) ? (1u << s) : 0;
+  }
+  s_sink = s_sink + mask;
+}
+
+static const bench_case k_cases[] = {
+    {"json_escape", 16, case_json_escape},
+    {"inspect_json", 1, case_inspect_json},
+    {"pir312_status", 4, case_pir312_status},
+    {"led_frame", 4, case_led_frame},
+    {"pir_state", 16, case_pir_state},
+};
+
+struct bench_result
+{
+  uint32_t iterations;
+  uint64_t cycles;      // of the batches that stayed on one core
+  uint32_t cycle_calls; // calls in those batches
+  uint32_t cycles_min;  // per call, best batch
+  uint32_t migrated;    // batches that moved to the other core, no cycle count
+  int64_t us;
+};
+
+static bench_result run_case(const bench_case& c, int iterations)
+{
+  bench_result r = {};
+  r.cycles_min = UINT32_MAX;
+  const int64_t t0 = esp_timer_get_time();
+  const int64_t end = t0 + BENCH_CASE_BUDGET_MS * 1000LL;
+  while ((int)r.iterations < iterations && esp_timer_get_time() < end)
+  {
+    // The server task is not pinned and CCOUNT is per core: a batch that migrated is only timed.
+    const int core = esp_cpu_get_core_id();
+    const esp_cpu_cycle_count_t c0 = esp_cpu_get_cycle_count();
+    for (int b = 0; b < c.batch; ++b)
+    {
+      c.fn(r.iterations + (uint32_t)b);
+    }
+    const uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - c0); // 32-bit counter, batches are short
+    r.iterations += (uint32_t)c.batch;
+    if (esp_cpu_get_core_id() != core)
+    {
+      ++r.migrated;
+      continue;
+    }
+    r.cycles += cycles;
+    r.cycle_calls += (uint32_t)c.batch;
+    if (cycles / (uint32_t)c.batch < r.cycles_min)
+      r.cycles_min = cycles / (uint32_t)c.batch;
+  }
+  r.us = esp_timer_get_time() - t0;
+  return r;
+}
+
+size_t bench_run_json(const char* filter, int iterations, char* out, size_t size)
+{
+  int len = snprintf(out, size, "{\"context\":{\"target\":\"%s\",\"budget_ms\":%d,\"iterations\":%d},\"benchmarks\":[",
+                     CONFIG_IDF_TARGET, BENCH_CASE_BUDGET_MS, iterations);
+  bool first = true;
+  for (const bench_case& c : k_cases)
+  {
+    if (filter != NULL && filter[0] != '\0' && strstr(c.name, filter) == NULL)
+    {
+      continue;
+    }
+    const bench_result r = run_case(c, iterations);
+    const uint32_t n = (r.iterations > 0) ? r.iterations : 1;
+    const uint32_t cn = (r.cycle_calls > 0) ? r.cycle_calls : 1;
+    if (len > 0 && len < (int)size)
+    {
+      len += snprintf(out + len, size - (size_t)len,
+                      "%s{\"name\":\"%s\",\"iterations\":%u,\"real_time\":%.1f,\"time_unit\":\"ns\",\"cycles\":%u,\"cycles_min\":%u,"
+                      "\"migrated\":%u}",
+                      first ? "" : ",", c.name, (unsigned)r.iterations, (double)r.us * 1000.0 / n, (unsigned)(r.cycles / cn),
+                      (unsigned)((r.cycle_calls > 0) ? r.cycles_min : 0), (unsigned)r.migrated);
+    }
+    first = false;
+  }
+  if (len > 0 && len < (int)size)
+  {
+    len += snprintf(out + len, size - (size_t)len, "]}");
+  }
+  return (len < 0) ? 0 : ((size_t)len < size ? (size_t)len : size - 1);
+}
@@ -0,0 +1,59 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+#include "boot_timeline.h"
+
+static const char* TAG = "boot";
+
+static boot_checkpoint_t s_marks[BOOT_TIMELINE_MAX];
+static int s_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+extern "C" void boot_mark(const char* name)
+{
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&s_lock);
+  if (s_count < BOOT_TIMELINE_MAX)
+  {
+    s_marks[s_count].name = name;
+    s_marks[s_count].us = now_us;
+    ++s_count;
+  }
+  portEXIT_CRITICAL(&s_lock);
+}
+
+extern "C" int boot_timeline_get(boot_checkpoint_t* out, int max)
+{
+  portENTER_CRITICAL(&s_lock);
+  const int n = (s_count < max) ? s_count : max;
+  memcpy(out, s_marks, (size_t)n * sizeof(*out));
+  portEXIT_CRITICAL(&s_lock);
+  return n;
+}
+
+extern "C" int64_t boot_timeline_find(const char* name)
+{
+  boot_checkpoint_t marks[BOOT_TIMELINE_MAX];
+  const int n = boot_timeline_get(marks, BOOT_TIMELINE_MAX);
+  for (int i = 0; i < n; ++i)
+  {
+    if (strcmp(marks[i].name, name) == 0)
+    {
+      return marks[i].us;
+    }
+  }
+  return -1;
+}
+
+extern "C" void boot_timeline_dump(void)
+{
+  boot_checkpoint_t marks[BOOT_TIMELINE_MAX];
+  const int n = boot_timeline_get(marks, BOOT_TIMELINE_MAX);
+  for (int i = 0; i < n; ++i)
+  {
+    const int64_t step_us = (i > 0) ? marks[i].us - marks[i - 1].us : marks[i].us;
+    ESP_LOGI(TAG, "%8.1f ms  (+%7.1f)  %s", marks[i].us / 1000.0, step_us / 1000.0, marks[i].name);
+  }
+}
@@ -0,0 +1,236 @@
+#include <errno.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <lwip/sockets.h>
+#include <string.h>
+
+#include "led_stream.h"
+#include "led_stream_proto.h"
+#include "utils.h"
+#include "ws2812b_support.h"
+
+static const char* TAG = "led_stream";
+
+// First E1.31 universe of the strip; following universes continue at 170 pixels each.
+#ifndef LED_STREAM_E131_UNIVERSE
+#define LED_STREAM_E131_UNIVERSE 1
+#endif
+
+// select() timeout, only used to notice the end of a stream for the log.
+#define LED_STREAM_IDLE_MS 1000
+
+static TaskHandle_t s_task = NULL;
+static int s_sock_ddp = -1;
+static int s_sock_e131 = -1;
+static uint8_t s_ddp_seq = 0;
+static uint32_t s_e131_top = 0;  // highest universe seen since the stream started
+static uint32_t s_e131_sync = 0; // sync universe announced by the last data packet
+static led_stream_activity_hook_t s_activity_hook = NULL;
+
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_stat_packets = 0;
+static uint32_t s_stat_frames = 0;
+static uint32_t s_stat_dropped = 0;
+static uint32_t s_stat_seq_gaps = 0;
+
+static int open_udp(uint16_t port)
+{
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+  if (sock < 0)
+  {
+    ESP_LOGE(TAG, "socket() failed: errno %d", errno);
+    return -1;
+  }
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+  {
+    ESP_LOGE(TAG, "bind(%u) failed: errno %d", (unsigned)port, errno);
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+static void count_ddp_seq(uint8_t seq)
+{
+  // 1..15 wrap around, 0 means the sender does not number its packets.
+  if (seq != 0 && s_ddp_seq != 0 && seq != (s_ddp_seq % 15) + 1)
+  {
+    portENTER_CRITICAL(&s_stats_lock);
+    ++s_stat_seq_gaps;
+    portEXIT_CRITICAL(&s_stats_lock);
+  }
+  s_ddp_seq = seq;
+}
+
+static void accept_packet(bool push)
+{
+  const led_stream_activity_hook_t hook = s_activity_hook;
+  if (hook != NULL)
+  {
+    hook();
+  }
+  if (push)
+  {
+    ws2812b_stream_commit();
+  }
+  portENTER_CRITICAL(&s_stats_lock);
+  ++s_stat_packets;
+  if (push)
+    ++s_stat_frames;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/* E1.31 senders announce no frame length. A frame is complete at the end of the strip, on the
+ * highest universe the sender uses (learned again after a timeout, in case it sends fewer) or,
+ * if the data packets name a sync universe, on the sync packet for it. */
+static bool e131_frame_done(const led_stream::packet_info& info)
+{
+  if (!ws2812b_stream_active())
+  {
+    s_e131_top = 0;
+  }
+  s_e131_top = (info.universe > s_e131_top) ? info.universe : s_e131_top;
+  s_e131_sync = info.sync_universe;
+  return s_e131_sync == 0 && (info.push || info.universe == s_e131_top);
+}
+
+/* Read one datagram. The header is peeked first to learn where the pixels belong; the datagram
+ * is then received with the payload scattered directly into the stream back buffer, so the
+ * only copy is the one out of the network stack. */
+static void receive_one(int sock, bool ddp)
+{
+  uint8_t hdr[led_stream::k_e131_header_len];
+  const int peeked = recv(sock, hdr, sizeof(hdr), MSG_PEEK);
+  if (peeked < 0)
+  {
+    return;
+  }
+
+  size_t size = 0;
+  uint8_t* pixels = ws2812b_stream_buffer(&size);
+  if (!ddp && s_e131_sync != 0 && led_stream::parse_e131_sync(hdr, (size_t)peeked) == s_e131_sync)
+  {
+    recv(sock, hdr, 1, 0); // a sync packet carries no pixels
+    accept_packet(true);
+    return;
+  }
+  led_stream::packet_info info =
+      ddp ? led_stream::parse_ddp(hdr, (size_t)peeked) : led_stream::parse_e131(hdr, (size_t)peeked, LED_STREAM_E131_UNIVERSE, size);
+  if (!info.valid || info.offset >= size)
+  {
+    recv(sock, hdr, 1, 0); // discard the datagram
+    portENTER_CRITICAL(&s_stats_lock);
+    ++s_stat_dropped;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return;
+  }
+
+  struct iovec iov[2];
+  iov[0].iov_base = hdr;
+  iov[0].iov_len = info.header_len;
+  iov[1].iov_base = pixels + info.offset;
+  iov[1].iov_len = (info.length < size - info.offset) ? info.length : size - info.offset;
+  struct msghdr msg = {};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+  if (recvmsg(sock, &msg, 0) < 0)
+  {
+    return;
+  }
+
+  if (ddp)
+  {
+    count_ddp_seq(hdr[1] & 0x0F);
+  }
+  else
+  {
+    info.push = e131_frame_done(info);
+  }
+  accept_packet(info.push);
+}
+
+static void led_stream_task(void* arg)
+{
+  bool was_active = false;
+  for (;;)
+  {
+    fd_set fds;
+    FD_ZERO(&fds);
+    int max_fd = -1;
+    if (s_sock_ddp >= 0)
+    {
+      FD_SET(s_sock_ddp, &fds);
+      max_fd = s_sock_ddp;
+    }
+    if (s_sock_e131 >= 0)
+    {
+      FD_SET(s_sock_e131, &fds);
+      max_fd = (s_sock_e131 > max_fd) ? s_sock_e131 : max_fd;
+    }
+    struct timeval tv = {};
+    tv.tv_sec = LED_STREAM_IDLE_MS / 1000;
+    tv.tv_usec = (LED_STREAM_IDLE_MS % 1000) * 1000;
+
+    const int ready = select(max_fd + 1, &fds, NULL, NULL, &tv);
+    if (ready > 0 && s_sock_ddp >= 0 && FD_ISSET(s_sock_ddp, &fds))
+    {
+      receive_one(s_sock_ddp, true);
+    }
+    if (ready > 0 && s_sock_e131 >= 0 && FD_ISSET(s_sock_e131, &fds))
+    {
+      receive_one(s_sock_e131, false);
+    }
+
+    const bool active = ws2812b_stream_active();
+    if (active != was_active)
+    {
+      ESP_LOGI(TAG, "%s", active ? "Stream started" : "Stream timed out, back to sensors");
+      was_active = active;
+    }
+  }
+}
+
+void led_stream_start(void)
+{
+  if (s_task)
+  {
+    return;
+  }
+  s_sock_ddp = open_udp(led_stream::k_ddp_port);
+  s_sock_e131 = open_udp(led_stream::k_e131_port);
+  if (s_sock_ddp < 0 && s_sock_e131 < 0)
+  {
+    return;
+  }
+  CHECK_XTASK_OK(xTaskCreatePinnedToCore(led_stream_task, "led_stream_task", 3072, NULL, 5, &s_task, 0));
+  ESP_LOGI(TAG,
+           "Listening for DDP on %u, E1.31 on %u (universe %d)",
+           (unsigned)led_stream::k_ddp_port,
+           (unsigned)led_stream::k_e131_port,
+           LED_STREAM_E131_UNIVERSE);
+}
+
+void led_stream_set_activity_hook(led_stream_activity_hook_t hook)
+{
+  s_activity_hook = hook;
+}
+
+void led_stream_get_stats(led_stream_stats_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  out->active = ws2812b_stream_active();
+  portENTER_CRITICAL(&s_stats_lock);
+  out->packets = s_stat_packets;
+  out->frames = s_stat_frames;
+  out->dropped = s_stat_dropped;
+  out->seq_gaps = s_stat_seq_gaps;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
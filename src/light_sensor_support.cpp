@@ -1,12 +1,14 @@
 #include <esp_adc/adc_oneshot.h>
 
 #include "light_sensor_support.h"
+#include "metrics.h"
 #include "utils.h"
 
 static const char* TAG = "Light Sensor";
 static const int light_threshold = 2000; // limits are: 900 with light, 4095 with dark
 static const adc_channel_t channel = ADC_CHANNEL_6;
 static adc_oneshot_unit_handle_t handle = nullptr;
+static metric_t s_m_raw = nullptr; // last averaged reading, published by every read
 
 void light_sensor_init()
 {
@@ -26,6 +28,7 @@ void light_sensor_init()
   chan_cfg.atten = ADC_ATTEN_DB_12;
 
   CHECK_ERR(adc_oneshot_config_channel(handle, channel, &chan_cfg));
+  s_m_raw = metrics_gauge("light.raw", 200);
 
   ESP_LOGI(TAG, "Initialization done.");
 }
@@ -52,6 +55,7 @@ static inline int read_sensor()
       --avg_iter;
     }
     result = good_count ? avg_sum / good_count : 0;
+    metrics_set(s_m_raw, result);
   }
 
   return result;
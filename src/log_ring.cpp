@@ -0,0 +1,191 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log_ring.h"
+#include "metrics.h"
+#include "utils.h"
+
+static const char* TAG = "log_ring";
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+// A slot is owned by whoever claimed its sequence number. The writer clears `seq` (busy), fills the
+// line and then stores the sequence number; readers copy the line and check that `seq` did not
+// change meanwhile (seqlock), so neither side ever blocks.
+struct log_slot
+{
+  volatile uint32_t seq;
+  log_ring_line_t line;
+};
+
+static log_slot s_slots[LOG_RING_SLOTS];
+static volatile uint32_t s_next = 1;
+static vprintf_like_t s_uart_vprintf = NULL; // esp_log's previous output (UART via stdout)
+static TaskHandle_t s_uart_task = NULL;
+static volatile bool s_sync = false;
+static uint32_t s_uart_dropped = 0;
+static metric_t s_m_ring_us = NULL; // time spent in the hook per line, ring mode
+static metric_t s_m_sync_us = NULL; // same with the UART write in the calling task
+static metric_t s_m_lines = NULL;
+
+/* esp_log prefix: optional color escape, then the level letter ("I (1234) tag: ..."). */
+static char line_level(const char* text)
+{
+  if (text[0] == '\033')
+  {
+    const char* m = strchr(text, 'm');
+    text = (m != NULL) ? m + 1 : text;
+  }
+  return (log_ring_level_rank(text[0]) > 0 && text[1] == ' ') ? text[0] : '?';
+}
+
+static int ring_vprintf(const char* fmt, va_list ap)
+{
+  const int64_t t0 = esp_timer_get_time();
+  if (s_sync)
+  {
+    const int n = s_uart_vprintf(fmt, ap);
+    metrics_record(s_m_sync_us, (uint32_t)(esp_timer_get_time() - t0));
+    return n;
+  }
+
+  const uint32_t seq = __atomic_fetch_add(&s_next, 1, __ATOMIC_RELAXED);
+  log_slot& slot = s_slots[seq & (LOG_RING_SLOTS - 1)];
+  __atomic_store_n(&slot.seq, 0, __ATOMIC_RELEASE);
+  __atomic_thread_fence(__ATOMIC_RELEASE); // readers see the slot busy before any of the new text
+  const int n = vsnprintf(slot.line.text, sizeof(slot.line.text), fmt, ap);
+  size_t len = (n > 0) ? (size_t)n : 0;
+  if (len >= sizeof(slot.line.text))
+  {
+    len = sizeof(slot.line.text) - 1;
+    slot.line.text[len - 1] = '\n'; // cut lines still end the line on the UART
+  }
+  slot.line.len = (uint16_t)len;
+  slot.line.level = line_level(slot.line.text);
+  slot.line.seq = seq;
+  __atomic_store_n(&slot.seq, seq, __ATOMIC_RELEASE);
+
+  if (s_uart_task != NULL && !xPortInIsrContext())
+  {
+    xTaskNotifyGive(s_uart_task);
+  }
+  metrics_add(s_m_lines, 1);
+  metrics_record(s_m_ring_us, (uint32_t)(esp_timer_get_time() - t0));
+  return n;
+}
+
+extern "C" bool log_ring_read(uint32_t* from, log_ring_line_t* out)
+{
+  const uint32_t next = __atomic_load_n(&s_next, __ATOMIC_ACQUIRE);
+  uint32_t want = (*from > 0) ? *from : 1;
+  if (want > next || (next - want > LOG_RING_SLOTS && want < next))
+  {
+    // Older lines are gone; a position past the newest one comes from before a restart, so the
+    // reader starts over at the oldest buffered line and sees *from go down.
+    want = (next > LOG_RING_SLOTS) ? next - LOG_RING_SLOTS : 1;
+  }
+  for (; want < next; ++want)
+  {
+    const log_slot& slot = s_slots[want & (LOG_RING_SLOTS - 1)];
+    const uint32_t before = __atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE);
+    if (before != want)
+    {
+      if (before == 0 || before < want)
+      {
+        break; // claimed but not written yet
+      }
+      continue; // overwritten by a newer line
+    }
+    memcpy(out, (const void*)&slot.line, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE); // the copy is complete before seq is checked again
+    if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != want)
+    {
+      continue; // overwritten while copying
+    }
+    *from = want + 1;
+    return true;
+  }
+  *from = want;
+  return false;
+}
+
+extern "C" uint32_t log_ring_next_seq(void)
+{
+  return __atomic_load_n(&s_next, __ATOMIC_ACQUIRE);
+}
+
+extern "C" int log_ring_level_rank(char level)
+{
+  switch (level)
+  {
+  case 'E':
+    return 1;
+  case 'W':
+    return 2;
+  case 'I':
+    return 3;
+  case 'D':
+    return 4;
+  case 'V':
+    return 5;
+  default:
+    return 0;
+  }
+}
+
+/* Lowest priority: copies new lines to the UART whenever nothing else wants the CPU. */
+static void uart_task(void* arg)
+{
+  uint32_t from = 1;
+  log_ring_line_t line;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint32_t expected = from;
+    while (log_ring_read(&from, &line))
+    {
+      if (line.seq != expected)
+      {
+        // A burst outran the UART: say so instead of silently skipping.
+        s_uart_dropped += line.seq - expected;
+        printf("... %u log lines dropped\n", (unsigned)(line.seq - expected));
+      }
+      expected = line.seq + 1;
+      fwrite(line.text, 1, line.len, stdout);
+    }
+    fflush(stdout);
+  }
+}
+
+extern "C" void log_ring_init(void)
+{
+  if (s_uart_vprintf != NULL)
+  {
+    return;
+  }
+  s_m_ring_us = metrics_histogram("log.ring_us");
+  s_m_sync_us = metrics_histogram("log.sync_us");
+  s_m_lines = metrics_counter("log.lines");
+  CHECK_XTASK_OK(xTaskCreatePinnedToCore(uart_task, "log_uart", 3072, NULL, 1, &s_uart_task, 0));
+  s_uart_vprintf = esp_log_set_vprintf(ring_vprintf);
+}
+
+extern "C" void log_ring_set_sync(bool sync)
+{
+  s_sync = sync;
+}
+
+extern "C" bool log_ring_sync(void)
+{
+  return s_sync;
+}
+
+extern "C" uint32_t log_ring_uart_dropped(void)
+{
+  return s_uart_dropped;
+}
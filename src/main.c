@@ -4,9 +4,16 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <wifi_provisioning/manager.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
 
+#include "boot_timeline.h"
+#include "led_stream.h"
 #include "light_sensor_support.h"
+#include "log_ring.h"
 #include "mdns_support.h"
+#include "metrics.h"
 #include "pir312_monitor.h"
 #include "utils.h"
 #include "web_server.h"
@@ -16,6 +23,32 @@
 static const char* TAG = "main";
 static bool s_services_started = false;
 
+/* 1: peripheral init runs on core 1 while app_main brings up Wi-Fi on core 0.
+ * 0: the old serial order, for comparing the boot timeline. */
+#ifndef BOOT_PARALLEL_INIT
+#define BOOT_PARALLEL_INIT 1
+#endif
+
+static portMUX_TYPE s_start_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_periph_ready = false;
+static bool s_ip_ready = false;
+
+/* Dynamic frequency scaling with automatic light sleep. The LED task holds the CPU at full speed
+ * while anything is lit or moving and releases it in its idle mode, so the chip only sleeps while
+ * the strip is dark; the PIR pins and the Wi-Fi DTIM beacon wake it. */
+static void configure_power_management(void)
+{
+#if CONFIG_PM_ENABLE
+  const esp_pm_config_t pm = {
+      .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+      .min_freq_mhz = 80,
+      .light_sleep_enable = true,
+  };
+  CHECK_ERR(esp_pm_configure(&pm));
+  ESP_LOGI(TAG, "INIT: power management %d/%d MHz, light sleep", pm.max_freq_mhz, pm.min_freq_mhz);
+#endif
+}
+
 #if CONFIG_BT_ENABLED
 extern "C" void btStop(void);
 static void stop_bt_if_present()
@@ -30,48 +63,100 @@ static void stop_bt_if_present()
 }
 #endif
 
+/* Network services need both an IP and initialized peripherals; whichever comes last starts them. */
+static void start_services_when_ready(bool periph_ready, bool ip_ready)
+{
+  portENTER_CRITICAL(&s_start_lock);
+  s_periph_ready = s_periph_ready || periph_ready;
+  s_ip_ready = s_ip_ready || ip_ready;
+  const bool start = s_periph_ready && s_ip_ready && !s_services_started;
+  s_services_started = s_services_started || start;
+  portEXIT_CRITICAL(&s_start_lock);
+  if (!start)
+  {
+    return;
+  }
+
+  wifi_prov_mgr_deinit();
+  mdns_start(wifi_get_hostname(), "ESP32 Device");
+  boot_mark("mdns_started");
+  if (!web_is_running())
+  {
+    web_start();
+  }
+  boot_mark("web_ready");
+  led_stream_set_activity_hook(wifi_power_activity);
+  led_stream_start();
+  boot_mark("services_ready");
+  boot_timeline_dump();
+}
+
 static void async_wifi_handler(void* arg, esp_event_base_t base, int32_t id, void* data)
 {
-  if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP && !s_services_started)
+  if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP)
   {
-    wifi_prov_mgr_deinit();
-    mdns_start(wifi_get_hostname(), "ESP32 Device");
-    if (!web_is_running())
-    {
-      web_start();
-    }
-    s_services_started = true;
+    start_services_when_ready(false, true);
   }
 }
 
+/* Sensors before the LEDs: the LED task samples them from its first frame. */
+static void init_peripherals(void)
+{
+  pir312_init();
+  boot_mark("pir_init");
+  light_sensor_init();
+  boot_mark("light_init");
+  ws2812b_led_init();
+  boot_mark("led_init");
+  start_services_when_ready(true, false);
+}
+
+#if BOOT_PARALLEL_INIT
+static void periph_init_task(void* arg)
+{
+  init_peripherals();
+  vTaskDelete(NULL);
+}
+#endif
+
+/* Once a second: log what changed in the metrics registry (a full line every METRICS_LOG_INTERVAL_S)
+ * and re-announce changed mDNS TXT items. Values come from the registry, so no sensor is read here. */
 static void connect_monitor_task(void* arg)
 {
+  metric_t web_running = metrics_gauge("web.running", 0);
   for (;;)
   {
-    bool wifi = wifi_is_connected();
-    bool web = web_is_running();
-
-    ESP_LOGI("main", "Status: wifi=%d, web=%d", wifi, web);
-    pir312_dump_status();
-    light_sensor_dump();
+    metrics_set(web_running, web_is_running() ? 1 : 0);
+    metrics_log_changes();
+    mdns_update_txt();
     vTaskDelay(pdMS_TO_TICKS(1000));
   }
 }
 
 void app_main(void)
 {
+  boot_mark("app_main");
+  log_ring_init(); // from here on logging tasks do not wait for the UART
   esp_log_level_set("*", ESP_LOG_INFO);
   ESP_LOGI(TAG, "INIT: app_main starting");
+  configure_power_management();
 
-  pir312_init();
-  light_sensor_init();
-  ws2812b_led_init();
-  wifi_start();
-  stop_bt_if_present();
-
+  /* Registered before Wi-Fi starts so an early IP (fast reconnect) is not missed. */
+  CHECK_ERR(esp_event_loop_create_default());
   CHECK_ERR(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &async_wifi_handler, NULL));
   ESP_LOGI(TAG, "INIT: Event handlers done");
 
+#if BOOT_PARALLEL_INIT
+  /* Peripherals on core 1 (the LED task core), so first light does not wait for the Wi-Fi driver. */
+  CHECK_XTASK_OK(xTaskCreatePinnedToCore(periph_init_task, "periph_init", 4096, NULL, 5, NULL, 1));
+  wifi_start();
+#else
+  init_peripherals();
+  wifi_start();
+#endif
+  boot_mark("wifi_started");
+  stop_bt_if_present();
+
   CHECK_XTASK_OK(xTaskCreatePinnedToCore(connect_monitor_task, "monitor_task", 4096, NULL, 5, NULL, 0));
 
   ESP_LOGI(TAG, "exit.");
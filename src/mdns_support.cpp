@@ -1,12 +1,57 @@
+#include <esp_app_desc.h>
 #include <esp_log.h>
 #include <mdns.h>
+#include <stdio.h>
+#include <string.h>
 
+#include "led_stream_proto.h"
 #include "mdns_support.h"
+#include "metrics.h"
+#include "pir312_monitor.h"
 #include "utils.h" // for CHECK_ERR
+#include "ws2812b_support.h"
 
 static const char* TAG = "mdns_support";
 static bool s_mdns_running = false;
 
+// Telemetry service: same web server, TXT items carry live state so a browser sees changes
+// without polling /hw_details.
+#define MDNS_TELEMETRY_TYPE "_telemetry"
+
+struct live_item
+{
+  const char* key;
+  char value[16]; // last value announced
+};
+
+static live_item s_live[] = {
+    {"led", ""},    // active, idle or stream
+    {"motion", ""}, // sensors currently seeing motion
+    {"light", ""},  // day or dark
+};
+static constexpr int LIVE_COUNT = sizeof(s_live) / sizeof(s_live[0]);
+
+/* Live values come from the metrics registry (published by the LED task), so no sensor is read here. */
+static void live_value(int index, char* out, size_t size)
+{
+  int32_t v = 0;
+  switch (index)
+  {
+  case 0:
+    metrics_value("led.idle", &v);
+    snprintf(out, size, "%s", ws2812b_stream_active() ? "stream" : (v ? "idle" : "active"));
+    break;
+  case 1:
+    metrics_value("pir.motion", &v);
+    snprintf(out, size, "%d", __builtin_popcount((uint32_t)v));
+    break;
+  default:
+    metrics_value("led.dark", &v);
+    snprintf(out, size, "%s", v ? "dark" : "day");
+    break;
+  }
+}
+
 int mdns_start(const char* hostname, const char* instance)
 {
   if (s_mdns_running)
@@ -20,7 +65,6 @@ int mdns_start(const char* hostname, const char* instance)
     ESP_LOGE(TAG, "mdns_init failed: %s (%d)", esp_err_to_name(err), (int)err);
     return -1;
   }
-  s_mdns_running = true;
 
   if (hostname && *hostname)
   {
@@ -31,11 +75,74 @@ int mdns_start(const char* hostname, const char* instance)
     CHECK_ERR(mdns_instance_name_set(instance));
   }
 
-  CHECK_ERR(mdns_service_add(NULL, "_http", "_tcp", 80, NULL, 0));
-  ESP_LOGI(TAG, "mDNS started: host=%s.local, instance=%s", hostname, instance);
+  // Static metadata, so a fleet scan learns version and capabilities from the browse answer alone.
+  const esp_app_desc_t* app = esp_app_get_description();
+  char build[20];
+  snprintf(build, sizeof(build), "%02x%02x%02x%02x", app->app_elf_sha256[0], app->app_elf_sha256[1], app->app_elf_sha256[2],
+           app->app_elf_sha256[3]);
+  char pirs[8];
+  snprintf(pirs, sizeof(pirs), "%d", pir312_count());
+  size_t stream_size = 0;
+  ws2812b_stream_buffer(&stream_size);
+  char leds[8];
+  snprintf(leds, sizeof(leds), "%u", (unsigned)(stream_size / 3));
+  char zones[8];
+  snprintf(zones, sizeof(zones), "%d", ws2812b_zone_count());
+  char stream[32];
+  snprintf(stream, sizeof(stream), "ddp:%u,e131:%u", (unsigned)led_stream::k_ddp_port, (unsigned)led_stream::k_e131_port);
+  mdns_txt_item_t http_txt[] = {
+      {"fw", app->version},
+      {"build", build},
+      {"idf", app->idf_ver},
+      {"pirs", pirs},
+      {"leds", leds},
+      {"zones", zones},
+      {"info", "/hw_details"},
+      {"ota", "/update"},
+      {"led", "/led/stats"},
+      {"metrics", "/metrics"},
+      {"log", "/log"},
+      {"stream", stream},
+  };
+  CHECK_ERR(mdns_service_add(NULL, "_http", "_tcp", 80, http_txt, sizeof(http_txt) / sizeof(http_txt[0])));
+
+  mdns_txt_item_t live_txt[LIVE_COUNT + 1];
+  live_txt[0] = {"path", "/hw_details"};
+  for (int i = 0; i < LIVE_COUNT; ++i)
+  {
+    live_value(i, s_live[i].value, sizeof(s_live[i].value));
+    live_txt[i + 1] = {s_live[i].key, s_live[i].value};
+  }
+  CHECK_ERR(mdns_service_add(NULL, MDNS_TELEMETRY_TYPE, "_tcp", 80, live_txt, LIVE_COUNT + 1));
+  s_mdns_running = true; // after s_live is filled, mdns_update_txt() runs on the monitor task
+  ESP_LOGI(TAG, "mDNS started: host=%s.local, instance=%s, fw %s build %s", hostname, instance, app->version, build);
   return 0;
 }
 
+void mdns_update_txt(void)
+{
+  if (!s_mdns_running)
+  {
+    return;
+  }
+  for (int i = 0; i < LIVE_COUNT; ++i)
+  {
+    char value[sizeof(s_live[i].value)];
+    live_value(i, value, sizeof(value));
+    if (strcmp(value, s_live[i].value) != 0)
+    {
+      // Each set sends an unsolicited announcement, so only changes go out.
+      const esp_err_t err = mdns_service_txt_item_set(MDNS_TELEMETRY_TYPE, "_tcp", s_live[i].key, value);
+      if (err != ESP_OK)
+      {
+        ESP_LOGW(TAG, "TXT %s=%s: %s", s_live[i].key, value, esp_err_to_name(err));
+        continue;
+      }
+      strcpy(s_live[i].value, value);
+    }
+  }
+}
+
 void mdns_stop(void)
 {
   if (s_mdns_running)
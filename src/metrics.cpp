@@ -0,0 +1,255 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "latency_histogram.h"
+#include "log_ring.h"
+#include "metrics.h"
+
+static const char* TAG = "metrics";
+
+// Summary lines are split to fit a log ring slot with the esp_log prefix ("I (12345) metrics: ",
+// color codes and the newline, at most 40 bytes) in front of them.
+#define METRICS_LOG_LINE (LOG_RING_LINE - 40)
+
+enum metric_kind
+{
+  METRIC_COUNTER,
+  METRIC_GAUGE,
+  METRIC_HISTOGRAM,
+};
+
+typedef latency::log_histogram<3> metric_histogram;
+
+struct metric
+{
+  const char* name;
+  metric_kind kind;
+  uint32_t deadband;
+  volatile uint32_t value; // counter, gauge (as int32_t) or histogram sample count
+  uint32_t logged;         // value at the last log line
+  metric_histogram* hist;
+};
+
+static metric s_metrics[METRICS_MAX];
+static int s_count = 0;
+static metric_histogram s_hists[METRICS_HISTOGRAMS_MAX];
+static int s_hist_count = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED; // registration and histogram buckets
+static int64_t s_last_log_us = 0;
+
+static metric_t add_metric(const char* name, metric_kind kind, uint32_t deadband)
+{
+  metric_t m = NULL;
+  bool full = false;
+  portENTER_CRITICAL(&s_lock);
+  for (int i = 0; i < s_count && m == NULL; ++i)
+  {
+    if (strcmp(s_metrics[i].name, name) == 0)
+      m = &s_metrics[i];
+  }
+  if (m == NULL)
+  {
+    full = (s_count >= METRICS_MAX) || (kind == METRIC_HISTOGRAM && s_hist_count >= METRICS_HISTOGRAMS_MAX);
+    if (!full)
+    {
+      m = &s_metrics[s_count++];
+      m->name = name;
+      m->kind = kind;
+      m->deadband = deadband;
+      if (kind == METRIC_HISTOGRAM)
+        m->hist = &s_hists[s_hist_count++];
+    }
+  }
+  portEXIT_CRITICAL(&s_lock);
+  if (full)
+  {
+    ESP_LOGW(TAG, "registry full, %s not recorded", name);
+  }
+  return m;
+}
+
+extern "C" metric_t metrics_counter(const char* name)
+{
+  return add_metric(name, METRIC_COUNTER, 0);
+}
+
+extern "C" metric_t metrics_gauge(const char* name, uint32_t deadband)
+{
+  return add_metric(name, METRIC_GAUGE, deadband);
+}
+
+extern "C" metric_t metrics_histogram(const char* name)
+{
+  return add_metric(name, METRIC_HISTOGRAM, 0);
+}
+
+extern "C" void metrics_add(metric_t m, uint32_t n)
+{
+  if (m != NULL)
+  {
+    __atomic_fetch_add(&m->value, n, __ATOMIC_RELAXED);
+  }
+}
+
+extern "C" void metrics_set(metric_t m, int32_t v)
+{
+  if (m != NULL)
+  {
+    m->value = (uint32_t)v;
+  }
+}
+
+extern "C" void metrics_record(metric_t m, uint32_t v)
+{
+  if (m == NULL || m->hist == NULL)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&s_lock);
+  m->hist->record(v);
+  m->value = m->hist->total;
+  portEXIT_CRITICAL(&s_lock);
+}
+
+extern "C" bool metrics_value(const char* name, int32_t* out)
+{
+  const int n = s_count;
+  for (int i = 0; i < n; ++i)
+  {
+    if (strcmp(s_metrics[i].name, name) == 0)
+    {
+      *out = (int32_t)s_metrics[i].value;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct hist_summary
+{
+  uint32_t p50;
+  uint32_t p95;
+  uint32_t max;
+  uint32_t mean;
+};
+
+static hist_summary summarize(const metric& m)
+{
+  hist_summary s = {};
+  portENTER_CRITICAL(&s_lock);
+  s.p50 = m.hist->percentile(50);
+  s.p95 = m.hist->percentile(95);
+  s.max = m.hist->max;
+  s.mean = m.hist->mean();
+  portEXIT_CRITICAL(&s_lock);
+  return s;
+}
+
+extern "C" void metrics_log_changes(void)
+{
+  const int64_t now_us = esp_timer_get_time();
+  const int n = s_count;
+  bool moved = (now_us - s_last_log_us) >= METRICS_LOG_INTERVAL_S * 1000000LL;
+  uint32_t values[METRICS_MAX];
+  for (int i = 0; i < n; ++i)
+  {
+    const metric& m = s_metrics[i];
+    values[i] = m.value;
+    if (m.kind == METRIC_GAUGE)
+    {
+      const uint32_t step = (m.deadband > 0) ? m.deadband : 1;
+      moved = moved || (uint32_t)abs((int32_t)values[i] - (int32_t)m.logged) >= step;
+    }
+  }
+  if (!moved)
+  {
+    return;
+  }
+
+  char line[METRICS_LOG_LINE];
+  size_t len = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    metric& m = s_metrics[i];
+    const uint32_t v = values[i];
+    char item[64];
+    int item_len = 0;
+    if (m.kind == METRIC_GAUGE && v != m.logged)
+      item_len = snprintf(item, sizeof(item), " %s=%d", m.name, (int)(int32_t)v);
+    else if (m.kind == METRIC_COUNTER && v != m.logged)
+      item_len = snprintf(item, sizeof(item), " %s+%u", m.name, (unsigned)(v - m.logged));
+    else if (m.kind == METRIC_HISTOGRAM && v != m.logged)
+      item_len = snprintf(item, sizeof(item), " %s n+%u p95 %u", m.name, (unsigned)(v - m.logged), (unsigned)summarize(m).p95);
+    m.logged = v;
+    if (item_len <= 0)
+      continue;
+    if (len + (size_t)item_len >= sizeof(line))
+    {
+      ESP_LOGI(TAG, "%s", line);
+      len = 0;
+    }
+    len += (size_t)snprintf(line + len, sizeof(line) - len, "%s", item);
+  }
+  ESP_LOGI(TAG, "%s", (len > 0) ? line : " (no change)");
+  s_last_log_us = now_us;
+}
+
+/* snprintf at buf + *len, keeping *len within size - 1 when the output is cut. */
+static void append(char* buf, size_t size, size_t* len, const char* fmt, ...)
+{
+  if (*len + 1 >= size)
+  {
+    return;
+  }
+  va_list ap;
+  va_start(ap, fmt);
+  const int w = vsnprintf(buf + *len, size - *len, fmt, ap);
+  va_end(ap);
+  if (w > 0)
+  {
+    *len = (*len + (size_t)w < size) ? *len + (size_t)w : size - 1;
+  }
+}
+
+extern "C" size_t metrics_format_json(char* buf, size_t size)
+{
+  if (size == 0)
+  {
+    return 0;
+  }
+  buf[0] = '\0';
+  size_t len = 0;
+  append(buf, size, &len, "{\"uptime_ms\":%llu", (unsigned long long)(esp_timer_get_time() / 1000));
+  const int n = s_count;
+  static const char* const k_sections[] = {"counters", "gauges", "histograms"};
+  for (int kind = METRIC_COUNTER; kind <= METRIC_HISTOGRAM; ++kind)
+  {
+    append(buf, size, &len, ",\"%s\":{", k_sections[kind]);
+    const char* sep = "";
+    for (int i = 0; i < n; ++i)
+    {
+      const metric& m = s_metrics[i];
+      if (m.kind != kind)
+        continue;
+      if (kind == METRIC_COUNTER)
+        append(buf, size, &len, "%s\"%s\":%u", sep, m.name, (unsigned)m.value);
+      else if (kind == METRIC_GAUGE)
+        append(buf, size, &len, "%s\"%s\":%d", sep, m.name, (int)(int32_t)m.value);
+      else
+      {
+        const hist_summary h = summarize(m);
+        append(buf, size, &len, "%s\"%s\":{\"count\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u,\"mean\":%u}", sep, m.name,
+               (unsigned)m.value, (unsigned)h.p50, (unsigned)h.p95, (unsigned)h.max, (unsigned)h.mean);
+      }
+      sep = ",";
+    }
+    append(buf, size, &len, "}");
+  }
+  append(buf, size, &len, "}");
+  return len;
+}
@@ -0,0 +1,227 @@
+#include <esp_app_desc.h>
+#include <esp_log.h>
+#include <string.h>
+
+#include "ota_delta.h"
+#include "ota_field.h"
+
+static const char* TAG = "ota_delta";
+
+#define DELTA_OP_COPY 0x01
+#define DELTA_OP_DIFF 0x02
+#define DELTA_OP_DATA 0x03
+#define DELTA_HEADER_LEN 40
+
+enum delta_state
+{
+  DELTA_HEADER,
+  DELTA_OP,
+  DELTA_ARGS,
+  DELTA_DIFF_BYTES,
+  DELTA_DATA_BYTES,
+  DELTA_DONE,
+  DELTA_ERROR,
+};
+
+static const esp_partition_t* s_base = NULL;
+static delta_state s_state = DELTA_HEADER;
+static ota_field::buffer<DELTA_HEADER_LEN> s_field = {};
+static uint8_t s_op = 0;
+static uint32_t s_src = 0;
+static uint32_t s_left = 0; // bytes left in the current op
+static uint32_t s_new_size = 0;
+static uint32_t s_out = 0;
+static uint8_t s_scratch[512]; // base bytes read from flash
+static ota_delta_stats_t s_stats;
+
+static esp_err_t emit(const uint8_t* data, size_t len, ota_delta_sink_t sink)
+{
+  s_out += len;
+  return sink(data, len) ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t read_base(uint32_t src, size_t len)
+{
+  const esp_err_t err = esp_partition_read(s_base, src, s_scratch, len);
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "base read at %u failed: %s", (unsigned)src, esp_err_to_name(err));
+  }
+  return err;
+}
+
+static esp_err_t run_copy(ota_delta_sink_t sink)
+{
+  while (s_left > 0)
+  {
+    const size_t n = (s_left < sizeof(s_scratch)) ? s_left : sizeof(s_scratch);
+    esp_err_t err = read_base(s_src, n);
+    if (err == ESP_OK)
+    {
+      err = emit(s_scratch, n, sink);
+    }
+    if (err != ESP_OK)
+    {
+      return err;
+    }
+    s_src += n;
+    s_left -= n;
+  }
+  return ESP_OK;
+}
+
+/* Validate an op's arguments and set up its state. */
+static esp_err_t start_op(ota_delta_sink_t sink)
+{
+  const bool has_src = (s_op != DELTA_OP_DATA);
+  s_src = has_src ? ota_field::le32(s_field.data) : 0;
+  s_left = ota_field::le32(s_field.data + (has_src ? 4 : 0));
+  s_field.len = 0;
+
+  if (s_left > s_new_size - s_out || (has_src && (s_src > s_base->size || s_left > s_base->size - s_src)))
+  {
+    ESP_LOGE(TAG, "op %d out of range: src %u len %u at %u", s_op, (unsigned)s_src, (unsigned)s_left, (unsigned)s_out);
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+  switch (s_op)
+  {
+  case DELTA_OP_COPY:
+    s_stats.copy_bytes += s_left;
+    s_state = DELTA_OP;
+    return run_copy(sink);
+  case DELTA_OP_DIFF:
+    s_stats.diff_bytes += s_left;
+    s_state = DELTA_DIFF_BYTES;
+    return ESP_OK;
+  default:
+    s_stats.data_bytes += s_left;
+    s_state = DELTA_DATA_BYTES;
+    return ESP_OK;
+  }
+}
+
+esp_err_t ota_delta_begin(const esp_partition_t* base)
+{
+  if (base == NULL)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  s_base = base;
+  s_state = DELTA_HEADER;
+  s_field.len = 0;
+  s_new_size = 0;
+  s_out = 0;
+  memset(&s_stats, 0, sizeof(s_stats));
+  return ESP_OK;
+}
+
+static esp_err_t step(const uint8_t** in, size_t* len, ota_delta_sink_t sink)
+{
+  switch (s_state)
+  {
+  case DELTA_HEADER:
+    if (s_field.collect(in, len, DELTA_HEADER_LEN))
+    {
+      if (memcmp(s_field.data, "OTAD", 4) != 0)
+      {
+        ESP_LOGE(TAG, "not a delta patch");
+        return ESP_ERR_INVALID_RESPONSE;
+      }
+      if (memcmp(s_field.data + 8, esp_app_get_description()->app_elf_sha256, 32) != 0)
+      {
+        ESP_LOGE(TAG, "patch was made for another base firmware");
+        return ESP_ERR_INVALID_VERSION;
+      }
+      s_new_size = ota_field::le32(s_field.data + 4);
+      s_field.len = 0;
+      s_state = (s_new_size > 0) ? DELTA_OP : DELTA_DONE;
+    }
+    return ESP_OK;
+  case DELTA_OP:
+    s_op = **in;
+    *in += 1;
+    *len -= 1;
+    if (s_op < DELTA_OP_COPY || s_op > DELTA_OP_DATA)
+    {
+      ESP_LOGE(TAG, "bad op 0x%02x at %u", s_op, (unsigned)s_out);
+      return ESP_ERR_INVALID_RESPONSE;
+    }
+    s_state = DELTA_ARGS;
+    return ESP_OK;
+  case DELTA_ARGS:
+    if (s_field.collect(in, len, (s_op == DELTA_OP_DATA) ? 4 : 8))
+    {
+      return start_op(sink);
+    }
+    return ESP_OK;
+  case DELTA_DIFF_BYTES:
+  case DELTA_DATA_BYTES:
+  {
+    size_t n = (s_left < *len) ? s_left : *len;
+    esp_err_t err = ESP_OK;
+    if (s_state == DELTA_DATA_BYTES)
+    {
+      err = emit(*in, n, sink);
+    }
+    else
+    {
+      n = (n < sizeof(s_scratch)) ? n : sizeof(s_scratch);
+      err = read_base(s_src, n);
+      if (err == ESP_OK)
+      {
+        for (size_t i = 0; i < n; ++i)
+        {
+          s_scratch[i] = (uint8_t)(s_scratch[i] + (*in)[i]);
+        }
+        err = emit(s_scratch, n, sink);
+      }
+      s_src += n;
+    }
+    *in += n;
+    *len -= n;
+    s_left -= n;
+    if (s_left == 0)
+    {
+      s_state = DELTA_OP;
+    }
+    return err;
+  }
+  case DELTA_DONE:
+  case DELTA_ERROR:
+    break;
+  }
+  ESP_LOGE(TAG, "data after the end of the patch");
+  return ESP_ERR_INVALID_RESPONSE;
+}
+
+esp_err_t ota_delta_feed(const uint8_t* in, size_t len, ota_delta_sink_t sink)
+{
+  s_stats.patch_bytes += len;
+  while (len > 0)
+  {
+    const esp_err_t err = step(&in, &len, sink);
+    if (err != ESP_OK)
+    {
+      s_state = DELTA_ERROR;
+      return err;
+    }
+    if (s_state == DELTA_OP && s_out == s_new_size)
+    {
+      s_state = DELTA_DONE;
+    }
+  }
+  return ESP_OK;
+}
+
+bool ota_delta_complete(void)
+{
+  return s_state == DELTA_DONE;
+}
+
+void ota_delta_get_stats(ota_delta_stats_t* out)
+{
+  if (out != NULL)
+  {
+    *out = s_stats;
+  }
+}
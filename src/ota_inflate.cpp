@@ -0,0 +1,239 @@
+#include <esp_log.h>
+#include <esp_rom_crc.h>
+#include <miniz.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ota_field.h"
+#include "ota_inflate.h"
+
+static const char* TAG = "ota_inflate";
+
+#define GZ_FHCRC 0x02
+#define GZ_FEXTRA 0x04
+#define GZ_FNAME 0x08
+#define GZ_FCOMMENT 0x10
+
+enum gz_state
+{
+  GZ_HEADER,
+  GZ_XLEN,
+  GZ_EXTRA,
+  GZ_NAME,
+  GZ_COMMENT,
+  GZ_HCRC,
+  GZ_BODY,
+  GZ_TRAILER,
+  GZ_DONE,
+  GZ_ERROR,
+};
+
+static tinfl_decompressor* s_tinfl = NULL;
+static uint8_t* s_window = NULL; // TINFL_LZ_DICT_SIZE ring, also the output buffer
+static size_t s_window_ofs = 0;
+
+static gz_state s_state = GZ_HEADER;
+static ota_field::buffer<10> s_field = {}; // header / XLEN / trailer bytes collected across feeds
+static uint8_t s_flags = 0;
+static size_t s_skip = 0;
+static uint32_t s_crc = 0;
+static uint32_t s_out = 0;
+
+/* Advance past optional header fields whose flag is not set. */
+static void next_header_state()
+{
+  s_field.len = 0;
+  for (;;)
+  {
+    switch (s_state)
+    {
+    case GZ_HEADER:
+      s_state = GZ_XLEN;
+      if (s_flags & GZ_FEXTRA)
+        return;
+      break;
+    case GZ_XLEN:
+    case GZ_EXTRA:
+      s_state = GZ_NAME;
+      if (s_flags & GZ_FNAME)
+        return;
+      break;
+    case GZ_NAME:
+      s_state = GZ_COMMENT;
+      if (s_flags & GZ_FCOMMENT)
+        return;
+      break;
+    case GZ_COMMENT:
+      s_state = GZ_HCRC;
+      if (s_flags & GZ_FHCRC)
+        return;
+      break;
+    default:
+      s_state = GZ_BODY;
+      return;
+    }
+  }
+}
+
+static esp_err_t inflate_body(const uint8_t** in, size_t* len, ota_inflate_sink_t sink)
+{
+  for (;;)
+  {
+    size_t in_bytes = *len;
+    size_t out_bytes = TINFL_LZ_DICT_SIZE - s_window_ofs;
+    const tinfl_status st =
+        tinfl_decompress(s_tinfl, *in, &in_bytes, s_window, s_window + s_window_ofs, &out_bytes, TINFL_FLAG_HAS_MORE_INPUT);
+    *in += in_bytes;
+    *len -= in_bytes;
+    if (out_bytes > 0)
+    {
+      s_crc = esp_rom_crc32_le(s_crc, s_window + s_window_ofs, out_bytes);
+      s_out += out_bytes;
+      if (!sink(s_window + s_window_ofs, out_bytes))
+      {
+        return ESP_FAIL;
+      }
+      s_window_ofs = (s_window_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+    }
+    if (st < TINFL_STATUS_DONE)
+    {
+      ESP_LOGE(TAG, "corrupt deflate stream (%d) after %u bytes", (int)st, (unsigned)s_out);
+      return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (st == TINFL_STATUS_DONE)
+    {
+      s_state = GZ_TRAILER;
+      s_field.len = 0;
+      return ESP_OK;
+    }
+    if (st == TINFL_STATUS_NEEDS_MORE_INPUT && *len == 0)
+    {
+      return ESP_OK;
+    }
+  }
+}
+
+esp_err_t ota_inflate_begin(void)
+{
+  s_tinfl = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+  s_window = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+  if (s_tinfl == NULL || s_window == NULL)
+  {
+    ota_inflate_end();
+    return ESP_ERR_NO_MEM;
+  }
+  tinfl_init(s_tinfl);
+  s_window_ofs = 0;
+  s_state = GZ_HEADER;
+  s_field.len = 0;
+  s_flags = 0;
+  s_crc = 0;
+  s_out = 0;
+  return ESP_OK;
+}
+
+esp_err_t ota_inflate_feed(const uint8_t* in, size_t len, ota_inflate_sink_t sink)
+{
+  while (len > 0)
+  {
+    switch (s_state)
+    {
+    case GZ_HEADER:
+      if (s_field.collect(&in, &len, 10))
+      {
+        if (s_field.data[0] != 0x1f || s_field.data[1] != 0x8b || s_field.data[2] != 8)
+        {
+          ESP_LOGE(TAG, "not a gzip stream");
+          s_state = GZ_ERROR;
+          break;
+        }
+        s_flags = s_field.data[3];
+        next_header_state();
+      }
+      break;
+    case GZ_XLEN:
+      if (s_field.collect(&in, &len, 2))
+      {
+        s_skip = (size_t)s_field.data[0] | ((size_t)s_field.data[1] << 8);
+        s_field.len = 0;
+        s_state = GZ_EXTRA;
+      }
+      break;
+    case GZ_EXTRA:
+    {
+      const size_t n = (s_skip < len) ? s_skip : len;
+      in += n;
+      len -= n;
+      s_skip -= n;
+      if (s_skip == 0)
+        next_header_state();
+      break;
+    }
+    case GZ_NAME:
+    case GZ_COMMENT:
+    {
+      const uint8_t* nul = (const uint8_t*)memchr(in, 0, len);
+      const size_t n = (nul != NULL) ? (size_t)(nul - in) + 1 : len;
+      in += n;
+      len -= n;
+      if (nul != NULL)
+        next_header_state();
+      break;
+    }
+    case GZ_HCRC:
+      if (s_field.collect(&in, &len, 2))
+        next_header_state();
+      break;
+    case GZ_BODY:
+    {
+      const esp_err_t err = inflate_body(&in, &len, sink);
+      if (err != ESP_OK)
+      {
+        s_state = GZ_ERROR;
+        return err;
+      }
+      break;
+    }
+    case GZ_TRAILER:
+      if (s_field.collect(&in, &len, 8))
+      {
+        if (ota_field::le32(s_field.data) != s_crc || ota_field::le32(s_field.data + 4) != s_out)
+        {
+          ESP_LOGE(TAG, "trailer mismatch: crc %08x/%08x, size %u/%u", (unsigned)ota_field::le32(s_field.data), (unsigned)s_crc,
+                   (unsigned)ota_field::le32(s_field.data + 4), (unsigned)s_out);
+          s_state = GZ_ERROR;
+          break;
+        }
+        s_state = GZ_DONE;
+      }
+      break;
+    case GZ_DONE: // data after the member: not something we produce, refuse it
+    case GZ_ERROR:
+      s_state = GZ_ERROR;
+      return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (s_state == GZ_ERROR)
+    {
+      return ESP_ERR_INVALID_RESPONSE;
+    }
+  }
+  return ESP_OK;
+}
+
+bool ota_inflate_complete(void)
+{
+  return s_state == GZ_DONE;
+}
+
+uint32_t ota_inflate_out_bytes(void)
+{
+  return s_out;
+}
+
+void ota_inflate_end(void)
+{
+  free(s_tinfl);
+  free(s_window);
+  s_tinfl = NULL;
+  s_window = NULL;
+}
@@ -0,0 +1,208 @@
+#include <esp_app_desc.h>
+#include <esp_app_format.h>
+#include <esp_log.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/pk.h>
+#include <mbedtls/sha256.h>
+#include <sdkconfig.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ota_verify.h"
+
+#if __has_include("ota_signing_key.h")
+#include "ota_signing_key.h"
+#endif
+
+static const char* TAG = "ota_verify";
+
+static mbedtls_sha256_context s_sha;
+static bool s_active = false;
+static bool s_have_digest = false;
+static uint8_t s_expected[32];
+static uint8_t s_sig[384]; // up to RSA-3072; ECDSA P-256 (DER) is ~72 bytes
+static size_t s_sig_len = 0;
+
+static int hex_nibble(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static bool parse_sha256_hex(const char* hex, uint8_t* out)
+{
+  if (strlen(hex) != 64)
+  {
+    return false;
+  }
+  for (int i = 0; i < 32; ++i)
+  {
+    const int hi = hex_nibble(hex[i * 2]);
+    const int lo = hex_nibble(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0)
+    {
+      return false;
+    }
+    out[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return true;
+}
+
+bool ota_verify_begin(const char* sha256_hex, const char* signature_b64, char* err, size_t err_size)
+{
+  s_have_digest = false;
+  s_sig_len = 0;
+
+  if (sha256_hex != NULL && sha256_hex[0] != '\0')
+  {
+    if (!parse_sha256_hex(sha256_hex, s_expected))
+    {
+      snprintf(err, err_size, "X-Image-SHA256 must be 64 hex characters");
+      return false;
+    }
+    s_have_digest = true;
+  }
+
+  if (signature_b64 != NULL && signature_b64[0] != '\0')
+  {
+    if (mbedtls_base64_decode(s_sig, sizeof(s_sig), &s_sig_len, (const unsigned char*)signature_b64, strlen(signature_b64)) != 0)
+    {
+      snprintf(err, err_size, "X-Image-Signature is not valid base64");
+      return false;
+    }
+  }
+
+#ifdef OTA_SIGNING_PUBKEY_PEM
+  if (s_sig_len == 0)
+  {
+    snprintf(err, err_size, "Signed images only: X-Image-Signature required");
+    return false;
+  }
+#endif
+
+  mbedtls_sha256_init(&s_sha);
+  mbedtls_sha256_starts(&s_sha, 0);
+  s_active = true;
+  return true;
+}
+
+bool ota_verify_image_header(const uint8_t* data, size_t len, char* err, size_t err_size)
+{
+  const size_t desc_offset = sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
+  static_assert(sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t) + sizeof(esp_app_desc_t) == OTA_VERIFY_HEADER_BYTES,
+                "OTA_VERIFY_HEADER_BYTES must cover the headers read here");
+  if (len < OTA_VERIFY_HEADER_BYTES)
+  {
+    snprintf(err, err_size, "Image too short");
+    return false;
+  }
+
+  esp_image_header_t hdr;
+  esp_app_desc_t desc;
+  memcpy(&hdr, data, sizeof(hdr));
+  memcpy(&desc, data + desc_offset, sizeof(desc));
+
+  if (hdr.magic != ESP_IMAGE_HEADER_MAGIC || desc.magic_word != ESP_APP_DESC_MAGIC_WORD)
+  {
+    snprintf(err, err_size, "Not an ESP-IDF application image");
+    return false;
+  }
+  if (hdr.chip_id != CONFIG_IDF_FIRMWARE_CHIP_ID)
+  {
+    snprintf(err, err_size, "Image is for chip id %d, this is %d", (int)hdr.chip_id, (int)CONFIG_IDF_FIRMWARE_CHIP_ID);
+    return false;
+  }
+  const esp_app_desc_t* running = esp_app_get_description();
+  if (strncmp(desc.project_name, running->project_name, sizeof(desc.project_name)) != 0)
+  {
+    snprintf(err, err_size, "Image is project '%.32s', expected '%.32s'", desc.project_name, running->project_name);
+    return false;
+  }
+  ESP_LOGI(TAG, "Image %.32s %.32s (IDF %.32s)", desc.project_name, desc.version, desc.idf_ver);
+  return true;
+}
+
+void ota_verify_update(const uint8_t* data, size_t len)
+{
+  if (s_active)
+  {
+    mbedtls_sha256_update(&s_sha, data, len);
+  }
+}
+
+static void to_hex(const uint8_t* d, char* out)
+{
+  for (int i = 0; i < 32; ++i)
+  {
+    snprintf(out + i * 2, 3, "%02x", d[i]);
+  }
+}
+
+#ifdef OTA_SIGNING_PUBKEY_PEM
+static bool verify_signature(const uint8_t* digest)
+{
+  static const char k_pem[] = OTA_SIGNING_PUBKEY_PEM;
+  mbedtls_pk_context pk;
+  mbedtls_pk_init(&pk);
+  int rc = mbedtls_pk_parse_public_key(&pk, (const unsigned char*)k_pem, sizeof(k_pem));
+  if (rc == 0)
+  {
+    rc = mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, digest, 32, s_sig, s_sig_len);
+  }
+  mbedtls_pk_free(&pk);
+  if (rc != 0)
+  {
+    ESP_LOGE(TAG, "signature check failed: -0x%04x", (unsigned)-rc);
+  }
+  return rc == 0;
+}
+#endif
+
+bool ota_verify_finish(uint8_t* out_sha256, char* err, size_t err_size)
+{
+  if (!s_active)
+  {
+    snprintf(err, err_size, "No verification session");
+    return false;
+  }
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&s_sha, digest);
+  mbedtls_sha256_free(&s_sha);
+  s_active = false;
+
+  char hex[65];
+  to_hex(digest, hex);
+  ESP_LOGI(TAG, "Image SHA-256 %s", hex);
+  if (out_sha256 != NULL)
+  {
+    memcpy(out_sha256, digest, sizeof(digest));
+  }
+
+  if (s_have_digest && memcmp(digest, s_expected, sizeof(digest)) != 0)
+  {
+    snprintf(err, err_size, "SHA-256 mismatch: image is %s", hex);
+    return false;
+  }
+#ifdef OTA_SIGNING_PUBKEY_PEM
+  if (!verify_signature(digest))
+  {
+    snprintf(err, err_size, "Signature does not match the release key");
+    return false;
+  }
+#endif
+  return true;
+}
+
+void ota_verify_abort(void)
+{
+  if (s_active)
+  {
+    mbedtls_sha256_free(&s_sha);
+    s_active = false;
+  }
+}
@@ -0,0 +1,426 @@
+#include <esp_log.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ota_writer.h"
+#include "utils.h"
+#include "ws2812b_support.h"
+
+static const char* TAG = "ota_writer";
+
+// Receive buffers in flight. 1 reproduces the old lockstep receive/write behavior for comparison.
+#ifndef OTA_BUF_COUNT
+#define OTA_BUF_COUNT 3
+#endif
+#ifndef OTA_BUF_SIZE
+#define OTA_BUF_SIZE 4096
+#endif
+
+// Flash scheduling defaults (runtime: ota_writer_set_config). Every erase or write stalls the
+// cache of both cores, so operations are kept short and run between LED strip transmissions.
+// A 64 KB erase (flash block erase) is much faster per byte than 4 KB sector erases but stalls
+// for hundreds of ms at a time; a 512 B write (two page programs) fits in a frame gap.
+#ifndef OTA_ERASE_CHUNK
+#define OTA_ERASE_CHUNK 4096
+#endif
+#ifndef OTA_WRITE_SLICE
+#define OTA_WRITE_SLICE 512
+#endif
+#ifndef OTA_FLASH_DUTY_PCT
+#define OTA_FLASH_DUTY_PCT 60
+#endif
+#ifndef OTA_LED_SYNC
+#define OTA_LED_SYNC 1
+#endif
+
+#define OTA_SECTOR_SIZE 4096
+
+static uint8_t* s_bufs[OTA_BUF_COUNT];
+static size_t s_lens[OTA_BUF_COUNT];
+static QueueHandle_t s_free_q = NULL; // buffer indices ready to be filled
+static QueueHandle_t s_full_q = NULL; // buffer indices to write, -1 = drain and stop
+static SemaphoreHandle_t s_done = NULL;
+static TaskHandle_t s_writer = NULL;
+
+static ota_writer_config_t s_cfg = {OTA_ERASE_CHUNK, OTA_WRITE_SLICE, OTA_FLASH_DUTY_PCT, OTA_LED_SYNC != 0};
+
+static const esp_partition_t* s_part = NULL;
+static esp_ota_handle_t s_ota = 0;
+static size_t s_erase_end = 0; // image size rounded up to a sector
+static size_t s_erased_to = 0;
+static size_t s_written = 0;
+static volatile esp_err_t s_write_err = ESP_OK;
+
+static int64_t s_begin_us = 0;
+static int64_t s_buf_wait_us = 0;
+static int64_t s_write_us = 0;
+static int64_t s_erase_us = 0;
+static int64_t s_idle_us = 0;
+static int64_t s_flash_busy_us = 0; // in erase + write operations, for the duty budget
+static int64_t s_gap_wait_us = 0;
+static int64_t s_duty_wait_us = 0;
+static uint32_t s_est_erase_us = 0; // last operation of each kind, to fit the next one in a gap
+static uint32_t s_est_write_us = 0;
+static bool s_led_synced = false;   // writer task only
+
+// LED frame counters at begin, reported as deltas.
+static uint32_t s_led_frames0 = 0;
+static uint32_t s_led_missed0 = 0;
+static uint32_t s_led_deferred0 = 0;
+static uint32_t s_led_skipped0 = 0;
+
+static size_t align_up(size_t v, size_t a)
+{
+  return (v + a - 1) / a * a;
+}
+
+/* Before a flash operation of about est_us: stay within the duty budget, then wait for a gap
+ * between LED transmissions. */
+static void flash_op_begin(uint32_t est_us)
+{
+  const int64_t t0 = esp_timer_get_time();
+  while (s_cfg.duty_pct < 100 && s_flash_busy_us * 100 > (int64_t)s_cfg.duty_pct * (esp_timer_get_time() - s_begin_us))
+  {
+    vTaskDelay(1);
+  }
+  const int64_t t1 = esp_timer_get_time();
+  s_duty_wait_us += t1 - t0;
+  if (s_cfg.led_sync)
+  {
+    while (!ws2812b_flash_claim(est_us))
+    {
+      ws2812b_flash_wait_gap();
+    }
+    s_gap_wait_us += esp_timer_get_time() - t1;
+  }
+}
+
+/* Returns the operation's duration. */
+static uint32_t flash_op_end(int64_t t0)
+{
+  if (s_cfg.led_sync)
+  {
+    ws2812b_flash_release();
+  }
+  const int64_t us = esp_timer_get_time() - t0;
+  s_flash_busy_us += us;
+  return (uint32_t)us;
+}
+
+/* LED frames are scheduled around flash operations only while the writer has work: a resumable
+ * upload may sit idle for minutes between chunks, and the LED task must not be held meanwhile. */
+static void set_led_sync(bool busy)
+{
+  const bool on = busy && s_cfg.led_sync;
+  if (on != s_led_synced)
+  {
+    s_led_synced = on;
+    ws2812b_set_flash_sync(on);
+  }
+}
+
+/* Erase up to `to` (sector aligned, at most s_erase_end), in chunks that end on chunk boundaries
+ * so 64 KB chunks use block erases. */
+static esp_err_t erase_to(size_t to)
+{
+  to = (to < s_erase_end) ? to : s_erase_end;
+  while (s_erased_to < to)
+  {
+    size_t end = align_up(s_erased_to + 1, s_cfg.erase_chunk);
+    end = (end < s_erase_end) ? end : s_erase_end;
+    flash_op_begin(s_est_erase_us);
+    const int64_t t0 = esp_timer_get_time();
+    esp_err_t err = esp_partition_erase_range(s_part, s_erased_to, end - s_erased_to);
+    s_est_erase_us = flash_op_end(t0);
+    s_erase_us += s_est_erase_us;
+    if (err != ESP_OK)
+    {
+      return err;
+    }
+    s_erased_to = end;
+  }
+  return ESP_OK;
+}
+
+static void ota_writer_task(void* arg)
+{
+  for (;;)
+  {
+    // While there is still partition to erase, use the wait for data to erase the next chunk.
+    const bool can_erase = (s_write_err == ESP_OK && s_erased_to < s_erase_end);
+    int idx = 0;
+    set_led_sync(can_erase || uxQueueMessagesWaiting(s_full_q) > 0);
+    const int64_t t0 = esp_timer_get_time();
+    if (xQueueReceive(s_full_q, &idx, can_erase ? 0 : portMAX_DELAY) != pdTRUE)
+    {
+      esp_err_t err = erase_to(s_erased_to + 1);
+      if (err != ESP_OK)
+      {
+        s_write_err = err;
+      }
+      continue;
+    }
+    if (!can_erase)
+    {
+      s_idle_us += esp_timer_get_time() - t0;
+    }
+    if (idx < 0)
+    {
+      break;
+    }
+
+    if (s_write_err == ESP_OK)
+    {
+      set_led_sync(true);
+      esp_err_t err = erase_to(align_up(s_written + s_lens[idx], OTA_SECTOR_SIZE));
+      for (size_t off = 0; off < s_lens[idx] && err == ESP_OK; off += s_cfg.write_slice)
+      {
+        const size_t n = (s_lens[idx] - off < s_cfg.write_slice) ? s_lens[idx] - off : s_cfg.write_slice;
+        flash_op_begin(s_est_write_us);
+        const int64_t t1 = esp_timer_get_time();
+        err = esp_ota_write(s_ota, s_bufs[idx] + off, n);
+        s_est_write_us = flash_op_end(t1);
+        s_write_us += s_est_write_us;
+      }
+      if (err != ESP_OK)
+      {
+        ESP_LOGE(TAG, "write at %u failed: %s", (unsigned)s_written, esp_err_to_name(err));
+        s_write_err = err;
+      }
+      s_written += s_lens[idx];
+    }
+    xQueueSend(s_free_q, &idx, portMAX_DELAY);
+  }
+  xSemaphoreGive(s_done);
+  vTaskDelete(NULL);
+}
+
+static void release()
+{
+  ws2812b_set_flash_sync(false);
+  s_led_synced = false;
+  for (int i = 0; i < OTA_BUF_COUNT; ++i)
+  {
+    free(s_bufs[i]);
+    s_bufs[i] = NULL;
+  }
+  if (s_free_q)
+    vQueueDelete(s_free_q);
+  if (s_full_q)
+    vQueueDelete(s_full_q);
+  if (s_done)
+    vSemaphoreDelete(s_done);
+  s_free_q = NULL;
+  s_full_q = NULL;
+  s_done = NULL;
+  s_writer = NULL;
+  s_part = NULL;
+}
+
+esp_err_t ota_writer_begin(const esp_partition_t* part, size_t image_size)
+{
+  if (part == NULL || image_size == 0 || image_size > part->size || s_part != NULL)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  s_free_q = xQueueCreate(OTA_BUF_COUNT, sizeof(int));
+  s_full_q = xQueueCreate(OTA_BUF_COUNT + 1, sizeof(int));
+  s_done = xSemaphoreCreateBinary();
+  bool ok = (s_free_q != NULL && s_full_q != NULL && s_done != NULL);
+  for (int i = 0; i < OTA_BUF_COUNT && ok; ++i)
+  {
+    s_bufs[i] = (uint8_t*)malloc(OTA_BUF_SIZE);
+    ok = (s_bufs[i] != NULL);
+    if (ok)
+      xQueueSend(s_free_q, &i, 0);
+  }
+  if (!ok)
+  {
+    release();
+    return ESP_ERR_NO_MEM;
+  }
+
+  s_begin_us = esp_timer_get_time();
+  s_buf_wait_us = s_write_us = s_erase_us = s_idle_us = 0;
+  s_flash_busy_us = s_gap_wait_us = s_duty_wait_us = 0;
+  s_est_erase_us = s_est_write_us = 0;
+
+  ws2812b_stats_t led = {};
+  ws2812b_latency_t lat = {};
+  ws2812b_get_stats(&led);
+  ws2812b_get_latency(&lat);
+  s_led_frames0 = led.frames;
+  s_led_deferred0 = led.flash_deferred;
+  s_led_skipped0 = led.flash_skipped;
+  s_led_missed0 = lat.missed_deadlines;
+  s_part = part;
+  s_written = 0;
+  s_write_err = ESP_OK;
+  s_erase_end = align_up(image_size, OTA_SECTOR_SIZE);
+
+  // Passing one sector as the image size makes esp_ota_begin() erase only that sector and
+  // leaves the rest to erase_to(); esp_ota_write() itself then never erases.
+  esp_err_t err = esp_ota_begin(part, OTA_SECTOR_SIZE, &s_ota);
+  if (err != ESP_OK)
+  {
+    release();
+    return err;
+  }
+  s_erased_to = OTA_SECTOR_SIZE;
+
+  if (xTaskCreate(ota_writer_task, "ota_writer", 4096, NULL, 5, &s_writer) != pdPASS)
+  {
+    (void)esp_ota_abort(s_ota);
+    release();
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG,
+           "OTA to %s: %u bytes, %d x %d B buffers, erase %u B, write %u B, duty %u%%, LED sync %s",
+           part->label,
+           (unsigned)image_size,
+           OTA_BUF_COUNT,
+           OTA_BUF_SIZE,
+           (unsigned)s_cfg.erase_chunk,
+           (unsigned)s_cfg.write_slice,
+           (unsigned)s_cfg.duty_pct,
+           s_cfg.led_sync ? "on" : "off");
+  return ESP_OK;
+}
+
+uint8_t* ota_writer_acquire(size_t* capacity)
+{
+  int idx = 0;
+  const int64_t t0 = esp_timer_get_time();
+  xQueueReceive(s_free_q, &idx, portMAX_DELAY);
+  s_buf_wait_us += esp_timer_get_time() - t0;
+  if (s_write_err != ESP_OK)
+  {
+    xQueueSend(s_free_q, &idx, 0);
+    return NULL;
+  }
+  if (capacity != NULL)
+  {
+    *capacity = OTA_BUF_SIZE;
+  }
+  return s_bufs[idx];
+}
+
+void ota_writer_submit(uint8_t* buf, size_t len)
+{
+  for (int i = 0; i < OTA_BUF_COUNT; ++i)
+  {
+    if (s_bufs[i] == buf)
+    {
+      s_lens[i] = len;
+      xQueueSend(s_full_q, &i, portMAX_DELAY);
+      return;
+    }
+  }
+}
+
+void ota_writer_discard(uint8_t* buf)
+{
+  for (int i = 0; i < OTA_BUF_COUNT; ++i)
+  {
+    if (s_bufs[i] == buf)
+    {
+      xQueueSend(s_free_q, &i, 0);
+      return;
+    }
+  }
+}
+
+static void stop_writer()
+{
+  const int stop = -1;
+  xQueueSend(s_full_q, &stop, portMAX_DELAY);
+  xSemaphoreTake(s_done, portMAX_DELAY);
+}
+
+esp_err_t ota_writer_finish(ota_report_t* report)
+{
+  stop_writer();
+  esp_err_t err = s_write_err;
+  int64_t end_us = 0;
+  if (err == ESP_OK)
+  {
+    const int64_t t0 = esp_timer_get_time();
+    err = esp_ota_end(s_ota); // verifies the image
+    end_us = esp_timer_get_time() - t0;
+  }
+  else
+  {
+    (void)esp_ota_abort(s_ota);
+  }
+
+  if (report != NULL)
+  {
+    const int64_t total_us = esp_timer_get_time() - s_begin_us;
+    memset(report, 0, sizeof(*report));
+    report->bytes = (uint32_t)s_written;
+    report->total_ms = (uint32_t)(total_us / 1000);
+    report->buf_wait_ms = (uint32_t)(s_buf_wait_us / 1000);
+    report->write_ms = (uint32_t)(s_write_us / 1000);
+    report->erase_ms = (uint32_t)(s_erase_us / 1000);
+    report->idle_ms = (uint32_t)(s_idle_us / 1000);
+    report->end_ms = (uint32_t)(end_us / 1000);
+    report->kib_per_s = total_us > 0 ? (uint32_t)((uint64_t)s_written * 1000000 / 1024 / (uint64_t)total_us) : 0;
+    report->gap_wait_ms = (uint32_t)(s_gap_wait_us / 1000);
+    report->duty_wait_ms = (uint32_t)(s_duty_wait_us / 1000);
+
+    ws2812b_stats_t led = {};
+    ws2812b_latency_t lat = {};
+    ws2812b_get_stats(&led);
+    ws2812b_get_latency(&lat);
+    report->led_frames = led.frames - s_led_frames0;
+    report->led_deferred = led.flash_deferred - s_led_deferred0;
+    report->led_skipped = led.flash_skipped - s_led_skipped0;
+    // The latency counters may have been reset meanwhile.
+    report->led_missed = (lat.missed_deadlines >= s_led_missed0) ? lat.missed_deadlines - s_led_missed0 : lat.missed_deadlines;
+  }
+  release();
+  return err;
+}
+
+void ota_writer_get_config(ota_writer_config_t* out)
+{
+  if (out != NULL)
+  {
+    *out = s_cfg;
+  }
+}
+
+esp_err_t ota_writer_set_config(const ota_writer_config_t* cfg)
+{
+  if (cfg == NULL || cfg->erase_chunk < OTA_SECTOR_SIZE || cfg->erase_chunk % OTA_SECTOR_SIZE != 0 || cfg->write_slice < 16 ||
+      cfg->write_slice > OTA_BUF_SIZE || cfg->write_slice % 16 != 0 || cfg->duty_pct < 5 || cfg->duty_pct > 100)
+  {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_part != NULL)
+  {
+    return ESP_ERR_INVALID_STATE;
+  }
+  s_cfg = *cfg;
+  return ESP_OK;
+}
+
+void ota_writer_abort(void)
+{
+  if (s_part == NULL)
+  {
+    return;
+  }
+  stop_writer();
+  (void)esp_ota_abort(s_ota);
+  release();
+  ESP_LOGW(TAG, "OTA aborted after %u bytes", (unsigned)s_written);
+}
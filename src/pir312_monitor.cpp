@@ -2,12 +2,14 @@
 #include <esp_attr.h>
 #include <esp_log.h>
 #include <esp_rom_sys.h>
+#include <esp_sleep.h>
 #include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
 #include <stdio.h>
 
+#include "metrics.h"
 #include "pir312_monitor.h"
 #include "utils.h"
 
@@ -27,6 +29,38 @@ static const gpio_num_t pir_pins[PIR_COUNT] = {
 
 static volatile uint64_t pir_state[PIR_COUNT];
 
+// ISR time of the edge that started the current motion period (sensor went from idle to active),
+// 0 once picked up by pir312_take_onset_us(). Used to trace motion-to-light latency.
+static volatile uint64_t pir_onset[PIR_COUNT];
+// Traced state: ISR time of the last rising edge, 0 before the first one. Unlike pir_state it does
+// not start at boot, so the first edge after power-up is an onset although the strip is lit for
+// the first TIMEOUT_US.
+static volatile uint64_t pir_edge[PIR_COUNT];
+static portMUX_TYPE pir_onset_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static pir312_edge_hook_t s_edge_hook = NULL;
+
+static metric_t s_m_edges = NULL;
+static metric_t s_m_onsets = NULL;
+static metric_t s_m_motion = NULL; // bit i: sensor i sees motion, as of the last pir312_sample_motion()
+static uint32_t s_motion_mask = 0;  // LED task only
+
+// Light-sleep wake: while armed the pins carry level interrupts (the only GPIO wake type on the
+// ESP32), so the first one to fire switches all pins back to edge interrupts before anything else.
+// Arming, disarming and the ISR's check run under s_wake_lock: an edge while the pins are being
+// armed is handled once the lock is released, and always finds the flag set.
+static volatile bool s_wake_armed = false;
+static portMUX_TYPE s_wake_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void restore_edge_interrupts()
+{
+  for (int i = 0; i < PIR_COUNT; ++i)
+  {
+    gpio_wakeup_disable(pir_pins[i]);
+    gpio_set_intr_type(pir_pins[i], GPIO_INTR_ANYEDGE);
+  }
+}
+
 int pir312_count(void)
 {
   return PIR_COUNT;
@@ -34,18 +68,45 @@ int pir312_count(void)
 
 static void IRAM_ATTR pir_isr(void* arg)
 {
-  const int index = (int)arg;
+  const int index = (int)(intptr_t)arg;
   const int level = gpio_get_level(pir_pins[index]);
   uint64_t cur_time = esp_timer_get_time();
 
+  portENTER_CRITICAL_ISR(&s_wake_lock);
+  if (s_wake_armed)
+  {
+    // Not an IRAM ISR (the service is installed without ESP_INTR_FLAG_IRAM), so the driver calls are safe.
+    s_wake_armed = false;
+    restore_edge_interrupts();
+  }
+  portEXIT_CRITICAL_ISR(&s_wake_lock);
+
+  metrics_add(s_m_edges, 1);
   if (level > 0)
   {
+    if (pir_edge[index] == 0 || (int64_t)(cur_time - pir_edge[index]) >= TIMEOUT_US)
+    {
+      portENTER_CRITICAL_ISR(&pir_onset_lock);
+      pir_onset[index] = cur_time;
+      portEXIT_CRITICAL_ISR(&pir_onset_lock);
+      metrics_add(s_m_onsets, 1);
+    }
     pir_state[index] = cur_time;
+    pir_edge[index] = cur_time;
+  }
+
+  const pir312_edge_hook_t hook = s_edge_hook;
+  if (hook != NULL)
+  {
+    hook();
   }
 }
 
 extern "C" void pir312_init(void)
 {
+  s_m_edges = metrics_counter("pir.edges");
+  s_m_onsets = metrics_counter("pir.onsets");
+  s_m_motion = metrics_gauge("pir.motion", 0);
   CHECK_ERR(gpio_install_isr_service(0));
 
   uint64_t cur_time = esp_timer_get_time();
@@ -62,9 +123,11 @@ extern "C" void pir312_init(void)
     cfg.pull_up_en = GPIO_PULLUP_DISABLE;
     cfg.intr_type = GPIO_INTR_ANYEDGE;
     CHECK_ERR(gpio_config(&cfg));
-    CHECK_ERR(gpio_isr_handler_add(pir_pins[i], pir_isr, (void*)i));
+    CHECK_ERR(gpio_isr_handler_add(pir_pins[i], pir_isr, (void*)(intptr_t)i));
   }
 
+  CHECK_ERR(esp_sleep_enable_gpio_wakeup()); // only pins armed by pir312_arm_wakeup() wake the chip
+
   ESP_LOGI(TAG, "pir312_init done.");
 }
 
@@ -74,7 +137,7 @@ bool pir312_get_state(int index)
 
   if (index < pir312_count())
   {
-    if ((esp_timer_get_time() - pir_state[index]) < TIMEOUT_US)
+    if ((int64_t)((uint64_t)esp_timer_get_time() - pir_state[index]) < TIMEOUT_US)
     {
       result = true;
     }
@@ -83,6 +146,66 @@ bool pir312_get_state(int index)
   return result;
 }
 
+uint32_t pir312_sample_motion(void)
+{
+  uint32_t mask = 0;
+  for (int i = 0; i < PIR_COUNT; ++i)
+  {
+    mask |= pir312_get_state(i) ? (1u << i) : 0u;
+  }
+  if (mask != s_motion_mask)
+  {
+    s_motion_mask = mask;
+    metrics_set(s_m_motion, (int32_t)mask);
+  }
+  return mask;
+}
+
+void pir312_set_edge_hook(pir312_edge_hook_t hook)
+{
+  s_edge_hook = hook;
+}
+
+void pir312_arm_wakeup(void)
+{
+  esp_err_t result = ESP_OK;
+  portENTER_CRITICAL(&s_wake_lock);
+  s_wake_armed = true; // before the first level interrupt is enabled
+  for (int i = 0; i < PIR_COUNT; ++i)
+  {
+    // Wake on the opposite of the current level, i.e. on the next edge.
+    const gpio_int_type_t wake = gpio_get_level(pir_pins[i]) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+    const esp_err_t pin_result = gpio_wakeup_enable(pir_pins[i], wake);
+    result = (result == ESP_OK) ? pin_result : result;
+  }
+  portEXIT_CRITICAL(&s_wake_lock);
+  CHECK_ERR(result); // logged outside the critical section
+}
+
+void pir312_disarm_wakeup(void)
+{
+  portENTER_CRITICAL(&s_wake_lock);
+  if (s_wake_armed)
+  {
+    s_wake_armed = false;
+    restore_edge_interrupts();
+  }
+  portEXIT_CRITICAL(&s_wake_lock);
+}
+
+uint64_t pir312_take_onset_us(int index)
+{
+  if (index < 0 || index >= pir312_count())
+  {
+    return 0;
+  }
+  portENTER_CRITICAL(&pir_onset_lock);
+  const uint64_t onset = pir_onset[index];
+  pir_onset[index] = 0;
+  portEXIT_CRITICAL(&pir_onset_lock);
+  return onset;
+}
+
 extern "C" void pir312_dump_status()
 {
   ESP_LOGI(TAG,
@@ -0,0 +1,29 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "web_server.h"
+
+#define BENCH_ITERATIONS_DEFAULT 1000
+#define BENCH_ITERATIONS_MAX     1000000
+
+// GET /bench?name=led&n=1000
+// Runs the hot-path microbenchmarks (bench.h) in the server task and returns their JSON: per case
+// the mean time and CPU cycles per call, and the cycles of the best batch. Takes up to
+// BENCH_CASE_BUDGET_MS per case, during which the server answers nothing else.
+static void bench_api()
+{
+  char name[24] = "";
+  web_query_str("name", name, sizeof(name));
+  int n = BENCH_ITERATIONS_DEFAULT;
+  web_query_int("n", &n);
+  n = (n < 1) ? 1 : ((n > BENCH_ITERATIONS_MAX) ? BENCH_ITERATIONS_MAX : n);
+
+  char body[1024];
+  bench_run_json(name, n, body, sizeof(body));
+  web_send(200, "application/json; charset=utf-8", body);
+}
+
+void bench_register_web_route_handlers()
+{
+  web_register_get("/bench", bench_api);
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+
+#include "led_effects.h"
+#include "led_stream.h"
+#include "web_server.h"
+#include "ws2812b_support.h"
+
+static void led_stats_api()
+{
+  ws2812b_stats_t st = {};
+  ws2812b_get_stats(&st);
+  led_stream_stats_t ss = {};
+  led_stream_get_stats(&ss);
+
+  char buf[640];
+  snprintf(buf,
+           sizeof(buf),
+           "{\"backend\":\"%s\",\"outputs\":%u,\"frames\":%u,\"skipped\":%u,\"cpu_us_last\":%u,\"cpu_us_avg\":%u,"
+           "\"wait_us_last\":%u,\"wait_us_max\":%u,\"flash_deferred\":%u,\"flash_skipped\":%u,"
+           "\"idle\":{\"active\":%s,\"entries\":%u,\"ms\":%u},"
+           "\"power\":{\"budget_ma\":%u,\"last_ma\":%u,\"avg_ma\":%u,\"peak_ma\":%u,\"req_peak_ma\":%u,\"limited\":%u},"
+           "\"stream\":{\"active\":%s,\"packets\":%u,\"frames\":%u,\"dropped\":%u,\"seq_gaps\":%u}}",
+           st.backend ? st.backend : "-",
+           (unsigned)st.outputs,
+           (unsigned)st.frames,
+           (unsigned)st.skipped,
+           (unsigned)st.cpu_us_last,
+           (unsigned)st.cpu_us_avg,
+           (unsigned)st.wait_us_last,
+           (unsigned)st.wait_us_max,
+           (unsigned)st.flash_deferred,
+           (unsigned)st.flash_skipped,
+           st.idle ? "true" : "false",
+           (unsigned)st.idle_entries,
+           (unsigned)st.idle_ms,
+           (unsigned)st.power_budget_ma,
+           (unsigned)st.power_ma_last,
+           (unsigned)st.power_ma_avg,
+           (unsigned)st.power_ma_peak,
+           (unsigned)st.power_req_peak_ma,
+           (unsigned)st.power_limited,
+           ss.active ? "true" : "false",
+           (unsigned)ss.packets,
+           (unsigned)ss.frames,
+           (unsigned)ss.dropped,
+           (unsigned)ss.seq_gaps);
+
+  web_send(200, "application/json; charset=utf-8", buf);
+}
+
+// POST /led/power?budget_ma=1500
+static void led_power_api()
+{
+  int budget_ma = 0;
+  if (!web_query_int("budget_ma", &budget_ma) || budget_ma < 100)
+  {
+    web_send(400, "text/plain", "budget_ma missing or below 100");
+    return;
+  }
+  ws2812b_set_power_budget_ma((uint32_t)budget_ma);
+  led_stats_api();
+}
+
+static void led_effects_api()
+{
+  char buf[512];
+  size_t len = 0;
+
+  len += snprintf(buf + len, sizeof(buf) - len, "{\"effects\":[");
+  for (int i = 0; i < led_effects::registry::count; ++i)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len, "%s\"%s\"", (i > 0) ? "," : "", led_effects::registry::names[i]);
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "], \"zones\":[");
+  for (int z = 0; z < ws2812b_zone_count(); ++z)
+  {
+    len += snprintf(buf + len, sizeof(buf) - len, "%s\"%s\"", (z > 0) ? "," : "", ws2812b_zone_effect(z));
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "]}");
+
+  web_send(200, "application/json; charset=utf-8", buf);
+}
+
+// POST /led/zone?zone=0&effect=breathing
+static void led_zone_api()
+{
+  int zone = -1;
+  char effect[24];
+  if (!web_query_int("zone", &zone) || !web_query_str("effect", effect, sizeof(effect)))
+  {
+    web_send(400, "text/plain", "zone and effect required");
+    return;
+  }
+  if (!ws2812b_set_zone_effect(zone, effect))
+  {
+    web_send(400, "text/plain", "unknown zone or effect");
+    return;
+  }
+  led_effects_api();
+}
+
+static void led_latency_api()
+{
+  ws2812b_latency_t lt = {};
+  ws2812b_get_latency(&lt);
+
+  char buf[512];
+  snprintf(buf,
+           sizeof(buf),
+           "{\"motion_to_light\":{\"samples\":%u,\"unchanged\":%u,\"p50_us\":%u,\"p95_us\":%u,\"max_us\":%u,\"avg_us\":%u},"
+           "\"frames\":{\"period_us\":%u,\"interval_p50_us\":%u,\"interval_p95_us\":%u,\"interval_max_us\":%u,"
+           "\"jitter_us_avg\":%u,\"missed_deadlines\":%u}}",
+           (unsigned)lt.motion_samples,
+           (unsigned)lt.motion_unchanged,
+           (unsigned)lt.motion_p50_us,
+           (unsigned)lt.motion_p95_us,
+           (unsigned)lt.motion_max_us,
+           (unsigned)lt.motion_avg_us,
+           (unsigned)lt.frame_us,
+           (unsigned)lt.interval_p50_us,
+           (unsigned)lt.interval_p95_us,
+           (unsigned)lt.interval_max_us,
+           (unsigned)lt.jitter_us_avg,
+           (unsigned)lt.missed_deadlines);
+
+  web_send(200, "application/json; charset=utf-8", buf);
+}
+
+// POST /led/latency/reset: start a new measurement window, e.g. before and after a pipeline change.
+static void led_latency_reset_api()
+{
+  ws2812b_reset_latency();
+  led_latency_api();
+}
+
+void ws2812b_register_web_route_handlers()
+{
+  web_register_get("/led/stats", led_stats_api);
+  web_register_post("/led/power", led_power_api);
+  web_register_get("/led/effects", led_effects_api);
+  web_register_post("/led/zone", led_zone_api);
+  web_register_get("/led/latency", led_latency_api);
+  web_register_post("/led/latency/reset", led_latency_reset_api);
+}
@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <string>
+
+#include "log_ring.h"
+#include "web_server.h"
+
+#define LOG_TAIL_WAIT_MAX_MS 2000 // the server has one worker; a tail poll must not hold it longer
+
+// GET /log?level=W&since=123&wait=1000
+// Lines from the RAM ring as text, oldest first, at or above the level (E, W, I, D, V; default all)
+// and from sequence number `since` on (default: everything still buffered). With `wait`, an empty
+// answer is held up to that many ms until a line arrives, so polling with the returned X-Log-Next
+// tails the log live (host/log_tail.py).
+static void log_api()
+{
+  char level[4] = "V";
+  web_query_str("level", level, sizeof(level));
+  const int max_rank = log_ring_level_rank(level[0]);
+  if (max_rank == 0)
+  {
+    web_send(400, "text/plain", "level=E|W|I|D|V");
+    return;
+  }
+  int since = 0;
+  web_query_int("since", &since);
+  int wait_ms = 0;
+  web_query_int("wait", &wait_ms);
+  wait_ms = (wait_ms < 0) ? 0 : ((wait_ms > LOG_TAIL_WAIT_MAX_MS) ? LOG_TAIL_WAIT_MAX_MS : wait_ms);
+
+  // Only wait when caught up: a position past the newest line is from before a restart, and
+  // log_ring_read() answers it at once from the oldest buffered line.
+  uint32_t from = (since > 0) ? (uint32_t)since : 1;
+  for (int waited = 0; from == log_ring_next_seq() && waited < wait_ms; waited += 50)
+  {
+    vTaskDelay(pdMS_TO_TICKS(50));
+  }
+
+  std::string body;
+  body.reserve(LOG_RING_SLOTS * 96);
+  log_ring_line_t line;
+  while (log_ring_read(&from, &line))
+  {
+    const int rank = log_ring_level_rank(line.level);
+    if (rank == 0 || rank <= max_rank) // unprefixed lines (plain printf-style output) always pass
+    {
+      body.append(line.text, line.len);
+    }
+  }
+
+  char next[12];
+  snprintf(next, sizeof(next), "%u", (unsigned)from);
+  web_set_resp_header("X-Log-Next", next);
+  web_send(200, "text/plain; charset=utf-8", body.c_str());
+}
+
+// POST /log/mode?sync=1 writes to the UART in the logging task again (the old behavior), sync=0
+// goes back to the ring. Compare log.sync_us / log.ring_us, led.cpu_us and http.req_us in GET /metrics.
+static void log_mode_api()
+{
+  int sync = 0;
+  if (!web_query_int("sync", &sync))
+  {
+    web_send(400, "text/plain", "sync=0|1");
+    return;
+  }
+  log_ring_set_sync(sync != 0);
+  char buf[96];
+  snprintf(buf, sizeof(buf), "{\"sync\":%s,\"next\":%u,\"uart_dropped\":%u}", log_ring_sync() ? "true" : "false",
+           (unsigned)log_ring_next_seq(), (unsigned)log_ring_uart_dropped());
+  web_send(200, "application/json; charset=utf-8", buf);
+}
+
+void log_register_web_route_handlers()
+{
+  web_register_get("/log", log_api);
+  web_register_post("/log/mode", log_mode_api);
+}
@@ -18,12 +18,16 @@
 #include <sdkconfig.h>
 #include <string>
 
+#include "bench.h"
+#include "boot_timeline.h"
+#include "log_ring.h"
+#include "metrics.h"
 #include "ota_support.h"
 #include "pir312_monitor.h"
 #include "utils.h"
 #include "web_server.h"
-
-static const char* TAG = "WEB PAGE MAIN";
+#include "wifi_support.h"
+#include "ws2812b_support.h"
 
 #if defined(SOC_TEMPERATURE_SENSOR_SUPPORTED) && (SOC_TEMPERATURE_SENSOR_SUPPORTED)
 #include <driver/temperature_sensor.h>
@@ -41,27 +45,6 @@ static const char* TAG = "WEB PAGE MAIN";
 #include <esp_flash_encrypt.h>
 #endif
 
-// --- Simple runtime stats updated via events (avoid heavy dependencies) ---
-static uint32_t s_wifi_disconnect_count = 0;
-static uint32_t s_wifi_disconnect_reason = 0;
-static int64_t s_wifi_last_disconnect_us = 0;
-
-static void wifi_diag_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data)
-{
-  (void)arg;
-  if (base != WIFI_EVENT)
-  {
-    return;
-  }
-  if (id == WIFI_EVENT_STA_DISCONNECTED)
-  {
-    const wifi_event_sta_disconnected_t* ev = (const wifi_event_sta_disconnected_t*)data;
-    ++s_wifi_disconnect_count;
-    s_wifi_disconnect_reason = (uint32_t)(ev != NULL ? ev->reason : 0U);
-    s_wifi_last_disconnect_us = esp_timer_get_time();
-  }
-}
-
 // ---------- Utilities ----------
 static void format_mac(const uint8_t mac_bytes[6], char output[20])
 {
@@ -230,7 +213,7 @@ static std::string get_active_hostname(void)
 }
 
 // ---------- JSON helpers ----------
-static void json_escape_append(std::string& out, const char* s)
+void json_escape_append(std::string& out, const char* s)
 {
   if (s == NULL)
   {
@@ -315,7 +298,7 @@ static void json_append_kv_num_f(std::string& out, const char* key, double val,
     out.push_back(',');
 }
 
-static std::string build_inspect_json()
+std::string build_inspect_json()
 {
   const int64_t t0_us = esp_timer_get_time();
 
@@ -423,19 +406,45 @@ static std::string build_inspect_json()
   }
   json_append_kv_str(j, "country", cc, false);
 
+  wifi_reconnect_stats_t rc;
+  wifi_get_reconnect_stats(&rc);
   int64_t age_s = 0;
   char age_buf[32];
-  if (s_wifi_last_disconnect_us > 0)
+  if (rc.last_disconnect_us > 0)
   {
     const int64_t now_us = esp_timer_get_time();
-    age_s = (now_us - s_wifi_last_disconnect_us) / 1000000LL;
+    age_s = (now_us - rc.last_disconnect_us) / 1000000LL;
     (void)snprintf(age_buf, sizeof(age_buf), "%lld s ago", (long long)age_s);
   }
   else
   {
     (void)snprintf(age_buf, sizeof(age_buf), "-");
   }
-  json_append_kv_str(j, "last_disc_age", age_buf, true);
+  json_append_kv_str(j, "last_disc_age", age_buf, false);
+  json_append_kv_num_u(j, "disconnects", (unsigned long long)rc.disconnects, false);
+  json_append_kv_num_u(j, "last_disc_reason", (unsigned long long)rc.last_reason, false);
+  json_append_kv_num_u(j, "reconnect_attempts", (unsigned long long)rc.attempts, false);
+  json_append_kv_num_u(j, "reconnect_failures", (unsigned long long)rc.consecutive_failures, false);
+  json_append_kv_num_u(j, "reconnect_delay_ms", (unsigned long long)rc.next_delay_ms, false);
+  json_append_kv_str(j, "breaker", wifi_breaker_name(rc.breaker), false);
+  json_append_kv_num_u(j, "breaker_trips", (unsigned long long)rc.breaker_trips, false);
+  json_append_kv_num_u(j, "attempt_ms", (unsigned long long)rc.attempt_ms, false);
+  json_append_kv_num_u(j, "outage_ms", (unsigned long long)rc.outage_ms, false);
+  json_append_kv_num_u(j, "reconnect_cpu_us", (unsigned long long)rc.cpu_us, false);
+
+  wifi_connect_stats_t conn;
+  wifi_get_connect_stats(&conn);
+  json_append_kv_str(j, "connect_path", wifi_connect_path_name(conn.path), false);
+  json_append_kv_num_u(j, "time_to_ip_ms", (unsigned long long)conn.start_to_ip_ms, false);
+  json_append_kv_num_u(j, "boot_to_ip_ms", (unsigned long long)conn.boot_to_ip_ms, false);
+  json_append_kv_str(j, "fast_cached", conn.cached ? "yes" : "no", false);
+  json_append_kv_str(j, "static_ip", conn.static_ip ? "enabled" : "disabled", false);
+
+  wifi_power_stats_t ps;
+  wifi_get_power_stats(&ps);
+  json_append_kv_str(j, "ps_policy", wifi_power_policy_name(ps.policy), false);
+  json_append_kv_str(j, "ps_mode", ps.saving ? "min_modem" : "none", false);
+  json_append_kv_num_u(j, "ps_avg_ma_datasheet", (unsigned long long)ps.avg_ma_datasheet, true);
   j.push_back('}');
   j.push_back(',');
 
@@ -539,6 +548,24 @@ static std::string build_inspect_json()
   j.push_back('}');
   j.push_back(',');
 
+  // boot timeline (esp_timer us since app start)
+  j += "\"boot\":[";
+  {
+    boot_checkpoint_t marks[BOOT_TIMELINE_MAX];
+    const int n = boot_timeline_get(marks, BOOT_TIMELINE_MAX);
+    for (int i = 0; i < n; ++i)
+    {
+      j.push_back('{');
+      json_append_kv_str(j, "name", marks[i].name, false);
+      json_append_kv_num_i(j, "us", (long long)marks[i].us, true);
+      j.push_back('}');
+      if (i + 1 < n)
+        j.push_back(',');
+    }
+  }
+  j.push_back(']');
+  j.push_back(',');
+
   // rtos
   j += "\"rtos\":{\"tasks\":[";
 #if (configUSE_TRACE_FACILITY == 1)
@@ -684,21 +711,94 @@ static void handle_hw_details()
   web_send(200, "application/json; charset=utf-8", body.c_str());
 }
 
-void main_register_web_route_handlers()
+// POST /wifi/fast?static=0|1&forget=1 -- fast reconnect settings, used from the next boot on
+static void handle_wifi_fast()
+{
+  int v = 0;
+  if (web_query_int("static", &v))
+  {
+    wifi_set_static_ip(v != 0);
+  }
+  if (web_query_int("forget", &v) && v != 0)
+  {
+    wifi_forget_fast_connect();
+  }
+  wifi_connect_stats_t conn;
+  wifi_get_connect_stats(&conn);
+  char body[96];
+  (void)snprintf(body, sizeof(body), "{\"static_ip\":%s,\"fast_cached\":%s}", conn.static_ip ? "true" : "false",
+                 conn.cached ? "true" : "false");
+  web_send(200, "application/json", body);
+}
+
+static void send_wifi_power()
 {
-  static bool s_registered = false;
-  if (!s_registered)
+  wifi_power_stats_t ps;
+  wifi_get_power_stats(&ps);
+  char body[512];
+  int n = snprintf(body, sizeof(body), "{\"policy\":\"%s\",\"mode\":\"%s\",\"holds\":%u,\"idle_ms\":%u,\"current\":\"datasheet estimate\","
+                   "\"avg_ma_datasheet\":%u,\"modes\":{",
+                   wifi_power_policy_name(ps.policy), ps.saving ? "min_modem" : "none", (unsigned)ps.holds, (unsigned)ps.idle_ms,
+                   (unsigned)ps.avg_ma_datasheet);
+  for (int m = 0; m < 2 && n > 0 && n < (int)sizeof(body); ++m)
+  {
+    n += snprintf(body + n, sizeof(body) - (size_t)n, "%s\"%s\":{\"time_ms\":%u,\"entries\":%u,\"requests\":%u,\"datasheet_ma\":%u}",
+                  m ? "," : "", m ? "min_modem" : "none", (unsigned)ps.mode[m].time_ms, (unsigned)ps.mode[m].entries,
+                  (unsigned)ps.mode[m].requests, (unsigned)ps.mode[m].datasheet_ma);
+  }
+  if (n > 0 && n < (int)sizeof(body))
   {
-    CHECK_ERR(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &wifi_diag_event_handler, NULL));
-    s_registered = true;
+    (void)snprintf(body + n, sizeof(body) - (size_t)n, "}}");
   }
+  web_send(200, "application/json", body);
+}
 
+// POST /wifi/power?policy=auto|on|save
+static void handle_wifi_power()
+{
+  char policy[8] = "";
+  if (!web_query_str("policy", policy, sizeof(policy)))
+  {
+    web_send(400, "text/plain", "policy=auto|on|save");
+    return;
+  }
+  if (strcmp(policy, "auto") == 0)
+    wifi_power_set_policy(WIFI_POWER_AUTO);
+  else if (strcmp(policy, "on") == 0)
+    wifi_power_set_policy(WIFI_POWER_ALWAYS_ON);
+  else if (strcmp(policy, "save") == 0)
+    wifi_power_set_policy(WIFI_POWER_ALWAYS_SAVE);
+  else
+  {
+    web_send(400, "text/plain", "policy=auto|on|save");
+    return;
+  }
+  send_wifi_power();
+}
+
+// GET /metrics: the metrics registry (counters, gauges, histogram percentiles) as JSON.
+static void handle_metrics()
+{
+  char body[2048];
+  metrics_format_json(body, sizeof(body));
+  web_send(200, "application/json; charset=utf-8", body);
+}
+
+void main_register_web_route_handlers()
+{
   // Routes
   web_register_get("/", handle_root);
   web_register_get("/hw_details", handle_hw_details);
   web_register_get("/favicon.ico", handle_favicon);
   web_register_get("/style.css", handle_style_css);
+  web_register_post("/wifi/fast", handle_wifi_fast);
+  web_register_get("/wifi/power", send_wifi_power);
+  web_register_post("/wifi/power", handle_wifi_power);
+  web_register_get("/metrics", handle_metrics);
 
   pir312_register_web_route_handlers();
+  ws2812b_register_web_route_handlers();
   ota_register_web_route_handlers();
+  log_register_web_route_handlers();
+  bench_register_web_route_handlers();
 }
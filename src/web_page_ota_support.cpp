@@ -1,17 +1,35 @@
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <esp_log.h>
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include "ota_delta.h"
+#include "ota_inflate.h"
 #include "ota_support.h"
+#include "ota_verify.h"
+#include "ota_writer.h"
 #include "utils.h"
 #include "web_server.h"
 
 static const char* TAG = "ota_support";
 
+/* Image bytes go to the writer in full buffers. Raw uploads are received straight into them,
+ * gzip and delta uploads are decoded into them (image_put). */
+static uint8_t* s_buf = NULL;
+static size_t s_buf_cap = 0;
+static size_t s_buf_len = 0;
+static size_t s_image_len = 0;
+static size_t s_image_max = 0;
+static int64_t s_acquire_us = 0;
+static int s_err_code = 500;
+static char s_err[128];
+
 static void reboot_task(void* arg)
 {
   vTaskDelay(pdMS_TO_TICKS(1000));
@@ -27,11 +45,235 @@ static void h_get_ota_page(void)
   web_send_binary(200, "text/html; charset=utf-8", reinterpret_cast<const char*>(html_ota_start), size);
 }
 
+static bool acquire_image_buffer()
+{
+  const int64_t t0 = esp_timer_get_time();
+  s_buf = ota_writer_acquire(&s_buf_cap);
+  s_acquire_us += esp_timer_get_time() - t0;
+  s_buf_len = 0;
+  if (s_buf == NULL)
+  {
+    s_err_code = 500;
+    snprintf(s_err, sizeof(s_err), "esp_ota_write failed");
+    return false;
+  }
+  return true;
+}
+
+static bool submit_image_buffer()
+{
+  /* A wrong file (other chip or project) fails here, before anything past sector 0 is written. */
+  if (s_image_len == 0 && !ota_verify_image_header(s_buf, s_buf_len, s_err, sizeof(s_err)))
+  {
+    s_err_code = 400;
+    return false;
+  }
+  ota_verify_update(s_buf, s_buf_len);
+  ota_writer_submit(s_buf, s_buf_len);
+  s_image_len += s_buf_len;
+  s_buf = NULL;
+  s_buf_len = 0;
+  return true;
+}
+
+/* ota_inflate sink: pack decoded bytes into writer buffers. */
+static bool image_put(const uint8_t* data, size_t len)
+{
+  while (len > 0U)
+  {
+    if (s_buf == NULL && !acquire_image_buffer())
+    {
+      return false;
+    }
+    const size_t n = (s_buf_cap - s_buf_len < len) ? s_buf_cap - s_buf_len : len;
+    if (s_image_len + s_buf_len + n > s_image_max)
+    {
+      s_err_code = 400;
+      snprintf(s_err, sizeof(s_err), "Decompressed image larger than %u bytes", (unsigned)s_image_max);
+      return false;
+    }
+    memcpy(s_buf + s_buf_len, data, n);
+    s_buf_len += n;
+    data += n;
+    len -= n;
+    if (s_buf_len == s_buf_cap && !submit_image_buffer())
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Patch bytes (after gzip decoding, if any) go through the delta decoder into image_put. */
+static bool delta_put(const uint8_t* data, size_t len)
+{
+  const esp_err_t err = ota_delta_feed(data, len, image_put);
+  if (err == ESP_ERR_INVALID_VERSION)
+  {
+    s_err_code = 400;
+    snprintf(s_err, sizeof(s_err), "Patch was made for another running firmware");
+  }
+  else if (err == ESP_ERR_INVALID_RESPONSE)
+  {
+    s_err_code = 400;
+    snprintf(s_err, sizeof(s_err), "Corrupt delta patch");
+  }
+  return err == ESP_OK;
+}
+
+/* One web_recv() of up to len bytes, retrying on timeout. Returns <= 0 on failure. */
+static int recv_some(uint8_t* buf, size_t len, int64_t* recv_us)
+{
+  for (;;)
+  {
+    const int64_t t0 = esp_timer_get_time();
+    const int r = web_recv(buf, len);
+    *recv_us += esp_timer_get_time() - t0;
+    if (r != -2)
+    {
+      return r;
+    }
+  }
+}
+
+static void fail_update(int code, const char* msg)
+{
+  ESP_LOGE(TAG, "update failed: %s", msg);
+  ota_writer_abort();
+  ota_verify_abort();
+  ota_inflate_end();
+  s_buf = NULL;
+  web_send(code, "text/plain", msg);
+}
+
+/* Verify and close the update session, then switch the boot partition. On failure the error
+ * reply has been sent. */
+static bool finalize_update(const esp_partition_t* update_part, ota_report_t* report)
+{
+  /* Check digest / signature before esp_ota_end(), so a bad image never becomes bootable. */
+  if (!ota_verify_finish(NULL, s_err, sizeof(s_err)))
+  {
+    fail_update(400, s_err);
+    return false;
+  }
+
+  /* Drain the writer and finalize (esp_ota_end verifies the image). */
+  esp_err_t result = ota_writer_finish(report);
+  CHECK_ERR(result);
+  if (result != ESP_OK)
+  {
+    web_send(500, "text/plain", "OTA write or image verification failed");
+    return false;
+  }
+
+  result = esp_ota_set_boot_partition(update_part);
+  CHECK_ERR(result);
+  if (result != ESP_OK)
+  {
+    web_send(500, "text/plain", "set_boot_partition failed");
+    return false;
+  }
+  return true;
+}
+
+static int format_report(char* msg, size_t size, const ota_report_t* report)
+{
+  return snprintf(msg,
+                  size,
+                  "OK. Rebooting in 1s...\n"
+                  "%u bytes in %u ms (%u KiB/s)\n"
+                  "receive: %u ms in recv, %u ms waiting for a free buffer\n"
+                  "flash: %u ms write, %u ms erase, %u ms idle, %u ms verify\n"
+                  "flash scheduling: %u ms waiting for LED gaps, %u ms for the duty budget\n"
+                  "LED: %u frames, %u missed deadlines, %u deferred for flash, %u skipped for erases\n",
+                  (unsigned)report->bytes,
+                  (unsigned)report->total_ms,
+                  (unsigned)report->kib_per_s,
+                  (unsigned)report->recv_ms,
+                  (unsigned)report->buf_wait_ms,
+                  (unsigned)report->write_ms,
+                  (unsigned)report->erase_ms,
+                  (unsigned)report->idle_ms,
+                  (unsigned)report->end_ms,
+                  (unsigned)report->gap_wait_ms,
+                  (unsigned)report->duty_wait_ms,
+                  (unsigned)report->led_frames,
+                  (unsigned)report->led_missed,
+                  (unsigned)report->led_deferred,
+                  (unsigned)report->led_skipped);
+}
+
+static void reply_and_reboot(const char* msg)
+{
+  ESP_LOGI(TAG, "%s", msg);
+
+  web_set_resp_header("Connection", "close");
+
+  web_send(200, "text/plain", msg);
+  CHECK_XTASK_OK(xTaskCreate(reboot_task, "ota_reboot", 2048, NULL, 5, NULL)); // <-- now checked
+}
+
+/* Expected digest / signature (of the decoded image) travel in headers; the image is hashed as it
+ * streams in. On failure the error reply has been sent. */
+static bool begin_verify(bool need_digest)
+{
+  char sha_hex[72] = "";
+  char sig_b64[520] = ""; /* RSA-3072 at most; the request header limit is 1 KB */
+  (void)web_header_str("X-Image-SHA256", sha_hex, sizeof(sha_hex));
+  (void)web_header_str("X-Image-Signature", sig_b64, sizeof(sig_b64));
+  if (need_digest && sha_hex[0] == '\0')
+  {
+    web_send(400, "text/plain", "Delta updates need X-Image-SHA256 of the result");
+    return false;
+  }
+  if (!ota_verify_begin(sha_hex, sig_b64, s_err, sizeof(s_err)))
+  {
+    web_send(400, "text/plain", s_err);
+    return false;
+  }
+  return true;
+}
+
+/* Resumable uploads: POST /update/chunk with "Content-Range: bytes first-last/total". The writer
+ * session, the hash state and the committed offset (s_image_len, bytes handed to the writer)
+ * survive between requests, so after a dropped connection the client reads GET /update/status
+ * and continues from "offset". A chunk that does not start there is refused with 416, as is a
+ * first chunk too short for the image header check (OTA_VERIFY_HEADER_BYTES); neither ends the
+ * session. Accepted chunks are answered with 206 until the last one completes the image. Raw
+ * images only. */
+#define OTA_SESSION_IDLE_US (10LL * 60 * 1000 * 1000)
+
+static const esp_partition_t* s_session_part = NULL;
+static size_t s_session_size = 0;
+static int64_t s_session_touch_us = 0;
+static int64_t s_session_recv_us = 0;
+
+static void session_abort()
+{
+  if (s_session_part != NULL)
+  {
+    ESP_LOGW(TAG, "resumable session dropped at %u of %u bytes", (unsigned)s_image_len, (unsigned)s_session_size);
+    ota_writer_abort();
+    ota_verify_abort();
+    s_session_part = NULL;
+    s_buf = NULL;
+  }
+}
+
+static void session_expire()
+{
+  if (s_session_part != NULL && esp_timer_get_time() - s_session_touch_us > OTA_SESSION_IDLE_US)
+  {
+    session_abort();
+  }
+}
+
 static void h_post_update(void)
 {
   esp_err_t result = ESP_OK;
-  esp_ota_handle_t ota = (esp_ota_handle_t)0;
-  bool ota_opened = false;
+
+  /* A plain upload replaces an unfinished resumable one. */
+  session_abort();
 
   /* Validate Content-Length first. */
   const size_t content_len = web_content_length(); /* provided by web_server.* in your API style */
@@ -48,84 +290,411 @@ static void h_post_update(void)
     web_send(500, "text/plain", "No OTA partition");
     return;
   }
+  if (content_len > update_part->size)
+  {
+    web_send(400, "text/plain", "Image larger than the OTA partition");
+    return;
+  }
+
+  /* gzip and delta uploads are decoded on the fly (a delta patch is usually gzipped as well).
+   * X-Image-Size (the decoded size) bounds the erase; without it the whole partition is erased
+   * ahead of the writes. */
+  char hdr[32] = "";
+  const bool gzip = web_header_str("Content-Encoding", hdr, sizeof(hdr)) && strcmp(hdr, "gzip") == 0;
+  const bool delta = web_header_str("Content-Type", hdr, sizeof(hdr)) && strcmp(hdr, "application/x-ota-delta") == 0;
+  size_t image_size = content_len;
+  if (gzip || delta)
+  {
+    image_size = update_part->size;
+    if (web_header_str("X-Image-Size", hdr, sizeof(hdr)))
+    {
+      const unsigned long v = strtoul(hdr, NULL, 10);
+      if (v == 0UL || v > update_part->size)
+      {
+        web_send(400, "text/plain", "X-Image-Size out of range");
+        return;
+      }
+      image_size = (size_t)v;
+    }
+  }
+
+  if (!begin_verify(delta))
+  {
+    return;
+  }
 
-  /* Begin OTA write session. */
-  result = esp_ota_begin(update_part, OTA_SIZE_UNKNOWN, &ota);
+  /* Begin OTA write session: from here on this handler only receives, the writer task writes. */
+  result = ota_writer_begin(update_part, image_size);
   CHECK_ERR(result);
   if (result != ESP_OK)
   {
+    ota_verify_abort();
     web_send(500, "text/plain", "esp_ota_begin failed");
     return;
   }
-  ota_opened = true;
+  if (gzip)
+  {
+    result = ota_inflate_begin();
+    CHECK_ERR(result);
+    if (result != ESP_OK)
+    {
+      fail_update(500, "Out of memory for the gzip decoder");
+      return;
+    }
+  }
+  if (delta)
+  {
+    result = ota_delta_begin(esp_ota_get_running_partition());
+    CHECK_ERR(result);
+    if (result != ESP_OK)
+    {
+      fail_update(500, "No running partition to patch");
+      return;
+    }
+  }
+
+  s_buf = NULL;
+  s_image_len = 0;
+  s_image_max = image_size;
+  s_acquire_us = 0;
 
-  /* Receive and write body. */
-  uint8_t buf[4096];
   size_t remaining = content_len;
+  int64_t recv_us = 0;
+  int64_t decode_us = 0;
 
   while (remaining > 0U)
   {
-    size_t to_read = (remaining > sizeof(buf)) ? sizeof(buf) : remaining;
-    int r = web_recv(buf, to_read);
-    if (r == -2)
+    if (gzip || delta)
     {
-      /* Timeout: retry the same chunk. */
+      uint8_t in[1024];
+      const int r = recv_some(in, (remaining > sizeof(in)) ? sizeof(in) : remaining, &recv_us);
+      if (r <= 0)
+      {
+        fail_update(500, "recv failed");
+        return;
+      }
+      const int64_t a0 = s_acquire_us;
+      const int64_t t0 = esp_timer_get_time();
+      if (gzip)
+      {
+        result = ota_inflate_feed(in, (size_t)r, delta ? delta_put : image_put);
+      }
+      else
+      {
+        result = delta_put(in, (size_t)r) ? ESP_OK : ESP_FAIL;
+      }
+      decode_us += (esp_timer_get_time() - t0) - (s_acquire_us - a0);
+      if (gzip && result == ESP_ERR_INVALID_RESPONSE)
+      {
+        fail_update(400, "Corrupt gzip stream");
+        return;
+      }
+      if (result != ESP_OK)
+      {
+        fail_update(s_err_code, s_err);
+        return;
+      }
+      remaining -= (size_t)r;
       continue;
     }
-    if (r <= 0)
+
+    /* Raw image: receive into writer buffers, filling each one completely before handing it over. */
+    if (!acquire_image_buffer())
+    {
+      fail_update(s_err_code, s_err);
+      return;
+    }
+    const size_t want = (remaining > s_buf_cap) ? s_buf_cap : remaining;
+    while (s_buf_len < want)
     {
-      if (ota_opened)
+      const int r = recv_some(s_buf + s_buf_len, want - s_buf_len, &recv_us);
+      if (r <= 0)
       {
-        (void)esp_ota_abort(ota);
-        ota_opened = false;
+        fail_update(500, "recv failed");
+        return;
       }
-      web_send(500, "text/plain", "recv failed");
+      s_buf_len += (size_t)r;
+    }
+    if (!submit_image_buffer())
+    {
+      fail_update(s_err_code, s_err);
       return;
     }
+    remaining -= want;
+  }
 
-    result = esp_ota_write(ota, (const void*)buf, (size_t)r);
-    CHECK_ERR(result);
-    if (result != ESP_OK)
+  if (gzip)
+  {
+    const bool complete = ota_inflate_complete();
+    ota_inflate_end();
+    if (!complete)
     {
-      if (ota_opened)
-      {
-        (void)esp_ota_abort(ota);
-        ota_opened = false;
-      }
-      web_send(500, "text/plain", "esp_ota_write failed");
+      fail_update(400, "Truncated gzip stream");
       return;
     }
+  }
+  if (delta && !ota_delta_complete())
+  {
+    fail_update(400, "Truncated delta patch");
+    return;
+  }
+  if (gzip || delta)
+  {
+    if (s_buf_len > 0U && !submit_image_buffer())
+    {
+      fail_update(s_err_code, s_err);
+      return;
+    }
+  }
+
+  ota_report_t report = {};
+  if (!finalize_update(update_part, &report))
+  {
+    return;
+  }
+  report.recv_ms = (uint32_t)(recv_us / 1000);
+  report.wire_bytes = (uint32_t)content_len;
+  report.decode_ms = (uint32_t)(decode_us / 1000);
+
+  char msg[768];
+  int len = format_report(msg, sizeof(msg), &report);
+  if ((gzip || delta) && report.wire_bytes > 0U && report.bytes > 0U && len > 0 && (size_t)len < sizeof(msg))
+  {
+    /* Saved time: what the missing bytes would have cost at the measured receive rate. */
+    const uint32_t saved_ms = (report.bytes > report.wire_bytes)
+                                  ? (uint32_t)((uint64_t)report.recv_ms * (report.bytes - report.wire_bytes) / report.wire_bytes)
+                                  : 0U;
+    len += snprintf(msg + len,
+                    sizeof(msg) - (size_t)len,
+                    "%s: %u -> %u bytes (%u%% of the image), %u ms decode, ~%u ms upload time saved\n",
+                    delta ? (gzip ? "delta+gzip" : "delta") : "gzip",
+                    (unsigned)report.wire_bytes,
+                    (unsigned)report.bytes,
+                    (unsigned)((uint64_t)report.wire_bytes * 100 / report.bytes),
+                    (unsigned)report.decode_ms,
+                    (unsigned)saved_ms);
+  }
+  if (delta && len > 0 && (size_t)len < sizeof(msg))
+  {
+    ota_delta_stats_t ds = {};
+    ota_delta_get_stats(&ds);
+    snprintf(msg + len,
+             sizeof(msg) - (size_t)len,
+             "delta: %u byte patch; %u bytes copied from the running image, %u patched, %u literal\n",
+             (unsigned)ds.patch_bytes,
+             (unsigned)ds.copy_bytes,
+             (unsigned)ds.diff_bytes,
+             (unsigned)ds.data_bytes);
+  }
+  reply_and_reboot(msg);
+}
+
+static void send_session_status(int code)
+{
+  const bool active = (s_session_part != NULL);
+  char json[128];
+  const int len = snprintf(json,
+                           sizeof(json),
+                           "{\"active\":%s,\"offset\":%u,\"size\":%u,\"idle_ms\":%u}",
+                           active ? "true" : "false",
+                           (unsigned)(active ? s_image_len : 0U),
+                           (unsigned)(active ? s_session_size : 0U),
+                           (unsigned)(active ? (esp_timer_get_time() - s_session_touch_us) / 1000 : 0));
+  web_send_binary(code, "application/json", json, (size_t)len);
+}
 
-    remaining -= (size_t)r;
+static bool parse_content_range(const char* v, size_t* first, size_t* last, size_t* total)
+{
+  unsigned long a = 0, b = 0, t = 0;
+  char tail = 0;
+  if (sscanf(v, "bytes %lu-%lu/%lu%c", &a, &b, &t, &tail) != 3 || a > b || b >= t)
+  {
+    return false;
   }
+  *first = (size_t)a;
+  *last = (size_t)b;
+  *total = (size_t)t;
+  return true;
+}
 
-  /* Finalize and set boot partition. */
-  result = esp_ota_end(ota);
+static bool session_begin(size_t total)
+{
+  const esp_partition_t* update_part = esp_ota_get_next_update_partition(NULL);
+  if (update_part == NULL)
+  {
+    web_send(500, "text/plain", "No OTA partition");
+    return false;
+  }
+  if (total > update_part->size)
+  {
+    web_send(400, "text/plain", "Image larger than the OTA partition");
+    return false;
+  }
+  if (!begin_verify(false))
+  {
+    return false;
+  }
+  const esp_err_t result = ota_writer_begin(update_part, total);
   CHECK_ERR(result);
   if (result != ESP_OK)
   {
-    /* When esp_ota_end fails, OTA is already closed/invalid; no abort needed. */
-    web_send(500, "text/plain", "esp_ota_end failed");
+    ota_verify_abort();
+    web_send(500, "text/plain", "esp_ota_begin failed");
+    return false;
+  }
+  s_session_part = update_part;
+  s_session_size = total;
+  s_session_recv_us = 0;
+  s_session_touch_us = esp_timer_get_time();
+  s_buf = NULL;
+  s_image_len = 0;
+  s_image_max = total;
+  ESP_LOGI(TAG, "resumable session for %u bytes", (unsigned)total);
+  return true;
+}
+
+static void h_get_update_status(void)
+{
+  session_expire();
+  send_session_status(200);
+}
+
+static void h_post_update_chunk(void)
+{
+  session_expire();
+
+  const size_t content_len = web_content_length();
+  char range[64];
+  size_t first = 0, last = 0, total = 0;
+  if (content_len == 0U || !web_header_str("Content-Range", range, sizeof(range)) || !parse_content_range(range, &first, &last, &total) ||
+      last - first + 1U != content_len)
+  {
+    web_send(400, "text/plain", "Content-Range: bytes first-last/total matching the body is required");
     return;
   }
-  ota_opened = false;
 
-  result = esp_ota_set_boot_partition(update_part);
-  CHECK_ERR(result);
-  if (result != ESP_OK)
+  /* A chunk at 0 (re)starts the session, unless it repeats the first chunk of a fresh one. */
+  if (first == 0U && !(s_session_part != NULL && s_image_len == 0U && total == s_session_size))
   {
-    web_send(500, "text/plain", "set_boot_partition failed");
+    session_abort();
+    if (!session_begin(total))
+    {
+      return;
+    }
+  }
+  if (s_session_part == NULL || total != s_session_size || first != s_image_len ||
+      (s_image_len == 0U && content_len < OTA_VERIFY_HEADER_BYTES && content_len < total))
+  {
+    send_session_status(416);
     return;
   }
 
-  web_set_resp_header("Connection", "close");
+  s_session_touch_us = esp_timer_get_time();
+  size_t remaining = content_len;
+  while (remaining > 0U)
+  {
+    if (!acquire_image_buffer())
+    {
+      session_abort();
+      web_send(s_err_code, "text/plain", s_err);
+      return;
+    }
+    const size_t want = (remaining > s_buf_cap) ? s_buf_cap : remaining;
+    while (s_buf_len < want)
+    {
+      const int r = recv_some(s_buf + s_buf_len, want - s_buf_len, &s_session_recv_us);
+      if (r <= 0)
+      {
+        /* Only whole buffers are committed; the client resumes from the status offset. */
+        ota_writer_discard(s_buf);
+        s_buf = NULL;
+        ESP_LOGW(TAG, "chunk cut short, committed %u of %u bytes", (unsigned)s_image_len, (unsigned)s_session_size);
+        web_send(500, "text/plain", "recv failed, resume from /update/status");
+        return;
+      }
+      s_buf_len += (size_t)r;
+    }
+    if (!submit_image_buffer())
+    {
+      session_abort();
+      web_send(s_err_code, "text/plain", s_err);
+      return;
+    }
+    remaining -= want;
+  }
+  s_session_touch_us = esp_timer_get_time();
 
-  web_send(200, "text/plain", "OK. Rebooting in 1s...");
-  CHECK_XTASK_OK(xTaskCreate(reboot_task, "ota_reboot", 2048, NULL, 5, NULL)); // <-- now checked
+  if (s_image_len < s_session_size)
+  {
+    send_session_status(206);
+    return;
+  }
+
+  const esp_partition_t* update_part = s_session_part;
+  s_session_part = NULL;
+  ota_report_t report = {};
+  if (!finalize_update(update_part, &report))
+  {
+    return;
+  }
+  report.recv_ms = (uint32_t)(s_session_recv_us / 1000);
+  report.wire_bytes = report.bytes;
+
+  char msg[768];
+  format_report(msg, sizeof(msg), &report);
+  reply_and_reboot(msg);
+}
+
+static void send_budget()
+{
+  ota_writer_config_t cfg = {};
+  ota_writer_get_config(&cfg);
+  char json[128];
+  snprintf(json,
+           sizeof(json),
+           "{\"erase_bytes\":%u,\"write_slice\":%u,\"duty_pct\":%u,\"led_sync\":%s}",
+           (unsigned)cfg.erase_chunk,
+           (unsigned)cfg.write_slice,
+           (unsigned)cfg.duty_pct,
+           cfg.led_sync ? "true" : "false");
+  web_send(200, "application/json", json);
+}
+
+// POST /ota/budget?erase_kb=4&slice=512&duty=60&sync=1 (any subset)
+static void h_post_ota_budget(void)
+{
+  ota_writer_config_t cfg = {};
+  ota_writer_get_config(&cfg);
+  int v = 0;
+  if (web_query_int("erase_kb", &v))
+    cfg.erase_chunk = (v > 0) ? (uint32_t)v * 1024U : 0U;
+  if (web_query_int("slice", &v))
+    cfg.write_slice = (v > 0) ? (uint32_t)v : 0U;
+  if (web_query_int("duty", &v))
+    cfg.duty_pct = (v > 0) ? (uint32_t)v : 0U;
+  if (web_query_int("sync", &v))
+    cfg.led_sync = (v != 0);
+
+  const esp_err_t err = ota_writer_set_config(&cfg);
+  if (err == ESP_ERR_INVALID_STATE)
+  {
+    web_send(400, "text/plain", "Update in progress");
+    return;
+  }
+  if (err != ESP_OK)
+  {
+    web_send(400, "text/plain", "erase_kb: multiple of 4, slice: 16..4096 in steps of 16, duty: 5..100");
+    return;
+  }
+  send_budget();
 }
 
 void ota_register_web_route_handlers(void)
 {
   web_register_get("/ota", h_get_ota_page);
   web_register_post("/update", h_post_update);
+  web_register_get("/update/status", h_get_update_status);
+  web_register_post("/update/chunk", h_post_update_chunk);
+  web_register_get("/ota/budget", send_budget);
+  web_register_post("/ota/budget", h_post_ota_budget);
 }
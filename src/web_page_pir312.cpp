@@ -4,23 +4,29 @@
 #include "pir312_monitor.h"
 #include "web_server.h"
 
-static void pir312_status_api()
+size_t pir312_format_status(char* buf, size_t size)
 {
-  char buf[256];
   size_t len = 0;
 
-  len += snprintf(buf + len, sizeof(buf) - len, "{");
+  len += snprintf(buf + len, size - len, "{");
 
-  len += snprintf(buf + len, sizeof(buf) - len, "\"sensors\":[");
+  len += snprintf(buf + len, size - len, "\"sensors\":[");
   for (int i = 0; i < pir312_count(); ++i)
   {
     const int st = pir312_get_state(i);
-    len += snprintf(buf + len, sizeof(buf) - len, "%s%d", (i > 0) ? "," : "", st);
+    len += snprintf(buf + len, size - len, "%s%d", (i > 0) ? "," : "", st);
   }
-  len += snprintf(buf + len, sizeof(buf) - len, "], \"light_raw\":%d, \"light\":%d", light_sensor_get_value(), light_sensor_is_light());
+  len += snprintf(buf + len, size - len, "], \"light_raw\":%d, \"light\":%d", light_sensor_get_value(), light_sensor_is_light());
 
-  len += snprintf(buf + len, sizeof(buf) - len, "}");
+  len += snprintf(buf + len, size - len, "}");
+
+  return len;
+}
 
+static void pir312_status_api()
+{
+  char buf[256];
+  pir312_format_status(buf, sizeof(buf));
   web_send(200, "application/json; charset=utf-8", buf);
 }
 
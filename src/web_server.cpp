@@ -6,12 +6,15 @@
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <mbedtls/base64.h>
 
+#include "metrics.h"
 #include "utils.h"
 #include "web_server.h"
+#include "wifi_support.h"
 
 static const char* TAG = "web_server";
 
@@ -22,13 +25,20 @@ static httpd_req_t* s_cur_req = NULL;
 // --- Internal trampoline to call user handler (void func(void)) ---
 static esp_err_t call_user_handler(httpd_req_t* req)
 {
+  static metric_t s_m_requests = metrics_counter("http.requests");
+  static metric_t s_m_req_us = metrics_histogram("http.req_us"); // handler time, body transfer included
+  const int64_t t0 = esp_timer_get_time();
   s_cur_req = req;
   http_handler_fn fn = (http_handler_fn)req->user_ctx;
+  wifi_power_hold(); // radio stays on for the whole request, long uploads included
   if (fn != NULL)
   {
     (*fn)();
   }
+  wifi_power_release();
   s_cur_req = NULL;
+  metrics_add(s_m_requests, 1);
+  metrics_record(s_m_req_us, (uint32_t)(esp_timer_get_time() - t0));
   return ESP_OK;
 }
 
@@ -57,6 +67,7 @@ extern "C" bool web_start()
   cfg.server_port = 80;
   cfg.lru_purge_enable = true;
   cfg.stack_size = 12288;
+  cfg.max_uri_handlers = 32; // default is 8, fewer than the pages register
   cfg.uri_match_fn = httpd_uri_match_wildcard;
 
   CHECK_ERR(httpd_start(&s_server, &cfg));
@@ -231,3 +242,43 @@ bool web_set_resp_header(const char* name, const char* value)
   }
   return httpd_resp_set_hdr(s_cur_req, name, value) == ESP_OK;
 }
+
+bool web_header_str(const char* name, char* out, size_t size)
+{
+  if (s_cur_req == NULL || name == NULL || out == NULL || size == 0U)
+  {
+    return false;
+  }
+  return httpd_req_get_hdr_value_str(s_cur_req, name, out, size) == ESP_OK;
+}
+
+bool web_query_str(const char* key, char* out, size_t size)
+{
+  if (s_cur_req == NULL || key == NULL || out == NULL || size == 0U)
+  {
+    return false;
+  }
+  char query[128];
+  if (httpd_req_get_url_query_str(s_cur_req, query, sizeof(query)) != ESP_OK)
+  {
+    return false;
+  }
+  return httpd_query_key_value(query, key, out, size) == ESP_OK;
+}
+
+bool web_query_int(const char* key, int* out)
+{
+  char val[16];
+  if (out == NULL || !web_query_str(key, val, sizeof(val)))
+  {
+    return false;
+  }
+  char* end = NULL;
+  const long v = strtol(val, &end, 10);
+  if (end == val || *end != '\0')
+  {
+    return false;
+  }
+  *out = (int)v;
+  return true;
+}
@@ -1,14 +1,21 @@
 #include <esp_event.h>
 #include <esp_log.h>
 #include <esp_netif.h>
+#include <esp_random.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <nvs.h>
 #include <nvs_flash.h>
 #include <stdbool.h>
 #include <string.h>
 #include <wifi_provisioning/manager.h>
 #include <wifi_provisioning/scheme_softap.h>
 
+#include "boot_timeline.h"
+#include "metrics.h"
 #include "utils.h"
 #include "wifi_support.h"
 
@@ -20,6 +27,388 @@ static const char* s_setup_ap_pass = "12345678";
 static const char* s_prov_pop = "abcd1234";
 static bool got_ip = false;
 
+/* Fast reconnect: the AP and lease of the last successful connection are kept in NVS. At boot the
+ * STA is pinned to that BSSID/channel (no full scan) and, when enabled, takes the cached lease as a
+ * static IP (no DHCP round trip). Any disconnect before the first IP drops back to a full scan and
+ * DHCP. Only use the static IP on networks where the address is reserved for this device. */
+#ifndef WIFI_FAST_STATIC_IP
+#define WIFI_FAST_STATIC_IP 0
+#endif
+
+#define WIFI_FAST_NVS_NS "wifi_fast"
+#define WIFI_FAST_CACHE_VERSION 1
+
+typedef struct
+{
+  uint32_t version;
+  uint8_t ssid[32];
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t reserved;
+  uint32_t ip;
+  uint32_t netmask;
+  uint32_t gw;
+  uint32_t dns;
+} wifi_fast_cache_t;
+
+static esp_netif_t* s_sta = NULL;
+static wifi_fast_cache_t s_cache;
+static bool s_cache_valid = false;
+static bool s_static_ip = WIFI_FAST_STATIC_IP;
+static bool s_pinned = false;         // STA config currently pinned to the cached BSSID/channel
+static bool s_static_applied = false; // DHCP client stopped, cached lease set as static IP
+static bool s_first_ip_done = false;
+static wifi_connect_path_t s_path = WIFI_CONNECT_NONE;
+static int64_t s_start_us = 0;
+static uint32_t s_boot_to_ip_ms = 0;
+static uint32_t s_start_to_ip_ms = 0;
+
+/* Reconnect pacing. The first retry after a loss is immediate, then the delay doubles from
+ * WIFI_BACKOFF_MIN_MS up to WIFI_BACKOFF_MAX_MS, half of it randomized so devices behind the same AP
+ * do not retry in lockstep. After WIFI_BREAKER_FAILURES failures in a row the breaker opens: no
+ * attempts for WIFI_BREAKER_COOLDOWN_MS, then one probe (half-open) that either closes it (IP) or
+ * reopens it. WIFI_RECONNECT_BACKOFF 0 restores the immediate reconnect loop for comparison. */
+#ifndef WIFI_RECONNECT_BACKOFF
+#define WIFI_RECONNECT_BACKOFF 1
+#endif
+#define WIFI_BACKOFF_MIN_MS 500
+#define WIFI_BACKOFF_MAX_MS 30000
+#define WIFI_BREAKER_FAILURES 10
+#define WIFI_BREAKER_COOLDOWN_MS 120000
+
+static esp_timer_handle_t s_retry_timer = NULL;
+// s_rc, s_attempt_us and s_outage_us: updated by the event and esp_timer tasks, read by /wifi/status.
+static portMUX_TYPE s_rc_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_reconnect_stats_t s_rc = {};
+static metric_t s_m_disconnects = NULL;
+static metric_t s_m_connected = NULL;
+static int64_t s_attempt_us = 0; // start of the connect attempt in progress, 0 if none
+static int64_t s_outage_us = 0;  // start of the current outage, 0 while connected
+
+static uint32_t schedule_reconnect(void);
+
+static void connect_now(void)
+{
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&s_rc_lock);
+  s_attempt_us = now_us;
+  ++s_rc.attempts;
+  portEXIT_CRITICAL(&s_rc_lock);
+  const esp_err_t err = esp_wifi_connect();
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(err));
+    portENTER_CRITICAL(&s_rc_lock);
+    s_attempt_us = 0;
+    portEXIT_CRITICAL(&s_rc_lock);
+    schedule_reconnect(); // no disconnect event will follow
+  }
+}
+
+static void retry_timer_cb(void* arg)
+{
+  const int64_t t0 = esp_timer_get_time();
+  portENTER_CRITICAL(&s_rc_lock);
+  const bool probe = (s_rc.breaker == WIFI_BREAKER_OPEN);
+  if (probe)
+  {
+    s_rc.breaker = WIFI_BREAKER_HALF_OPEN;
+  }
+  portEXIT_CRITICAL(&s_rc_lock);
+  if (probe)
+  {
+    ESP_LOGI(TAG, "Reconnect breaker half-open: probing");
+  }
+  if (!got_ip)
+  {
+    connect_now();
+  }
+  const uint32_t cpu_us = (uint32_t)(esp_timer_get_time() - t0);
+  portENTER_CRITICAL(&s_rc_lock);
+  s_rc.cpu_us += cpu_us;
+  portEXIT_CRITICAL(&s_rc_lock);
+}
+
+static uint32_t backoff_ms(uint32_t retries)
+{
+  uint32_t d = WIFI_BACKOFF_MIN_MS;
+  for (uint32_t i = 1; i < retries && d < WIFI_BACKOFF_MAX_MS; ++i)
+  {
+    d *= 2;
+  }
+  d = (d < WIFI_BACKOFF_MAX_MS) ? d : WIFI_BACKOFF_MAX_MS;
+  return d / 2 + esp_random() % (d / 2 + 1);
+}
+
+/* Arm the retry timer for the next attempt and return its delay. The attempt always runs from the
+ * timer, even without a delay: connect_now() comes back here when esp_wifi_connect() fails at once,
+ * and calling it directly would recurse until the stack overflows. */
+static uint32_t schedule_reconnect(void)
+{
+  uint32_t delay_ms = 0;
+  bool tripped = false;
+  portENTER_CRITICAL(&s_rc_lock);
+  const uint32_t failures = ++s_rc.consecutive_failures;
+#if WIFI_RECONNECT_BACKOFF
+  if (s_rc.breaker == WIFI_BREAKER_HALF_OPEN || failures >= WIFI_BREAKER_FAILURES)
+  {
+    if (s_rc.breaker == WIFI_BREAKER_CLOSED)
+    {
+      ++s_rc.breaker_trips;
+    }
+    s_rc.breaker = WIFI_BREAKER_OPEN;
+    delay_ms = WIFI_BREAKER_COOLDOWN_MS;
+    tripped = true;
+  }
+  else if (failures > 1)
+  {
+    delay_ms = backoff_ms(failures - 1);
+  }
+#endif
+  s_rc.next_delay_ms = delay_ms;
+  portEXIT_CRITICAL(&s_rc_lock);
+  if (tripped)
+  {
+    ESP_LOGW(TAG, "Reconnect breaker open after %u failures; next probe in %u s", (unsigned)failures, (unsigned)(delay_ms / 1000));
+  }
+  if (s_retry_timer == NULL)
+  {
+    ESP_LOGE(TAG, "No retry timer; not reconnecting");
+    return delay_ms;
+  }
+  (void)esp_timer_stop(s_retry_timer);
+  CHECK_ERR(esp_timer_start_once(s_retry_timer, (uint64_t)delay_ms * 1000ULL));
+  return delay_ms;
+}
+
+/* Power save. Under the auto policy the STA idles in modem sleep (WIFI_PS_MIN_MODEM, radio wakes
+ * for each DTIM beacon) and switches to WIFI_PS_NONE while an HTTP request is being served (OTA
+ * uploads included) or a realtime LED stream runs, dropping back after WIFI_PS_QUIET_MS without
+ * activity. The quiet period is a one-shot timer armed by the end of the last activity, so nothing
+ * wakes the CPU while the radio sleeps. The device cannot measure its current: the per-mode figures
+ * are datasheet values (ESP32 datasheet, RF receive / modem sleep at DTIM 1), check with a meter. */
+#ifndef WIFI_PS_POLICY
+#define WIFI_PS_POLICY WIFI_POWER_AUTO
+#endif
+#ifndef WIFI_PS_QUIET_MS
+#define WIFI_PS_QUIET_MS 30000
+#endif
+#define WIFI_PS_NONE_MA 115 // datasheet: receiver always on
+#define WIFI_PS_MODEM_MA 30 // datasheet: modem sleep, DTIM 1
+
+static esp_timer_handle_t s_ps_timer = NULL;
+static SemaphoreHandle_t s_ps_mutex = NULL; // a mutex, not a spinlock: the driver call is made under it
+static wifi_power_policy_t s_ps_policy = WIFI_PS_POLICY;
+static bool s_ps_saving = false;    // current mode is WIFI_PS_MIN_MODEM
+static bool s_ps_armed = false;     // quiet period timer running
+static uint32_t s_ps_holds = 0;
+static int64_t s_ps_activity_us = 0; // last hold/release or stream activity
+static int64_t s_ps_since_us = 0;    // entry into the current mode
+static wifi_power_mode_stats_t s_ps_mode[2];
+
+static void ps_apply(bool saving)
+{
+  CHECK_ERR(esp_wifi_set_ps(saving ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE));
+}
+
+/* Switch the radio mode; called with s_ps_mutex held. */
+static void ps_switch_locked(bool saving, int64_t now_us)
+{
+  if (saving == s_ps_saving)
+  {
+    return;
+  }
+  s_ps_mode[s_ps_saving].time_ms += (uint32_t)((now_us - s_ps_since_us) / 1000);
+  s_ps_since_us = now_us;
+  s_ps_saving = saving;
+  ++s_ps_mode[saving].entries;
+  ps_apply(saving);
+  ESP_LOGI(TAG, "Power save %s", saving ? "on (modem sleep)" : "off");
+}
+
+/* Start the quiet period timer unless it runs already; called with s_ps_mutex held. An earlier
+ * expiry is harmless: the callback re-arms for the rest of the quiet period. */
+static void ps_arm_locked(int64_t delay_us)
+{
+  if (s_ps_armed || s_ps_timer == NULL)
+  {
+    return;
+  }
+  s_ps_armed = true;
+  CHECK_ERR(esp_timer_start_once(s_ps_timer, (uint64_t)(delay_us > 0 ? delay_us : 0)));
+}
+
+/* Apply the policy; called with s_ps_mutex held. Under auto the timer is only re-armed while the
+ * radio is on, nothing holds it and the quiet period has not passed yet. */
+static void ps_update_locked(int64_t now_us)
+{
+  bool saving = false;
+  switch (s_ps_policy)
+  {
+  case WIFI_POWER_ALWAYS_ON:
+    saving = false;
+    break;
+  case WIFI_POWER_ALWAYS_SAVE:
+    saving = true;
+    break;
+  default:
+  {
+    const int64_t quiet_left_us = (int64_t)WIFI_PS_QUIET_MS * 1000 - (now_us - s_ps_activity_us);
+    saving = (s_ps_holds == 0) && (quiet_left_us <= 0);
+    if (s_ps_holds == 0 && !saving)
+    {
+      ps_arm_locked(quiet_left_us);
+    }
+    break;
+  }
+  }
+  ps_switch_locked(saving, now_us);
+}
+
+static void ps_timer_cb(void* arg)
+{
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  s_ps_armed = false;
+  ps_update_locked(now_us);
+  xSemaphoreGive(s_ps_mutex);
+}
+
+static void fast_load(void)
+{
+  nvs_handle_t h;
+  if (nvs_open(WIFI_FAST_NVS_NS, NVS_READONLY, &h) != ESP_OK)
+  {
+    return;
+  }
+  size_t len = sizeof(s_cache);
+  s_cache_valid = nvs_get_blob(h, "cache", &s_cache, &len) == ESP_OK && len == sizeof(s_cache) &&
+                  s_cache.version == WIFI_FAST_CACHE_VERSION && s_cache.channel != 0;
+  uint8_t on = 0;
+  if (nvs_get_u8(h, "static_ip", &on) == ESP_OK)
+  {
+    s_static_ip = (on != 0);
+  }
+  nvs_close(h);
+}
+
+static void fast_store(const wifi_fast_cache_t* c)
+{
+  if (s_cache_valid && memcmp(c, &s_cache, sizeof(*c)) == 0)
+  {
+    return; // unchanged: spare the flash
+  }
+  nvs_handle_t h;
+  esp_err_t err = nvs_open(WIFI_FAST_NVS_NS, NVS_READWRITE, &h);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_blob(h, "cache", c, sizeof(*c));
+    if (err == ESP_OK)
+    {
+      err = nvs_commit(h);
+    }
+    nvs_close(h);
+  }
+  if (err != ESP_OK)
+  {
+    ESP_LOGW(TAG, "fast connect cache not saved: %s", esp_err_to_name(err));
+    return;
+  }
+  s_cache = *c;
+  s_cache_valid = true;
+}
+
+/* Pin the stored credentials to the cached AP; returns false when the cache does not apply. */
+static bool fast_apply(void)
+{
+  wifi_config_t cfg = {};
+  if (!s_cache_valid || esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK ||
+      memcmp(cfg.sta.ssid, s_cache.ssid, sizeof(s_cache.ssid)) != 0)
+  {
+    return false;
+  }
+  /* Keep the pinning in RAM so the stored credentials stay untouched. */
+  CHECK_ERR(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+  cfg.sta.bssid_set = true;
+  memcpy(cfg.sta.bssid, s_cache.bssid, sizeof(cfg.sta.bssid));
+  cfg.sta.channel = s_cache.channel;
+  cfg.sta.scan_method = WIFI_FAST_SCAN;
+  CHECK_ERR(esp_wifi_set_config(WIFI_IF_STA, &cfg));
+  s_pinned = true;
+
+  if (s_static_ip && s_cache.ip != 0)
+  {
+    esp_netif_ip_info_t ip = {};
+    ip.ip.addr = s_cache.ip;
+    ip.netmask.addr = s_cache.netmask;
+    ip.gw.addr = s_cache.gw;
+    const esp_err_t err = esp_netif_dhcpc_stop(s_sta);
+    if ((err == ESP_OK || err == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) && esp_netif_set_ip_info(s_sta, &ip) == ESP_OK)
+    {
+      if (s_cache.dns != 0)
+      {
+        esp_netif_dns_info_t dns = {};
+        dns.ip.type = ESP_IPADDR_TYPE_V4;
+        dns.ip.u_addr.ip4.addr = s_cache.dns;
+        (void)esp_netif_set_dns_info(s_sta, ESP_NETIF_DNS_MAIN, &dns);
+      }
+      s_static_applied = true;
+    }
+    else
+    {
+      (void)esp_netif_dhcpc_start(s_sta);
+    }
+  }
+  s_path = s_static_applied ? WIFI_CONNECT_FAST_STATIC : WIFI_CONNECT_FAST;
+  ESP_LOGI(TAG, "Fast connect: bssid %02x:%02x:%02x:%02x:%02x:%02x, channel %u%s", s_cache.bssid[0], s_cache.bssid[1],
+           s_cache.bssid[2], s_cache.bssid[3], s_cache.bssid[4], s_cache.bssid[5], s_cache.channel,
+           s_static_applied ? ", static IP" : "");
+  return true;
+}
+
+/* Back to a regular connect: full channel scan, any BSSID, DHCP. */
+static void fast_unpin(void)
+{
+  wifi_config_t cfg = {};
+  if (esp_wifi_get_config(WIFI_IF_STA, &cfg) == ESP_OK)
+  {
+    cfg.sta.bssid_set = false;
+    cfg.sta.channel = 0;
+    cfg.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    CHECK_ERR(esp_wifi_set_config(WIFI_IF_STA, &cfg));
+  }
+  if (s_static_applied)
+  {
+    (void)esp_netif_dhcpc_start(s_sta);
+    s_static_applied = false;
+  }
+  s_pinned = false;
+}
+
+static void fast_remember(const esp_netif_ip_info_t* ip)
+{
+  wifi_ap_record_t ap = {};
+  wifi_config_t cfg = {};
+  if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK || esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK)
+  {
+    return;
+  }
+  wifi_fast_cache_t c = {};
+  c.version = WIFI_FAST_CACHE_VERSION;
+  memcpy(c.ssid, cfg.sta.ssid, sizeof(c.ssid));
+  memcpy(c.bssid, ap.bssid, sizeof(c.bssid));
+  c.channel = ap.primary;
+  c.ip = ip->ip.addr;
+  c.netmask = ip->netmask.addr;
+  c.gw = ip->gw.addr;
+  esp_netif_dns_info_t dns = {};
+  if (esp_netif_get_dns_info(s_sta, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK && dns.ip.type == ESP_IPADDR_TYPE_V4)
+  {
+    c.dns = dns.ip.u_addr.ip4.addr;
+  }
+  fast_store(&c);
+}
+
 static void wifi_event_handler(void* arg, esp_event_base_t base, int32_t id, void* data)
 {
   if (base == WIFI_EVENT)
@@ -28,13 +417,59 @@ static void wifi_event_handler(void* arg, esp_event_base_t base, int32_t id, voi
     {
     case WIFI_EVENT_STA_START:
       ESP_LOGI(TAG, "STA start -> connect");
-      CHECK_ERR(esp_wifi_connect());
+      connect_now();
+      break;
+    case WIFI_EVENT_STA_CONNECTED:
+    {
+      const int64_t now_us = esp_timer_get_time();
+      portENTER_CRITICAL(&s_rc_lock);
+      if (s_attempt_us != 0)
+      {
+        s_rc.attempt_ms += (uint32_t)((now_us - s_attempt_us) / 1000);
+        s_attempt_us = 0;
+      }
+      portEXIT_CRITICAL(&s_rc_lock);
       break;
+    }
     case WIFI_EVENT_STA_DISCONNECTED:
-      ESP_LOGW(TAG, "STA disconnected -> reconnect");
-      CHECK_ERR(esp_wifi_connect());
+    {
+      const int64_t t0 = esp_timer_get_time();
+      const wifi_event_sta_disconnected_t* ev = (const wifi_event_sta_disconnected_t*)data;
+      const int reason = (ev != NULL) ? ev->reason : 0;
+      metrics_add(s_m_disconnects, 1);
+      metrics_set(s_m_connected, 0);
+      portENTER_CRITICAL(&s_rc_lock);
+      ++s_rc.disconnects;
+      s_rc.last_reason = reason;
+      s_rc.last_disconnect_us = t0;
+      if (s_attempt_us != 0)
+      {
+        s_rc.attempt_ms += (uint32_t)((t0 - s_attempt_us) / 1000);
+        s_attempt_us = 0;
+      }
+      if (s_outage_us == 0)
+      {
+        s_outage_us = t0;
+      }
+      portEXIT_CRITICAL(&s_rc_lock);
+      if (s_pinned)
+      {
+        ESP_LOGW(TAG, "Fast connect failed (reason %d) -> full scan", reason);
+        fast_unpin();
+        if (!s_first_ip_done)
+        {
+          s_path = WIFI_CONNECT_FALLBACK;
+        }
+      }
       got_ip = false;
+      const uint32_t delay_ms = schedule_reconnect();
+      ESP_LOGW(TAG, "STA disconnected (reason %d) -> reconnect in %u ms", reason, (unsigned)delay_ms);
+      const uint32_t cpu_us = (uint32_t)(esp_timer_get_time() - t0);
+      portENTER_CRITICAL(&s_rc_lock);
+      s_rc.cpu_us += cpu_us;
+      portEXIT_CRITICAL(&s_rc_lock);
       break;
+    }
     default:
       break;
     }
@@ -44,6 +479,31 @@ static void wifi_event_handler(void* arg, esp_event_base_t base, int32_t id, voi
     ip_event_got_ip_t* e = (ip_event_got_ip_t*)data;
     ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&e->ip_info.ip));
     got_ip = true;
+    metrics_set(s_m_connected, 1);
+    const int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_rc_lock);
+    if (s_outage_us != 0)
+    {
+      s_rc.outage_ms += (uint32_t)((now_us - s_outage_us) / 1000);
+      s_outage_us = 0;
+    }
+    s_rc.consecutive_failures = 0;
+    s_rc.next_delay_ms = 0;
+    s_rc.breaker = WIFI_BREAKER_CLOSED;
+    portEXIT_CRITICAL(&s_rc_lock);
+    if (!s_first_ip_done)
+    {
+      s_boot_to_ip_ms = (uint32_t)(now_us / 1000);
+      s_start_to_ip_ms = (uint32_t)((now_us - s_start_us) / 1000);
+      s_first_ip_done = true;
+      boot_mark("wifi_got_ip");
+      ESP_LOGI(TAG, "Time to IP: %u ms after wifi_start, %u ms after boot (%s)", (unsigned)s_start_to_ip_ms,
+               (unsigned)s_boot_to_ip_ms, wifi_connect_path_name(s_path));
+    }
+    if (!s_static_applied)
+    {
+      fast_remember(&e->ip_info);
+    }
   }
 }
 
@@ -57,14 +517,28 @@ static void wifi_init_common(void)
     CHECK_ERR(nvs_flash_init());
   }
 
-  /* Init TCP/IP stack and default event loop */
+  /* Init TCP/IP stack and default event loop (app_main may have created the loop already) */
   CHECK_ERR(esp_netif_init());
-  CHECK_ERR(esp_event_loop_create_default());
+  err = esp_event_loop_create_default();
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+  {
+    ESP_LOGE(TAG, "ERROR: esp_event_loop_create_default failed: %s (%d) in %s", esp_err_to_name(err), err, __FUNCTION__);
+  }
 
   /* Register common event handlers once */
   static bool s_reg = false;
   if (!s_reg)
   {
+    s_m_disconnects = metrics_counter("wifi.disconnects");
+    s_m_connected = metrics_gauge("wifi.connected", 0);
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = retry_timer_cb;
+    timer_args.name = "wifi_retry";
+    CHECK_ERR(esp_timer_create(&timer_args, &s_retry_timer));
+    s_ps_mutex = xSemaphoreCreateMutex();
+    timer_args.callback = ps_timer_cb;
+    timer_args.name = "wifi_ps";
+    CHECK_ERR(esp_timer_create(&timer_args, &s_ps_timer));
     CHECK_ERR(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
     CHECK_ERR(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
     s_reg = true;
@@ -83,7 +557,6 @@ bool wifi_start(void)
 
   /* Create default netifs so SoftAP transport has AP interface and later STA uses its interface */
   static esp_netif_t* s_ap = NULL;
-  static esp_netif_t* s_sta = NULL;
   if (!s_ap)
     s_ap = esp_netif_create_default_wifi_ap();
   if (!s_sta)
@@ -116,8 +589,23 @@ bool wifi_start(void)
     CHECK_ERR(esp_netif_set_hostname(s_sta, s_hostname));
   }
   CHECK_ERR(esp_wifi_set_mode(WIFI_MODE_STA));
+  fast_load();
+  s_path = WIFI_CONNECT_FULL_SCAN;
+  if (!fast_apply())
+  {
+    ESP_LOGI(TAG, "No fast connect cache for this network; full scan");
+  }
+  s_start_us = esp_timer_get_time();
   CHECK_ERR(esp_wifi_start());
-  CHECK_ERR(esp_wifi_set_ps(WIFI_PS_NONE)); // power save off
+
+  /* Radio on through boot; the power save policy takes over after the quiet period. */
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  s_ps_since_us = s_ps_activity_us = now_us;
+  s_ps_saving = false;
+  ps_apply(false);
+  ps_update_locked(now_us);
+  xSemaphoreGive(s_ps_mutex);
 
   ESP_LOGI(TAG, "Initialization done.");
   return true;
@@ -142,6 +630,191 @@ void wifi_set_hostname(const char* name)
   }
 }
 
+const char* wifi_connect_path_name(wifi_connect_path_t path)
+{
+  switch (path)
+  {
+  case WIFI_CONNECT_FULL_SCAN:
+    return "full scan";
+  case WIFI_CONNECT_FAST:
+    return "fast";
+  case WIFI_CONNECT_FAST_STATIC:
+    return "fast, static IP";
+  case WIFI_CONNECT_FALLBACK:
+    return "fast failed, full scan";
+  default:
+    return "-";
+  }
+}
+
+void wifi_get_connect_stats(wifi_connect_stats_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  out->path = s_path;
+  out->boot_to_ip_ms = s_boot_to_ip_ms;
+  out->start_to_ip_ms = s_start_to_ip_ms;
+  out->cached = s_cache_valid;
+  out->static_ip = s_static_ip;
+}
+
+void wifi_get_reconnect_stats(wifi_reconnect_stats_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&s_rc_lock);
+  *out = s_rc;
+  if (s_outage_us != 0)
+  {
+    out->outage_ms += (uint32_t)((now_us - s_outage_us) / 1000); // include the ongoing one
+  }
+  portEXIT_CRITICAL(&s_rc_lock);
+}
+
+const char* wifi_breaker_name(wifi_breaker_state_t state)
+{
+  switch (state)
+  {
+  case WIFI_BREAKER_OPEN:
+    return "open";
+  case WIFI_BREAKER_HALF_OPEN:
+    return "half-open";
+  default:
+    return "closed";
+  }
+}
+
+void wifi_power_hold(void)
+{
+  if (s_ps_mutex == NULL)
+  {
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  ++s_ps_holds;
+  s_ps_activity_us = now_us;
+  ++s_ps_mode[s_ps_saving].requests;
+  if (s_ps_policy == WIFI_POWER_AUTO)
+  {
+    ps_switch_locked(false, now_us); // wake right away, not on the next check
+  }
+  xSemaphoreGive(s_ps_mutex);
+}
+
+void wifi_power_release(void)
+{
+  if (s_ps_mutex == NULL)
+  {
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  s_ps_holds = (s_ps_holds > 0) ? s_ps_holds - 1 : 0;
+  s_ps_activity_us = now_us;
+  ps_update_locked(now_us); // the last release starts the quiet period
+  xSemaphoreGive(s_ps_mutex);
+}
+
+void wifi_power_activity(void)
+{
+  if (s_ps_mutex == NULL)
+  {
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  s_ps_activity_us = now_us;
+  ps_update_locked(now_us);
+  xSemaphoreGive(s_ps_mutex);
+}
+
+void wifi_power_set_policy(wifi_power_policy_t policy)
+{
+  if (s_ps_mutex == NULL)
+  {
+    s_ps_policy = policy;
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  s_ps_policy = policy;
+  ps_update_locked(now_us);
+  xSemaphoreGive(s_ps_mutex);
+}
+
+const char* wifi_power_policy_name(wifi_power_policy_t policy)
+{
+  switch (policy)
+  {
+  case WIFI_POWER_ALWAYS_ON:
+    return "on";
+  case WIFI_POWER_ALWAYS_SAVE:
+    return "save";
+  default:
+    return "auto";
+  }
+}
+
+void wifi_get_power_stats(wifi_power_stats_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  if (s_ps_mutex == NULL)
+  {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  xSemaphoreTake(s_ps_mutex, portMAX_DELAY);
+  out->policy = s_ps_policy;
+  out->saving = s_ps_saving;
+  out->holds = s_ps_holds;
+  out->idle_ms = (uint32_t)((now_us - s_ps_activity_us) / 1000);
+  out->mode[0] = s_ps_mode[0];
+  out->mode[1] = s_ps_mode[1];
+  out->mode[s_ps_saving].time_ms += (uint32_t)((now_us - s_ps_since_us) / 1000);
+  xSemaphoreGive(s_ps_mutex);
+  out->mode[0].datasheet_ma = WIFI_PS_NONE_MA;
+  out->mode[1].datasheet_ma = WIFI_PS_MODEM_MA;
+  const uint64_t total_ms = (uint64_t)out->mode[0].time_ms + out->mode[1].time_ms;
+  out->avg_ma_datasheet = (total_ms == 0) ? 0
+                                    : (uint32_t)(((uint64_t)out->mode[0].time_ms * WIFI_PS_NONE_MA +
+                                                  (uint64_t)out->mode[1].time_ms * WIFI_PS_MODEM_MA) /
+                                                 total_ms);
+}
+
+void wifi_set_static_ip(bool on)
+{
+  nvs_handle_t h;
+  if (nvs_open(WIFI_FAST_NVS_NS, NVS_READWRITE, &h) == ESP_OK)
+  {
+    (void)nvs_set_u8(h, "static_ip", on ? 1 : 0);
+    (void)nvs_commit(h);
+    nvs_close(h);
+  }
+  s_static_ip = on;
+}
+
+void wifi_forget_fast_connect(void)
+{
+  nvs_handle_t h;
+  if (nvs_open(WIFI_FAST_NVS_NS, NVS_READWRITE, &h) == ESP_OK)
+  {
+    (void)nvs_erase_key(h, "cache");
+    (void)nvs_commit(h);
+    nvs_close(h);
+  }
+  s_cache_valid = false;
+}
+
 const char* wifi_get_ap_password(void)
 {
   return s_setup_ap_pass;
@@ -2,123 +2,1020 @@
 #include <esp_adc/adc_oneshot.h>
 #include <esp_err.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <led_strip.h>
 #include <led_strip_rmt.h>
+#include <led_strip_spi.h>
 #include <stdint.h>
 #include <string.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
 
+#include "boot_timeline.h"
+#include "latency_histogram.h"
+#include "led_color.h"
+#include "led_effects.h"
+#include "led_idle.h"
+#include "led_power.h"
 #include "light_sensor_support.h"
+#include "metrics.h"
 #include "pir312_monitor.h"
 #include "utils.h"
 #include "ws2812b_support.h"
 
 static const char* TAG = "WS2812B";
 
-#define LED_PIN    GPIO_NUM_13
-#define LED_COUNT  84
 #define SEG_COUNT  4
 #define SEG_LENGTH 21
 
-static led_strip_handle_t s_strip = NULL;
+// Strip backends. The classic ESP32 RMT has no DMA, so the RMT backend refills its 64-symbol
+// memory block from an ISR several times per frame; SPI2 (HSPI, GPIO13 is its native MOSI)
+// streams the whole encoded frame by DMA.
+#define LED_BACKEND_RMT     0
+#define LED_BACKEND_SPI_DMA 1
 
-static void ws2812b_led_task(void* arg)
+#ifndef LED_BACKEND
+#define LED_BACKEND LED_BACKEND_SPI_DMA
+#endif
+
+// Strip outputs as {pin, backend, pixels}. Pixels are numbered across the outputs in table order
+// (the zones cover the first 84). Every output has its own peripheral: SPI outputs take SPI2 then
+// SPI3, RMT outputs one TX channel each (up to 8 with 64-symbol blocks). All outputs transmit at
+// the same time, so a frame takes as long as the longest output, not the sum (~30 us per pixel:
+// outputs longer than ~160 px cannot keep up with LED_FRAME_US and lower the frame rate).
+//   -DLED_OUTPUTS="{GPIO_NUM_13, LED_BACKEND_SPI_DMA, 84}, {GPIO_NUM_14, LED_BACKEND_RMT, 300}"
+#ifndef LED_OUTPUTS
+#define LED_OUTPUTS {GPIO_NUM_13, LED_BACKEND, 84}
+#endif
+
+struct led_output_cfg
 {
-  // color composer https://www.figma.com/color-wheel/
-  // ambient RGB: 50, 0, 10
+  gpio_num_t pin;
+  int backend;
+  int count;
+};
 
-  if (s_strip)
+static constexpr led_output_cfg k_outputs[] = {LED_OUTPUTS};
+static constexpr int k_output_count = (int)(sizeof(k_outputs) / sizeof(k_outputs[0]));
+
+static constexpr int total_pixels()
+{
+  int n = 0;
+  for (int i = 0; i < k_output_count; ++i)
   {
-    CHECK_ERR(led_strip_clear(s_strip));
+    n += k_outputs[i].count;
   }
+  return n;
+}
 
-  for (;;)
+static constexpr int spi_output_count()
+{
+  int n = 0;
+  for (int i = 0; i < k_output_count; ++i)
+  {
+    n += (k_outputs[i].backend == LED_BACKEND_SPI_DMA) ? 1 : 0;
+  }
+  return n;
+}
+
+static constexpr int LED_COUNT = total_pixels();
+static_assert(LED_COUNT >= SEG_COUNT * SEG_LENGTH, "the outputs must cover the zones");
+static_assert(spi_output_count() <= 2, "only SPI2 and SPI3 can drive strips");
+
+// 1 = measure both backends at boot (before Wi-Fi is up) and log CPU cost vs refresh duration.
+#ifndef LED_BACKEND_COMPARE
+#define LED_BACKEND_COMPARE 0
+#endif
+#define LED_COMPARE_FRAMES 32
+
+// Frames are paced by an esp_timer at 200 Hz so the temporal dither stays above flicker fusion
+// and effects animate smoothly; the sensors are still sampled every 200 ms as before.
+#define LED_FRAME_US      5000
+#define LED_SENSOR_FRAMES 40
+
+// Strip current budget. The PSU also feeds the ESP32 (~250 mA peak with Wi-Fi TX); size this to
+// the supply rating minus that headroom.
+#ifndef LED_POWER_BUDGET_MA
+#define LED_POWER_BUDGET_MA 2000
+#endif
+
+// Unchanged frames are not re-sent, but the strip is still refreshed this often to repair
+// a pixel that latched a glitched bit.
+#define LED_FORCE_REFRESH_FRAMES 200 // 1 s
+
+// Realtime streaming (led_stream_udp.cpp): the strip shows streamed pixels until no frame has
+// been committed for this long, then returns to the sensor-driven zones.
+#ifndef LED_STREAM_TIMEOUT_MS
+#define LED_STREAM_TIMEOUT_MS 2500
+#endif
+
+// Idle power mode (led_idle.h): after LED_IDLE_AFTER_MS with nothing lit, no motion and no stream,
+// the frame timer drops to one sensor poll per LED_IDLE_POLL_MS, the PIR pins become GPIO wake
+// sources and the CPU frequency lock is released, so automatic light sleep (CONFIG_PM_ENABLE with
+// tickless idle) runs between Wi-Fi DTIM wake-ups. A PIR edge, stream frame or zone change wakes
+// the task at once, and the first frame after it samples the sensors.
+#ifndef LED_IDLE
+#define LED_IDLE 1
+#endif
+#define LED_IDLE_AFTER_MS 3000
+#define LED_IDLE_POLL_MS  1000
+
+struct led_output
+{
+  led_strip_handle_t strip;
+  int first; // first pixel in the frame buffers
+  bool refresh_pending;
+};
+
+static led_output s_outputs[k_output_count];
+static bool s_strips_ready = false;
+static TaskHandle_t s_task = NULL;
+static esp_timer_handle_t s_frame_timer = NULL;
+
+// Composed perceptual levels (rendered by the zone effects every frame) and the dither remainders carried between frames.
+static uint8_t s_levels[LED_COUNT * 3];
+static uint8_t s_dither_err[LED_COUNT * 3];
+
+// Double-buffered pixel data (packed RGB): the task composes into the back buffer while the
+// driver may still be transmitting the front one.
+static uint8_t s_frame[2][LED_COUNT * 3];
+static int s_back = 0;
+static int s_frames_since_refresh = 0;
+
+// Streamed perceptual levels, triple-buffered. The receiver writes datagram payloads straight
+// into the back buffer; a commit swaps it with the ready one, and the LED task swaps the ready
+// buffer with the one it shows when it starts a frame. Neither side ever writes a buffer the
+// other one is reading, and the receiver keeps the last committed frame after it, so datagrams
+// that update part of the strip start from what is on it.
+static uint8_t s_stream[3][LED_COUNT * 3];
+static int s_stream_back = 0;  // receiver task
+static int s_stream_shown = 1; // LED task
+static int s_stream_ready = 2; // latest commit, under s_stats_lock
+static bool s_stream_fresh = false;
+static volatile uint32_t s_stream_commit_ms = 0;
+static volatile bool s_stream_seen = false;
+
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_stat_frames = 0;
+static uint32_t s_stat_skipped = 0;
+static uint64_t s_stat_cpu_sum_us = 0;
+static uint32_t s_stat_cpu_last_us = 0;
+static uint32_t s_stat_wait_last_us = 0;
+static uint32_t s_stat_wait_max_us = 0;
+
+static volatile uint32_t s_power_budget_ma = LED_POWER_BUDGET_MA;
+static uint64_t s_stat_power_sum_ma = 0;
+static uint32_t s_stat_power_frames = 0;
+static uint32_t s_stat_power_last_ma = 0;
+static uint32_t s_stat_power_peak_ma = 0;
+static uint32_t s_stat_power_req_peak_ma = 0;
+static uint32_t s_stat_power_limited = 0;
+
+// Motion-to-light trace. Motion onsets (PIR ISR timestamps) picked up with a sensor sample ride
+// with the next frame; when that frame is sent, its refresh is waited for and each onset is
+// closed with the completion time. Onsets that change nothing on the strip are only counted.
+static uint64_t s_trace_onset_us[6];
+static int s_trace_count = 0;
+static latency::log_histogram<> s_motion_hist;
+static uint32_t s_motion_unchanged = 0;
+
+// Frame pacing: interval between frame starts; a start more than half a period late is a
+// missed deadline (at least one timer tick was merged into it).
+static latency::log_histogram<> s_interval_hist;
+static uint64_t s_interval_dev_sum_us = 0;
+static uint32_t s_missed_deadlines = 0;
+static int64_t s_last_frame_us = 0; // written under s_stats_lock, ws2812b_flash_claim() reads it
+
+// Flash coordination (OTA writer, see ws2812b_flash_claim()). While sync is on, a frame's
+// transmission is waited for right away so s_tx_active brackets it exactly; a claim is granted only
+// outside it, and a frame due while a claim is held is deferred to the next tick.
+#define LED_FLASH_MARGIN_US 300
+static volatile bool s_flash_sync = false;
+static bool s_tx_active = false;
+static bool s_flash_claimed = false;
+static bool s_flash_long = false; // a claim longer than a gap was granted since the last frame start
+static TaskHandle_t s_flash_waiter = NULL;
+static uint32_t s_stat_flash_deferred = 0;
+static uint32_t s_stat_flash_skipped = 0;
+
+static led_idle::tracker s_idle = {LED_IDLE_AFTER_MS, false, false, 0};
+static volatile bool s_wake_request = false;
+static bool s_stat_idle = false; // s_idle.idle as seen by ws2812b_get_stats()
+static int64_t s_idle_since_us = 0;
+static uint32_t s_stat_idle_entries = 0;
+static uint64_t s_stat_idle_us = 0;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t s_pm_lock = NULL; // CPU at full speed and no light sleep while active
+#endif
+
+// Registry mirrors (metrics.h) of the stats above that the monitor log and GET /metrics follow.
+static metric_t s_m_frames = NULL;
+static metric_t s_m_cpu_us = NULL;
+static metric_t s_m_power_ma = NULL;
+static metric_t s_m_dark = NULL;
+static metric_t s_m_idle = NULL;
+
+static const char* backend_name(int backend)
+{
+  return (backend == LED_BACKEND_SPI_DMA) ? "spi-dma" : "rmt";
+}
+
+// "rmt", "spi-dma", or "mixed" when the outputs use both.
+static const char* outputs_backend_name()
+{
+  for (int i = 1; i < k_output_count; ++i)
   {
-    if (s_strip)
+    if (k_outputs[i].backend != k_outputs[0].backend)
     {
-      if (!light_sensor_is_light())
-      {
-        bool s1 = pir312_get_state(0); // left-left guard sensor
-        bool s2 = pir312_get_state(1); // left-left closet
-        bool s3 = pir312_get_state(2); // left-center closet
-        bool s4 = pir312_get_state(3); // right-center closet
-        bool s5 = pir312_get_state(4); // right-right closet
-        bool s6 = pir312_get_state(5); // right-rigth guard sensor
-
-        if (s1 || s2 || s3 || s4 || s5 || s6)
-        {
-          for (int i = 0; i < LED_COUNT; ++i)
-            CHECK_ERR(led_strip_set_pixel(s_strip, i, 50, 0, 10));
-        }
-        else
-        {
-          CHECK_ERR(led_strip_clear(s_strip));
-        }
-
-        if (s2)
-        {
-          for (int i = 0; i < SEG_LENGTH; ++i)
-          {
-            CHECK_ERR(led_strip_set_pixel(s_strip, (0 * SEG_LENGTH) + i, 160, 0, 35));
-          }
-        }
-        if (s3)
-        {
-          for (int i = 0; i < SEG_LENGTH; ++i)
-          {
-            CHECK_ERR(led_strip_set_pixel(s_strip, (1 * SEG_LENGTH) + i, 140, 0, 70));
-          }
-        }
-        if (s4)
-        {
-          for (int i = 0; i < SEG_LENGTH; ++i)
-          {
-            CHECK_ERR(led_strip_set_pixel(s_strip, (2 * SEG_LENGTH) + i, 128, 0, 130));
-          }
-        }
-        if (s5)
-        {
-          for (int i = 0; i < SEG_LENGTH; ++i)
-          {
-            CHECK_ERR(led_strip_set_pixel(s_strip, (3 * SEG_LENGTH) + i, 150, 0, 255));
-          }
-        }
-      }
-      else
-      {
-        CHECK_ERR(led_strip_clear(s_strip));
-      }
-      CHECK_ERR(led_strip_refresh(s_strip));
+      return "mixed";
     }
-    vTaskDelay(pdMS_TO_TICKS(200)); // 0.2 sec
   }
+  return backend_name(k_outputs[0].backend);
 }
 
-void ws2812b_led_init()
+static esp_err_t create_strip(const led_output_cfg& cfg, spi_host_device_t spi_bus, led_strip_handle_t* out)
 {
   led_strip_config_t strip_cfg = {};
-  strip_cfg.strip_gpio_num = LED_PIN;
-  strip_cfg.max_leds = LED_COUNT;
+  strip_cfg.strip_gpio_num = cfg.pin;
+  strip_cfg.max_leds = cfg.count;
   strip_cfg.led_model = LED_MODEL_WS2812;
   strip_cfg.color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB;
   strip_cfg.flags = {};
   strip_cfg.flags.invert_out = false;
 
+  if (cfg.backend == LED_BACKEND_SPI_DMA)
+  {
+    led_strip_spi_config_t spi_cfg = {};
+    spi_cfg.clk_src = SPI_CLK_SRC_DEFAULT;
+    spi_cfg.spi_bus = spi_bus;
+    spi_cfg.flags = {};
+    spi_cfg.flags.with_dma = true;
+    return led_strip_new_spi_device(&strip_cfg, &spi_cfg, out);
+  }
+
   led_strip_rmt_config_t rmt_cfg = {};
   rmt_cfg.clk_src = RMT_CLK_SRC_DEFAULT;
   rmt_cfg.resolution_hz = 10 * 1000 * 1000;
   rmt_cfg.mem_block_symbols = 64;
   rmt_cfg.flags = {};
-  //rmt_cfg.flags.with_dma = true;
-  rmt_cfg.flags.with_dma = false;
+  rmt_cfg.flags.with_dma = false; // no RMT DMA on the classic ESP32
+  return led_strip_new_rmt_device(&strip_cfg, &rmt_cfg, out);
+}
+
+static void push_pixels(led_strip_handle_t strip, const uint8_t* rgb, int count)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    CHECK_ERR(led_strip_set_pixel(strip, i, rgb[i * 3 + 0], rgb[i * 3 + 1], rgb[i * 3 + 2]));
+  }
+}
+
+// color composer https://www.figma.com/color-wheel/
+// Levels are perceptual (gamma 2.6 applied on output); they reproduce the former raw duties
+// ambient 50,0,10 and segments 160,0,35 / 140,0,70 / 128,0,130 / 150,0,255.
+static const led_effects::rgb k_ambient = {136, 0, 73};
+
+struct led_zone
+{
+  int first;
+  int count;
+  int sensor; // PIR index that drives the zone
+  led_effects::rgb color;
+  volatile int effect; // index into led_effects::registry, changed at runtime
+};
+
+static const int k_motion = led_effects::registry::index_of<led_effects::effect_motion_follow>();
+
+static led_zone s_zones[SEG_COUNT] = {
+    {0 * SEG_LENGTH, SEG_LENGTH, 1, {213, 0, 119}, k_motion}, // left-left closet
+    {1 * SEG_LENGTH, SEG_LENGTH, 2, {202, 0, 155}, k_motion}, // left-center closet
+    {2 * SEG_LENGTH, SEG_LENGTH, 3, {196, 0, 197}, k_motion}, // right-center closet
+    {3 * SEG_LENGTH, SEG_LENGTH, 4, {208, 0, 255}, k_motion}, // right-right closet
+};
+
+// Sensor snapshot, refreshed every LED_SENSOR_FRAMES. Sensors 0 and 5 are the left/right guards:
+// they only switch the ambient background on.
+static bool s_dark = false;
+static bool s_motion[6] = {};
+static bool s_any_motion = false;
+
+static void sample_sensors()
+{
+  s_dark = !light_sensor_is_light();
+  metrics_set(s_m_dark, s_dark ? 1 : 0);
+  const uint32_t motion = pir312_sample_motion();
+  s_any_motion = (motion != 0);
+  for (int i = 0; i < 6; ++i)
+  {
+    s_motion[i] = (motion & (1u << i)) != 0;
+    const uint64_t onset = pir312_take_onset_us(i);
+    if (onset != 0)
+    {
+      s_trace_onset_us[s_trace_count++] = onset;
+    }
+  }
+}
+
+/* Close the pending motion traces: with the refresh completion time, or as "unchanged" when the
+ * frame carrying them did not change the strip (already lit, daylight, streaming). */
+static void close_traces(int64_t done_us)
+{
+  if (s_trace_count == 0)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&s_stats_lock);
+  for (int i = 0; i < s_trace_count; ++i)
+  {
+    if (done_us > 0)
+      s_motion_hist.record((uint32_t)(done_us - (int64_t)s_trace_onset_us[i]));
+    else
+      ++s_motion_unchanged;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+  s_trace_count = 0;
+}
+
+static void record_frame_start(int64_t now_us)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  if (s_last_frame_us != 0)
+  {
+    const uint32_t interval = (uint32_t)(now_us - s_last_frame_us);
+    const uint32_t dev = (interval > LED_FRAME_US) ? interval - LED_FRAME_US : LED_FRAME_US - interval;
+    s_interval_hist.record(interval);
+    s_interval_dev_sum_us += dev;
+    const uint32_t periods = (interval + LED_FRAME_US / 2) / LED_FRAME_US;
+    if (s_flash_long && periods > 1)
+      s_stat_flash_skipped += periods - 1; // given up for an erase, not missed
+    else if (interval > LED_FRAME_US + LED_FRAME_US / 2)
+      ++s_missed_deadlines;
+  }
+  if (!s_flash_claimed)
+    s_flash_long = false;
+  s_last_frame_us = now_us;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void compose_frame(uint8_t* rgb, uint32_t t_ms, bool dark, const bool* motion, bool any_motion)
+{
+  memset(rgb, 0, LED_COUNT * 3);
+  if (!dark)
+  {
+    return;
+  }
+
+  led_effects::zone_ctx ctx = {};
+  ctx.t_ms = t_ms;
+  ctx.any_motion = any_motion;
+  ctx.ambient = k_ambient;
+  for (int z = 0; z < SEG_COUNT; ++z)
+  {
+    const led_zone& zone = s_zones[z];
+    ctx.motion = motion[zone.sensor];
+    ctx.color = zone.color;
+    led_effects::registry::render_zone(zone.effect, ctx, rgb + zone.first * 3, zone.count);
+  }
+}
+
+uint32_t ws2812b_bench_frame(uint32_t t_ms, uint32_t motion_mask)
+{
+  static uint8_t levels[LED_COUNT * 3];
+  static uint8_t out[LED_COUNT * 3];
+  static uint8_t dither_err[LED_COUNT * 3];
+  bool motion[6];
+  for (int i = 0; i < 6; ++i)
+  {
+    motion[i] = (motion_mask >> i) & 1u;
+  }
+  compose_frame(levels, t_ms, true, motion, motion_mask != 0);
+  const uint32_t est_ma = led_power::estimate_ma(led_power::duty_sum(levels, sizeof(levels)), LED_COUNT);
+  const uint32_t scale_q16 = led_power::limit_scale_q16(est_ma, LED_COUNT, s_power_budget_ma);
+  led_color::gamma_dither(levels, out, dither_err, sizeof(levels), scale_q16);
+  return est_ma + out[0];
+}
+
+int ws2812b_zone_count(void)
+{
+  return SEG_COUNT;
+}
+
+const char* ws2812b_zone_effect(int zone)
+{
+  if (zone < 0 || zone >= SEG_COUNT)
+  {
+    return NULL;
+  }
+  return led_effects::registry::names[s_zones[zone].effect];
+}
+
+bool ws2812b_set_zone_effect(int zone, const char* effect)
+{
+  const int index = led_effects::registry::find(effect);
+  if (zone < 0 || zone >= SEG_COUNT || index < 0)
+  {
+    return false;
+  }
+  s_zones[zone].effect = index;
+  ESP_LOGI(TAG, "Zone %d effect -> %s", zone, effect);
+  ws2812b_wake();
+  return true;
+}
+
+/* Frame barrier: wait until every output has finished the previous transmission. */
+static void wait_outputs_done()
+{
+  for (int i = 0; i < k_output_count; ++i)
+  {
+    if (s_outputs[i].refresh_pending)
+    {
+      CHECK_ERR(led_strip_refresh_wait_done(s_outputs[i].strip));
+      s_outputs[i].refresh_pending = false;
+    }
+  }
+}
+
+/* Send the back buffer: wait for the previous transmission on all outputs, then push pixels and
+ * start the refresh output by output without waiting for it. The outputs then transmit in
+ * parallel, overlapping with composing the next frame. Outputs whose pixels did not change are
+ * left alone. */
+static void submit_frame()
+{
+  const uint8_t* back = s_frame[s_back];
+  const uint8_t* front = s_frame[s_back ^ 1];
+  const bool force = (s_frames_since_refresh >= LED_FORCE_REFRESH_FRAMES);
+
+  if (memcmp(back, front, sizeof(s_frame[0])) == 0 && !force)
+  {
+    ++s_frames_since_refresh;
+    portENTER_CRITICAL(&s_stats_lock);
+    ++s_stat_skipped;
+    portEXIT_CRITICAL(&s_stats_lock);
+    close_traces(0);
+    return;
+  }
+
+  const bool flash_sync = s_flash_sync;
+  if (flash_sync)
+  {
+    bool deferred = false;
+    portENTER_CRITICAL(&s_stats_lock);
+    deferred = s_flash_claimed;
+    if (deferred)
+      ++s_stat_flash_deferred;
+    else
+      s_tx_active = true;
+    portEXIT_CRITICAL(&s_stats_lock);
+    if (deferred)
+    {
+      close_traces(0);
+      return;
+    }
+  }
+
+  const int64_t t0 = esp_timer_get_time();
+  wait_outputs_done();
+  const int64_t t1 = esp_timer_get_time();
+
+  for (int i = 0; i < k_output_count; ++i)
+  {
+    led_output& out = s_outputs[i];
+    if (out.strip == NULL)
+    {
+      continue;
+    }
+    const size_t offset = (size_t)out.first * 3;
+    const size_t len = (size_t)k_outputs[i].count * 3;
+    if (!force && memcmp(back + offset, front + offset, len) == 0)
+    {
+      continue;
+    }
+    push_pixels(out.strip, back + offset, k_outputs[i].count);
+    const esp_err_t err = led_strip_refresh_async(out.strip);
+    if (err != ESP_OK)
+    {
+      ESP_LOGE(TAG, "ERROR: led_strip_refresh_async failed: %s (%d) in %s", esp_err_to_name(err), err, __FUNCTION__);
+    }
+    out.refresh_pending = (err == ESP_OK);
+  }
+  const int64_t t2 = esp_timer_get_time();
+
+  if (s_trace_count > 0 || flash_sync)
+  {
+    // Rare (once per motion onset, or during a flash update): wait for this frame to be on the strip.
+    wait_outputs_done();
+    if (s_trace_count > 0)
+      close_traces(esp_timer_get_time());
+  }
+  if (flash_sync)
+  {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_tx_active = false;
+    TaskHandle_t waiter = s_flash_waiter;
+    portEXIT_CRITICAL(&s_stats_lock);
+    if (waiter != NULL)
+      xTaskNotifyGive(waiter);
+  }
+
+  s_back ^= 1;
+  s_frames_since_refresh = 0;
+
+  const uint32_t wait_us = (uint32_t)(t1 - t0);
+  const uint32_t cpu_us = (uint32_t)(t2 - t1);
+  portENTER_CRITICAL(&s_stats_lock);
+  ++s_stat_frames;
+  s_stat_cpu_sum_us += cpu_us;
+  s_stat_cpu_last_us = cpu_us;
+  s_stat_wait_last_us = wait_us;
+  if (wait_us > s_stat_wait_max_us)
+    s_stat_wait_max_us = wait_us;
+  portEXIT_CRITICAL(&s_stats_lock);
+  metrics_add(s_m_frames, 1);
+  metrics_record(s_m_cpu_us, cpu_us);
+}
+
+void ws2812b_get_stats(ws2812b_stats_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&s_stats_lock);
+  out->backend = outputs_backend_name();
+  out->outputs = k_output_count;
+  out->frames = s_stat_frames;
+  out->skipped = s_stat_skipped;
+  out->cpu_us_last = s_stat_cpu_last_us;
+  out->cpu_us_avg = s_stat_frames ? (uint32_t)(s_stat_cpu_sum_us / s_stat_frames) : 0;
+  out->wait_us_last = s_stat_wait_last_us;
+  out->wait_us_max = s_stat_wait_max_us;
+  out->power_budget_ma = s_power_budget_ma;
+  out->power_ma_last = s_stat_power_last_ma;
+  out->power_ma_avg = s_stat_power_frames ? (uint32_t)(s_stat_power_sum_ma / s_stat_power_frames) : 0;
+  out->power_ma_peak = s_stat_power_peak_ma;
+  out->power_req_peak_ma = s_stat_power_req_peak_ma;
+  out->power_limited = s_stat_power_limited;
+  out->flash_deferred = s_stat_flash_deferred;
+  out->flash_skipped = s_stat_flash_skipped;
+  out->idle = s_stat_idle;
+  out->idle_entries = s_stat_idle_entries;
+  out->idle_ms = (uint32_t)((s_stat_idle_us + (s_stat_idle ? (uint64_t)(now_us - s_idle_since_us) : 0)) / 1000);
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void ws2812b_get_latency(ws2812b_latency_t* out)
+{
+  if (out == NULL)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&s_stats_lock);
+  out->motion_samples = s_motion_hist.total;
+  out->motion_unchanged = s_motion_unchanged;
+  out->motion_p50_us = s_motion_hist.percentile(50);
+  out->motion_p95_us = s_motion_hist.percentile(95);
+  out->motion_max_us = s_motion_hist.max;
+  out->motion_avg_us = s_motion_hist.mean();
+  out->frame_us = LED_FRAME_US;
+  out->interval_p50_us = s_interval_hist.percentile(50);
+  out->interval_p95_us = s_interval_hist.percentile(95);
+  out->interval_max_us = s_interval_hist.max;
+  out->jitter_us_avg = s_interval_hist.total ? (uint32_t)(s_interval_dev_sum_us / s_interval_hist.total) : 0;
+  out->missed_deadlines = s_missed_deadlines;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void ws2812b_reset_latency(void)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  s_motion_hist.reset();
+  s_motion_unchanged = 0;
+  s_interval_hist.reset();
+  s_interval_dev_sum_us = 0;
+  s_missed_deadlines = 0;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void ws2812b_set_power_budget_ma(uint32_t budget_ma)
+{
+  s_power_budget_ma = budget_ma;
+  ESP_LOGI(TAG, "Power budget set to %u mA", (unsigned)budget_ma);
+}
+
+/* Estimate the frame current and return the brightness factor that keeps it within budget. */
+static uint32_t power_limit(const uint8_t* levels)
+{
+  const uint32_t est_ma = led_power::estimate_ma(led_power::duty_sum(levels, LED_COUNT * 3), LED_COUNT);
+  const uint32_t scale_q16 = led_power::limit_scale_q16(est_ma, LED_COUNT, s_power_budget_ma);
+  const uint32_t drawn_ma = led_power::scaled_ma(est_ma, LED_COUNT, scale_q16);
+
+  portENTER_CRITICAL(&s_stats_lock);
+  ++s_stat_power_frames;
+  s_stat_power_sum_ma += drawn_ma;
+  s_stat_power_last_ma = drawn_ma;
+  if (drawn_ma > s_stat_power_peak_ma)
+    s_stat_power_peak_ma = drawn_ma;
+  if (est_ma > s_stat_power_req_peak_ma)
+    s_stat_power_req_peak_ma = est_ma;
+  if (scale_q16 < led_power::k_full_scale_q16)
+    ++s_stat_power_limited;
+  portEXIT_CRITICAL(&s_stats_lock);
+  metrics_set(s_m_power_ma, (int32_t)drawn_ma);
+
+  return scale_q16;
+}
+
+#if LED_BACKEND_COMPARE
+// Busy-loop for duration_us and count iterations. Interrupt time taken from this core while
+// spinning shows up as fewer iterations than an idle baseline.
+static uint32_t spin_iterations(int64_t duration_us)
+{
+  uint32_t n = 0;
+  const int64_t end = esp_timer_get_time() + duration_us;
+  while (esp_timer_get_time() < end)
+  {
+    ++n;
+  }
+  return n;
+}
+
+// Runs on the first output's pin and pixel count.
+static void compare_backend(int backend)
+{
+  static constexpr int count = k_outputs[0].count;
+  const led_output_cfg cfg = {k_outputs[0].pin, backend, count};
+  led_strip_handle_t strip = NULL;
+  esp_err_t err = create_strip(cfg, SPI2_HOST, &strip);
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "COMPARE %s: create_strip failed: %s (%d)", backend_name(backend), esp_err_to_name(err), err);
+    return;
+  }
+
+  uint8_t rgb[count * 3];
+  for (int i = 0; i < count * 3; ++i)
+  {
+    rgb[i] = (uint8_t)((i * 7) & 0x1F); // varying bit pattern, at most 31 of 255: dim enough for a test
+  }
+
+  // Spin window comfortably longer than one frame on the wire (~30 us per pixel).
+  const int64_t window_us = (int64_t)count * 30 * 2 + 500;
+  const uint32_t idle = spin_iterations(window_us);
+
+  uint64_t push_sum = 0, kick_sum = 0, refresh_sum = 0, busy_sum = 0;
+  uint32_t refresh_max = 0;
+  for (int f = 0; f < LED_COMPARE_FRAMES && err == ESP_OK; ++f)
+  {
+    // Pass 1: kick -> wait done, refresh duration on the wire.
+    const int64_t t0 = esp_timer_get_time();
+    push_pixels(strip, rgb, count);
+    const int64_t t1 = esp_timer_get_time();
+    err = led_strip_refresh_async(strip);
+    const int64_t t2 = esp_timer_get_time();
+    if (err == ESP_OK)
+      err = led_strip_refresh_wait_done(strip);
+    const int64_t t3 = esp_timer_get_time();
 
-  CHECK_ERR(led_strip_new_rmt_device(&strip_cfg, &rmt_cfg, &s_strip));
-  ESP_LOGI(TAG, "INIT: LED strip created on GPIO %d (%d px)", LED_PIN, LED_COUNT);
+    push_sum += (uint64_t)(t1 - t0);
+    kick_sum += (uint64_t)(t2 - t1);
+    const uint32_t refresh_us = (uint32_t)(t3 - t1);
+    refresh_sum += refresh_us;
+    if (refresh_us > refresh_max)
+      refresh_max = refresh_us;
+
+    // Pass 2: kick -> spin, CPU taken by the backend's interrupts during the transfer.
+    if (err == ESP_OK)
+      err = led_strip_refresh_async(strip);
+    const uint32_t loaded = spin_iterations(window_us);
+    if (err == ESP_OK)
+      err = led_strip_refresh_wait_done(strip);
+    if (idle > loaded)
+    {
+      busy_sum += (uint64_t)window_us * (idle - loaded) / idle;
+    }
+  }
+  if (err != ESP_OK)
+  {
+    // A failed refresh returns at once; its timings would pass for a very fast backend.
+    ESP_LOGE(TAG, "COMPARE %s: refresh failed: %s (%d)", backend_name(backend), esp_err_to_name(err), err);
+    CHECK_ERR(led_strip_del(strip));
+    return;
+  }
+
+  ESP_LOGI(TAG,
+           "COMPARE %s: push=%uus kick=%uus isr_cpu=%uus refresh avg=%uus max=%uus (%d px, %d frames)",
+           backend_name(backend),
+           (unsigned)(push_sum / LED_COMPARE_FRAMES),
+           (unsigned)(kick_sum / LED_COMPARE_FRAMES),
+           (unsigned)(busy_sum / LED_COMPARE_FRAMES),
+           (unsigned)(refresh_sum / LED_COMPARE_FRAMES),
+           (unsigned)refresh_max,
+           count,
+           LED_COMPARE_FRAMES);
+
+  CHECK_ERR(led_strip_clear(strip));
+  CHECK_ERR(led_strip_refresh(strip));
+  CHECK_ERR(led_strip_del(strip));
+}
+#endif
+
+uint8_t* ws2812b_stream_buffer(size_t* size)
+{
+  if (size != NULL)
+  {
+    *size = sizeof(s_stream[0]);
+  }
+  return s_stream[s_stream_back];
+}
+
+void ws2812b_stream_commit(void)
+{
+  const int committed = s_stream_back;
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stream_back = s_stream_ready;
+  s_stream_ready = committed;
+  s_stream_fresh = true;
+  portEXIT_CRITICAL(&s_stats_lock);
+  // Only the receiver writes the committed buffer, so it can be read while the LED task shows it.
+  memcpy(s_stream[s_stream_back], s_stream[committed], sizeof(s_stream[0]));
+  s_stream_commit_ms = (uint32_t)(esp_timer_get_time() / 1000);
+  s_stream_seen = true;
+  s_wake_request = true;
+  if (s_task)
+  {
+    xTaskNotifyGive(s_task); // show it now instead of on the next frame tick
+  }
+}
+
+void ws2812b_set_flash_sync(bool on)
+{
+  s_flash_sync = on;
+  if (on)
+  {
+    ws2812b_wake(); // full-rate frames keep the claim timing meaningful
+  }
+  else
+  {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_flash_claimed = false;
+    s_tx_active = false;
+    s_flash_waiter = NULL;
+    portEXIT_CRITICAL(&s_stats_lock);
+  }
+}
+
+bool ws2812b_flash_claim(uint32_t est_us)
+{
+  if (!s_flash_sync || !s_strips_ready)
+  {
+    return true;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&s_stats_lock);
+  const int64_t next_frame_us = s_last_frame_us + LED_FRAME_US;
+  // Operations longer than a gap (erases) cannot avoid delaying a frame; they only avoid transmissions,
+  // and the frames they cover are counted as skipped rather than as missed deadlines.
+  const bool long_op = (est_us > LED_FRAME_US / 2);
+  const bool fits = long_op || (now_us + est_us + LED_FLASH_MARGIN_US <= next_frame_us);
+  const bool ok = !s_tx_active && fits;
+  if (ok)
+  {
+    s_flash_claimed = true;
+    s_flash_long = s_flash_long || long_op;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+  return ok;
+}
+
+void ws2812b_flash_release(void)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  s_flash_claimed = false;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void ws2812b_flash_wait_gap(void)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  s_flash_waiter = xTaskGetCurrentTaskHandle();
+  portEXIT_CRITICAL(&s_stats_lock);
+  ulTaskNotifyTake(pdTRUE, 1);
+  portENTER_CRITICAL(&s_stats_lock);
+  s_flash_waiter = NULL;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+bool ws2812b_stream_active(void)
+{
+  return s_stream_seen && (uint32_t)(esp_timer_get_time() / 1000) - s_stream_commit_ms < LED_STREAM_TIMEOUT_MS;
+}
+
+/* The newest committed stream frame, swapped in if there is one since the last call. */
+static const uint8_t* stream_take()
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  if (s_stream_fresh)
+  {
+    const int shown = s_stream_shown;
+    s_stream_shown = s_stream_ready;
+    s_stream_ready = shown;
+    s_stream_fresh = false;
+  }
+  const int index = s_stream_shown;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return s_stream[index];
+}
+
+static void frame_timer_cb(void* arg)
+{
+  xTaskNotifyGive(s_task);
+}
+
+void ws2812b_wake(void)
+{
+  s_wake_request = true;
+  if (s_task && s_idle.idle) // while active the next frame tick picks it up
+  {
+    xTaskNotifyGive(s_task);
+  }
+}
+
+static void pir_edge_hook(void)
+{
+  if (s_idle.idle)
+  {
+    s_wake_request = true;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+}
+
+/* Switch the frame rate, wake sources and power lock between active and idle. */
+static void set_idle(bool idle, int64_t now_us)
+{
+  CHECK_ERR(esp_timer_stop(s_frame_timer));
+  CHECK_ERR(esp_timer_start_periodic(s_frame_timer, idle ? LED_IDLE_POLL_MS * 1000ULL : LED_FRAME_US));
+  if (idle)
+  {
+    pir312_arm_wakeup();
+#if CONFIG_PM_ENABLE
+    CHECK_ERR(esp_pm_lock_release(s_pm_lock));
+#endif
+  }
+  else
+  {
+#if CONFIG_PM_ENABLE
+    CHECK_ERR(esp_pm_lock_acquire(s_pm_lock));
+#endif
+    pir312_disarm_wakeup();
+  }
+  portENTER_CRITICAL(&s_stats_lock);
+  if (idle)
+  {
+    ++s_stat_idle_entries;
+    s_idle_since_us = now_us;
+  }
+  else
+  {
+    s_stat_idle_us += (uint64_t)(now_us - s_idle_since_us);
+    s_last_frame_us = 0; // pacing stats restart with this frame
+  }
+  s_stat_idle = idle;
+  portEXIT_CRITICAL(&s_stats_lock);
+  metrics_set(s_m_idle, idle ? 1 : 0);
+  ESP_LOGI(TAG, "%s", idle ? "Idle: strip dark, no motion; light sleep allowed" : "Active");
+}
+
+static void ws2812b_led_task(void* arg)
+{
+  uint32_t frame = 0;
+  bool first_light = true;
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const int64_t now_us = esp_timer_get_time();
+    const bool wake = s_wake_request;
+    s_wake_request = false;
+    bool poll = false;
+#if LED_IDLE
+    if (s_idle.idle)
+    {
+      led_idle::inputs in = {};
+      in.wake_request = wake;
+      if (s_idle.update(in, (uint32_t)(now_us / 1000)))
+      {
+        set_idle(false, now_us);
+        frame = 0; // sample the sensors with this frame
+      }
+      else
+      {
+        poll = true;
+        s_frames_since_refresh = LED_FORCE_REFRESH_FRAMES; // keep the once-a-second repair refresh
+      }
+    }
+#endif
+    if (!poll)
+    {
+      record_frame_start(now_us);
+    }
+    if (s_strips_ready)
+    {
+      if (poll || frame % LED_SENSOR_FRAMES == 0)
+      {
+        sample_sensors();
+      }
+      const uint8_t* levels = s_levels;
+      const bool streaming = ws2812b_stream_active();
+      if (streaming)
+      {
+        levels = stream_take();
+        close_traces(0);
+      }
+      else
+      {
+        compose_frame(s_levels, (uint32_t)(now_us / 1000), s_dark, s_motion, s_any_motion);
+      }
+      const uint32_t scale_q16 = power_limit(levels);
+      led_color::gamma_dither(levels, s_frame[s_back], s_dither_err, sizeof(s_levels), scale_q16);
+      submit_frame();
+      if (first_light)
+      {
+        boot_mark("led_first_frame");
+        first_light = false;
+      }
+#if LED_IDLE
+      led_idle::inputs in = {};
+      in.lit = led_idle::any_lit(levels, sizeof(s_levels));
+      in.motion = s_any_motion;
+      in.streaming = streaming;
+      in.hold = s_flash_sync;
+      in.wake_request = s_wake_request;
+      if (s_idle.update(in, (uint32_t)(now_us / 1000)))
+      {
+        set_idle(s_idle.idle, now_us);
+      }
+#endif
+    }
+    ++frame;
+  }
+}
+
+void ws2812b_led_init()
+{
+  s_m_frames = metrics_counter("led.frames");
+  s_m_cpu_us = metrics_histogram("led.cpu_us");
+  s_m_power_ma = metrics_gauge("led.power_ma", 500); // effects like breathing sweep it continuously
+  s_m_dark = metrics_gauge("led.dark", 0);
+  s_m_idle = metrics_gauge("led.idle", 0);
+#if LED_BACKEND_COMPARE
+  compare_backend(LED_BACKEND_RMT);
+  compare_backend(LED_BACKEND_SPI_DMA);
+#endif
+
+  int first = 0;
+  int spi_used = 0;
+  for (int i = 0; i < k_output_count; ++i)
+  {
+    const led_output_cfg& cfg = k_outputs[i];
+    led_output& out = s_outputs[i];
+    const spi_host_device_t spi_bus = (spi_used == 0) ? SPI2_HOST : SPI3_HOST;
+    spi_used += (cfg.backend == LED_BACKEND_SPI_DMA) ? 1 : 0;
+    out.first = first;
+    first += cfg.count;
+
+    const esp_err_t err = create_strip(cfg, spi_bus, &out.strip);
+    if (err != ESP_OK)
+    {
+      ESP_LOGE(TAG, "ERROR: create_strip failed: %s (%d) in %s", esp_err_to_name(err), err, __FUNCTION__);
+      out.strip = NULL;
+      continue;
+    }
+    ESP_LOGI(TAG, "INIT: LED strip %d created on GPIO %d (%d px, %s)", i, cfg.pin, cfg.count, backend_name(cfg.backend));
+    CHECK_ERR(led_strip_clear(out.strip));
+    CHECK_ERR(led_strip_refresh(out.strip));
+    s_strips_ready = true;
+  }
+  led_color::dither_seed(s_dither_err, sizeof(s_dither_err));
 
-  CHECK_ERR(led_strip_clear(s_strip));
-  CHECK_ERR(led_strip_refresh(s_strip));
+#if CONFIG_PM_ENABLE
+  CHECK_ERR(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "led_active", &s_pm_lock));
+  CHECK_ERR(esp_pm_lock_acquire(s_pm_lock));
+#endif
+  CHECK_XTASK_OK(xTaskCreatePinnedToCore(ws2812b_led_task, "ws2812b_led_task", 4096, NULL, 5, &s_task, 1));
+#if LED_IDLE
+  pir312_set_edge_hook(pir_edge_hook);
+#endif
 
-  CHECK_XTASK_OK(xTaskCreatePinnedToCore(ws2812b_led_task, "ws2812b_led_task", 4096, NULL, 5, NULL, 1));
+  esp_timer_create_args_t timer_args = {};
+  timer_args.callback = frame_timer_cb;
+  timer_args.name = "led_frame";
+  timer_args.skip_unhandled_events = true;
+  CHECK_ERR(esp_timer_create(&timer_args, &s_frame_timer));
+  CHECK_ERR(esp_timer_start_periodic(s_frame_timer, LED_FRAME_US));
   ESP_LOGI(TAG, "Initialization done.");
 }